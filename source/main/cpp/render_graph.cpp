@@ -2,321 +2,1779 @@
 
 namespace ncore
 {
+    namespace
+    {
+        // Execute binds the calling thread to the frame it executes, lookups of that thread go to this frame until it calls Clear
+        thread_local const RenderGraph* t_pExecuteGraph = nullptr;
+        thread_local u64                t_nExecuteFrame = 0;
+
+        struct ClearPassData
+        {
+        };
+    } // namespace
+
     RenderGraph::RenderGraph(Renderer* pRenderer)
         : m_resourceAllocator(pRenderer->GetDevice())
+        , m_uploadRing(pRenderer->GetDevice(), GfxMemoryType::CpuToGpu, 16 * 1024 * 1024, "RG Upload Ring")
+        , m_readbackRing(pRenderer->GetDevice(), GfxMemoryType::GpuToCpu, 4 * 1024 * 1024, "RG Readback Ring")
+    {
+        IGfxDevice* device = pRenderer->GetDevice();
+        m_pComputeQueueFence.reset(device->CreateFence("RenderGraph::m_pComputeQueueFence"));
+        m_pGraphicsQueueFence.reset(device->CreateFence("RenderGraph::m_pGraphicsQueueFence"));
+        m_pStagingFence = device->CreateFence("RenderGraph::m_pStagingFence");
+
+        for (u32 f = 0; f < MaxFrames; ++f)
+        {
+            m_frames[f].allocator = new RenderGraphArena(FrameArenaSize);
+        }
+    }
+
+    RenderGraph::~RenderGraph()
+    {
+        for (u32 f = 0; f < MaxFrames; ++f)
+        {
+            Frame& frame = m_frames[f];
+            for (size_t i = 0; i < frame.recorders.size(); ++i)
+            {
+                delete frame.recorders[i];
+            }
+
+            // the objects of the last recorded frames are still alive in the arena
+            for (size_t i = 0; i < frame.objFinalizer.size(); ++i)
+            {
+                frame.objFinalizer[i].finalizer(frame.objFinalizer[i].obj);
+            }
+            delete frame.allocator;
+        }
+
+        // the staging rings release their buffers themselves
+        delete m_pStagingFence;
+    }
+
+#if RENDER_GRAPH_EVENTS
+    void RenderGraph::BeginEvent(u32 id)
+    {
+        Frame& frame = GetRecordFrame();
+        frame.eventStream.push_back(id);
+        frame.pendingEvents++;
+    }
+
+    void RenderGraph::EndEvent()
+    {
+        Frame& frame = GetRecordFrame();
+        if (frame.pendingEvents > 0)
+        {
+            // no pass was added inside the event, so it is dropped
+            frame.eventStream.pop_back();
+            frame.pendingEvents--;
+        }
+        else
+        {
+            frame.passes.back()->EndEvent();
+        }
+    }
+
+    void RenderGraph::AttachPendingEvents(RenderGraphPassBase* pass)
+    {
+        Frame& frame = GetRecordFrame();
+        pass->SetBeginEvents((u32)frame.eventStream.size() - frame.pendingEvents, frame.pendingEvents);
+        frame.pendingEvents = 0;
+    }
+#endif
+
+    // culled passes are dropped from execution, RGRebalanceEvents moves the events they begin and end to live passes
+    void RenderGraphFrame::BuildLivePasses()
+    {
+        livePasses.clear();
+
+#if RENDER_GRAPH_EVENTS
+        liveEventStream.clear();
+
+        const u32     num_passes  = (u32)passes.size();
+        const u32     num_events  = (u32)eventStream.size();
+        RGPassEvents* events      = (RGPassEvents*)allocator->Alloc(sizeof(RGPassEvents) * num_passes);
+        u32*          live_stream = (u32*)allocator->Alloc(sizeof(u32) * num_events);
+        u32*          deferred    = (u32*)allocator->Alloc(sizeof(u32) * num_events);
+        for (u32 i = 0; i < num_passes; ++i)
+        {
+            const RenderGraphPassBase* pass = passes[i];
+            events[i].firstEvent            = pass->GetFirstEvent();
+            events[i].numBeginEvents        = (u16)pass->GetNumBeginEvents();
+            events[i].numEndEvents          = (u16)pass->GetNumEndEvents();
+            events[i].culled                = pass->IsCulled() ? 1 : 0;
+        }
+
+        const u32 num_live_events = RGRebalanceEvents(events, num_passes, eventStream.data(), live_stream, deferred);
+        for (u32 i = 0; i < num_live_events; ++i)
+        {
+            liveEventStream.push_back(live_stream[i]);
+        }
+#endif
+
+        for (size_t i = 0; i < passes.size(); ++i)
+        {
+            RenderGraphPassBase* pass = passes[i];
+            if (pass->IsCulled())
+            {
+                continue;
+            }
+
+#if RENDER_GRAPH_EVENTS
+            pass->SetBeginEvents(events[i].firstEvent, events[i].numBeginEvents);
+            pass->SetEndEvents(events[i].numEndEvents);
+#endif
+            livePasses.push_back(pass);
+        }
+    }
+
+    // a pass depends on the writer of every node it accesses and, when it writes a resource, on the earlier readers of the
+    // node it overwrites. Passes are added in dependency order, so a walk in execution order gives the earliest level of
+    // every pass and a walk back the latest level it could move to. A folded clear pass takes no level, the passes after
+    // it depend on what it depended on instead.
+    void RenderGraphFrame::BuildDependencyLevels()
+    {
+        levelPasses.clear();
+        levelFirst.clear();
+        criticalPath.clear();
+        dependencies.clear();
+
+        const u32 num_live = (u32)livePasses.size();
+        if (num_live == 0)
+        {
+            return;
+        }
+
+        u32* live_index = (u32*)allocator->Alloc(sizeof(u32) * passes.size());
+        u32* level      = (u32*)allocator->Alloc(sizeof(u32) * num_live);
+        u32* latest     = (u32*)allocator->Alloc(sizeof(u32) * num_live);
+        u32* critical   = (u32*)allocator->Alloc(sizeof(u32) * num_live); // the dependency that sets the level
+        u8*  folded     = (u8*)allocator->Alloc(sizeof(u8) * num_live);
+        u32* forward    = (u32*)allocator->Alloc(sizeof(u32) * (num_live + 1)); // range of a folded pass in 'forwarded'
+        for (u32 i = 0; i < num_live; ++i)
+        {
+            live_index[livePasses[i]->GetIndex()] = i;
+            folded[i]                             = livePasses[i]->IsFolded() ? 1 : 0;
+        }
+
+        vector_t<u32>      forwarded;
+        vector_t<DAGEdge*> edges;
+        vector_t<DAGEdge*> pass_outputs;
+        vector_t<DAGEdge*> node_edges;
+        vector_t<DAGEdge*> readers;
+
+        for (u32 i = 0; i < num_live; ++i)
+        {
+            RenderGraphPassBase* pass = livePasses[i];
+            forward[i]                = (u32)forwarded.size();
+
+            graph.GetIncomingEdges(pass, edges);
+            graph.GetOutgoingEdges(pass, pass_outputs);
+
+            for (size_t e = 0; e < edges.size(); ++e)
+            {
+                RenderGraphResourceNode* node = (RenderGraphResourceNode*)graph.GetNode(edges[e]->GetFromNode());
+
+                bool writes = false;
+                for (size_t o = 0; o < pass_outputs.size() && !writes; ++o)
+                {
+                    writes = ((RenderGraphResourceNode*)graph.GetNode(pass_outputs[o]->GetToNode()))->GetResource() == node->GetResource();
+                }
+
+                // the writer of the node, and for a write the readers it has to wait for
+                graph.GetIncomingEdges(node, node_edges);
+                const u32 num_writers = (u32)node_edges.size();
+                if (writes)
+                {
+                    graph.GetOutgoingEdges(node, readers);
+                    for (size_t r = 0; r < readers.size(); ++r)
+                    {
+                        node_edges.push_back(readers[r]);
+                    }
+                }
+
+                for (size_t d = 0; d < node_edges.size(); ++d)
+                {
+                    RenderGraphPassBase* other = (RenderGraphPassBase*)graph.GetNode(d < num_writers ? node_edges[d]->GetFromNode() : node_edges[d]->GetToNode());
+                    if (other == pass || other->IsCulled())
+                    {
+                        continue;
+                    }
+
+                    const u32 j = live_index[other->GetIndex()];
+                    if (j >= i)
+                    {
+                        continue; // a later reader of the node
+                    }
+
+                    const u32 first = folded[j] ? forward[j] : 0;
+                    const u32 end   = folded[j] ? forward[j + 1] : 1;
+                    for (u32 f = first; f < end; ++f)
+                    {
+                        const u32 k = folded[j] ? forwarded[f] : j;
+                        if (folded[i])
+                        {
+                            forwarded.push_back(k);
+                        }
+                        else
+                        {
+                            dependencies.push_back(k);
+                            dependencies.push_back(i);
+                        }
+                    }
+                }
+            }
+
+            forward[i + 1] = (u32)forwarded.size();
+        }
+
+        const u32 num_levels = RGComputeDependencyLevels(num_live, dependencies.data(), (u32)dependencies.size() / 2, level, latest, critical, folded);
+
+        // bucket the passes per level, the order inside a level stays the execution order
+        for (u32 l = 0; l <= num_levels; ++l)
+        {
+            levelFirst.push_back(0);
+        }
+        for (u32 i = 0; i < num_live; ++i)
+        {
+            livePasses[i]->SetDependencyLevel(level[i], latest[i] - level[i]);
+            if (!folded[i])
+            {
+                levelFirst[level[i] + 1]++;
+                levelPasses.push_back(nullptr);
+            }
+        }
+        for (u32 l = 0; l < num_levels; ++l)
+        {
+            levelFirst[l + 1] += levelFirst[l];
+        }
+
+        u32* cursor = (u32*)allocator->Alloc(sizeof(u32) * num_levels);
+        for (u32 l = 0; l < num_levels; ++l)
+        {
+            cursor[l] = levelFirst[l];
+        }
+        for (u32 i = 0; i < num_live; ++i)
+        {
+            if (!folded[i])
+            {
+                levelPasses[cursor[level[i]]++] = livePasses[i];
+            }
+        }
+
+        // back from the last pass of the deepest level along the dependencies that set the levels
+        u32*      path        = (u32*)allocator->Alloc(sizeof(u32) * num_levels);
+        const u32 path_length = RGGetCriticalPath(num_live, level, critical, num_levels, path, folded);
+        for (u32 i = 0; i < path_length; ++i)
+        {
+            criticalPath.push_back(livePasses[path[i]]);
+        }
+    }
+
+    // the graphics queue work a Compute pass can overlap with is what runs in the levels of its slack and doesn't depend
+    // on it, the promoted pass then waits for and signals the graphics queue like any AsyncCompute pass. A 'cached' frame
+    // took its promotions from the compiled graph, only the report is rebuilt from them.
+    void RenderGraphFrame::PromoteAsyncCompute(RGPassCostFunc cost_func, void* user_data, u64 min_cost, bool cached)
+    {
+        promotion = {};
+
+        if (cost_func == nullptr)
+        {
+            // no costs to report, the cache may still come from a run that had them
+            for (size_t i = 0; i < livePasses.size(); ++i)
+            {
+                promotion.numPromoted += livePasses[i]->IsAsyncPromoted() ? 1 : 0;
+            }
+            return;
+        }
+
+        // the cost hint of the builder comes first
+        const u32 num_live  = (u32)livePasses.size();
+        u64*      cost      = (u64*)allocator->Alloc(sizeof(u64) * num_live);
+        u8*       dependent = (u8*)allocator->Alloc(sizeof(u8) * num_live);
+        for (u32 i = 0; i < num_live; ++i)
+        {
+            cost[i] = livePasses[i]->GetCostHint() != 0 ? livePasses[i]->GetCostHint() : cost_func(livePasses[i], user_data);
+        }
+
+        vector_t<DAGEdge*> edges;
+
+        for (u32 i = 0; i < num_live; ++i)
+        {
+            RenderGraphPassBase* pass = livePasses[i];
+
+            // state transitions a subgraph resolved up-front assume the queue it was compiled for
+            if ((pass->GetType() != RenderPassType::Compute && !pass->IsAsyncPromoted()) || pass->HasPrecompiledStates() || cost[i] == 0)
+            {
+                continue;
+            }
+
+            promotion.numCandidates++;
+            if (cached ? !pass->IsAsyncPromoted() : (cost[i] < min_cost || pass->GetDependencySlack() == 0))
+            {
+                continue;
+            }
+
+            // the passes that depend on this one, directly or through others, the pairs are in pass order
+            for (u32 j = 0; j < num_live; ++j)
+            {
+                dependent[j] = j == i ? 1 : 0;
+            }
+            for (size_t d = 0; d < dependencies.size(); d += 2)
+            {
+                if (dependent[dependencies[d]])
+                {
+                    dependent[dependencies[d + 1]] = 1;
+                }
+            }
+
+            const u32 first_level = pass->GetDependencyLevel();
+            const u32 last_level  = first_level + pass->GetDependencySlack();
+
+            // passes promoted after this one still ran on the graphics queue when it was promoted
+            u64 hidden = 0;
+            for (u32 j = 0; j < num_live; ++j)
+            {
+                const RenderGraphPassBase* other = livePasses[j];
+                const u32                  level = other->GetDependencyLevel();
+                const bool                 async = other->GetType() == RenderPassType::AsyncCompute && !(j > i && other->IsAsyncPromoted());
+                if (!dependent[j] && !async && !other->IsFolded() && level >= first_level && level <= last_level)
+                {
+                    hidden += cost[j];
+                }
+            }
+
+            const u64 overlap = math::min(hidden, cost[i]);
+            if (cached)
+            {
+                promotion.numPromoted++;
+                promotion.promotedCost += cost[i];
+                promotion.expectedOverlap += overlap;
+                continue;
+            }
+            if (overlap * 2 < cost[i])
+            {
+                continue;
+            }
+
+            pass->PromoteToAsyncCompute();
+
+            // async compute extends the lifetimes of its resources to the graphics passes it syncs with
+            graph.GetIncomingEdges(pass, edges);
+            for (size_t e = 0; e < edges.size(); ++e)
+            {
+                RenderGraphResource* resource = ((RenderGraphResourceNode*)graph.GetNode(edges[e]->GetFromNode()))->GetResource();
+                if (resource->IsPreResolved())
+                {
+                    resource->ResetPreResolved();
+                }
+            }
+
+            promotion.numPromoted++;
+            promotion.promotedCost += cost[i];
+            promotion.expectedOverlap += overlap;
+        }
+    }
+
+    void RenderGraphFrame::BucketResourceNodes(RenderGraphResourceNode**& nodes, u32*& first)
+    {
+        const u32 num_resources = (u32)resources.size();
+        const u32 num_nodes     = (u32)resourceNodes.size();
+
+        first       = (u32*)allocator->Alloc(sizeof(u32) * (num_resources + 1));
+        u32* cursor = (u32*)allocator->Alloc(sizeof(u32) * num_resources);
+        for (u32 i = 0; i <= num_resources; ++i)
+        {
+            first[i] = 0;
+        }
+
+        for (u32 i = 0; i < num_nodes; ++i)
+        {
+            first[resourceNodes[i]->GetResource()->GetIndex() + 1]++;
+        }
+
+        for (u32 i = 0; i < num_resources; ++i)
+        {
+            first[i + 1] += first[i];
+            cursor[i] = first[i];
+        }
+
+        nodes = (RenderGraphResourceNode**)allocator->Alloc(sizeof(RenderGraphResourceNode*) * num_nodes);
+        for (u32 i = 0; i < num_nodes; ++i)
+        {
+            RenderGraphResourceNode* node = resourceNodes[i];
+            nodes[cursor[node->GetResource()->GetIndex()]++] = node;
+        }
+    }
+
+    // a clear pass is folded when the cleared version is used by a single live pass and that pass writes the same
+    // subresource, either as the same kind of attachment or with full coverage. The clear moves into its load op.
+    bool RenderGraphFrame::FoldClearPass(RenderGraphPassBase* pass, vector_t<DAGEdge*>& edges)
+    {
+        graph.GetOutgoingEdges(pass, edges);
+        if (edges.size() != 1)
+        {
+            return false;
+        }
+
+        RenderGraphEdge*         clear = (RenderGraphEdge*)edges[0];
+        RenderGraphResourceNode* node  = (RenderGraphResourceNode*)graph.GetNode(clear->GetToNode());
+
+        RenderGraphPassBase* next = nullptr;
+        RenderGraphEdge*     use  = nullptr;
+
+        graph.GetOutgoingEdges(node, edges);
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            RenderGraphPassBase* reader = (RenderGraphPassBase*)graph.GetNode(edges[i]->GetToNode());
+            if (reader->IsCulled())
+            {
+                continue;
+            }
+            if (use != nullptr)
+            {
+                return false; // the cleared contents are read
+            }
+            next = reader;
+            use  = (RenderGraphEdge*)edges[i];
+        }
+
+        // nothing renders to it, eg. a cleared target that is presented
+        if (use == nullptr || use->GetSubresource() != clear->GetSubresource())
+        {
+            return false;
+        }
+
+        RenderGraphEdge* write = nullptr;
+
+        graph.GetOutgoingEdges(next, edges);
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            RenderGraphEdge*         edge   = (RenderGraphEdge*)edges[i];
+            RenderGraphResourceNode* output = (RenderGraphResourceNode*)graph.GetNode(edge->GetToNode());
+            if (output->GetResource() == node->GetResource() && edge->GetSubresource() == use->GetSubresource())
+            {
+                write = edge;
+                break;
+            }
+        }
+
+        if (write == nullptr)
+        {
+            return false; // only read
+        }
+
+        ngfx::GfxRenderPass::LoadOp load_op         = ngfx::GfxRenderPass::LoadDontCare;
+        ngfx::GfxRenderPass::LoadOp stencil_load_op = ngfx::GfxRenderPass::LoadDontCare;
+        if (write->GetUsage() == ngfx::GfxAccess::RTV)
+        {
+            load_op = ((RenderGraphEdgeColorAttchment*)write)->GetLoadOp();
+        }
+        else if (write->GetUsage() == ngfx::GfxAccess::DSV)
+        {
+            load_op         = ((RenderGraphEdgeDepthAttchment*)write)->GetDepthLoadOp();
+            stencil_load_op = ((RenderGraphEdgeDepthAttchment*)write)->GetStencilLoadOp();
+        }
+
+        const RGClearFold fold = RGFoldClear(clear->GetUsage(), write->GetUsage(), write->IsFullCoverageWrite(), load_op, stencil_load_op);
+        if (!fold.folded)
+        {
+            return false; // eg. a UAV write that may leave texels untouched
+        }
+
+        if (write->GetUsage() == ngfx::GfxAccess::RTV)
+        {
+            RenderGraphEdgeColorAttchment* from = (RenderGraphEdgeColorAttchment*)clear;
+            RenderGraphEdgeColorAttchment* to   = (RenderGraphEdgeColorAttchment*)write;
+            if (fold.loadOp)
+            {
+                to->SetLoadOp(from->GetLoadOp());
+                to->SetClearColor(from->GetClearColor());
+            }
+        }
+        else if (write->GetUsage() == ngfx::GfxAccess::DSV)
+        {
+            RenderGraphEdgeDepthAttchment* from = (RenderGraphEdgeDepthAttchment*)clear;
+            RenderGraphEdgeDepthAttchment* to   = (RenderGraphEdgeDepthAttchment*)write;
+            if (fold.loadOp)
+            {
+                to->SetDepthLoadOp(from->GetDepthLoadOp(), from->GetClearDepth());
+            }
+            if (fold.stencilLoadOp)
+            {
+                to->SetStencilLoadOp(from->GetStencilLoadOp(), from->GetClearStencil());
+            }
+        }
+
+        pass->Fold();
+        clears.numFoldedPasses++;
+        return true;
+    }
+
+    // the render pass of a pass takes its load ops from its output edges, only those are rewritten. Load ops aren't part
+    // of the compiled graph cache, so this runs for every frame.
+    void RenderGraphFrame::EliminateRedundantClears()
+    {
+        clears = {};
+
+        vector_t<DAGEdge*> edges;
+
+        for (size_t i = 0; i < livePasses.size(); ++i)
+        {
+            RenderGraphPassBase* pass = livePasses[i];
+            if (pass->IsClearPass())
+            {
+                FoldClearPass(pass, edges);
+            }
+        }
+
+        // after folding, a full coverage write drops the clear it took over as well
+        for (size_t i = 0; i < livePasses.size(); ++i)
+        {
+            RenderGraphPassBase* pass = livePasses[i];
+            if (pass->GetType() != RenderPassType::Graphics)
+            {
+                continue;
+            }
+
+            graph.GetOutgoingEdges(pass, edges);
+            for (size_t e = 0; e < edges.size(); ++e)
+            {
+                RenderGraphEdge* edge = (RenderGraphEdge*)edges[e];
+                if (!edge->IsFullCoverageWrite())
+                {
+                    continue;
+                }
+
+                ngfx::GfxRenderPass::LoadOp load_op;
+                if (edge->GetUsage() == ngfx::GfxAccess::RTV)
+                {
+                    RenderGraphEdgeColorAttchment* color = (RenderGraphEdgeColorAttchment*)edge;
+                    load_op                              = color->GetLoadOp();
+                    color->SetLoadOp(ngfx::GfxRenderPass::LoadDontCare);
+                }
+                else if (edge->GetUsage() == ngfx::GfxAccess::DSV)
+                {
+                    RenderGraphEdgeDepthAttchment* depth = (RenderGraphEdgeDepthAttchment*)edge;
+                    load_op                              = depth->GetDepthLoadOp();
+                    depth->SetDepthLoadOp(ngfx::GfxRenderPass::LoadDontCare, depth->GetClearDepth());
+                }
+                else
+                {
+                    continue;
+                }
+
+                if (load_op == ngfx::GfxRenderPass::LoadClear)
+                {
+                    clears.numDroppedClears++;
+                }
+                else if (RGIsLoad(load_op))
+                {
+                    clears.numDroppedLoads++;
+                }
+            }
+        }
+    }
+
+    void RenderGraph::EnableAsyncComputePromotion(RGPassCostFunc cost, void* user_data, u64 min_cost)
+    {
+        m_pPromotionCost     = cost;
+        m_pPromotionUserData = user_data;
+        m_nPromotionMinCost  = min_cost;
+    }
+
+    RenderGraph::Frame& RenderGraph::GetFrame()
+    {
+        if (t_pExecuteGraph == this)
+        {
+            return m_frames[t_nExecuteFrame % MaxFrames];
+        }
+        return GetRecordFrame();
+    }
+
+    const RenderGraph::Frame& RenderGraph::GetFrame() const
+    {
+        if (t_pExecuteGraph == this)
+        {
+            return m_frames[t_nExecuteFrame % MaxFrames];
+        }
+        return GetRecordFrame();
+    }
+
+    bool RenderGraph::Clear()
+    {
+        // a compiled frame is kept for Execute, recording moves on to the next slot of the ring. That slot may not
+        // be reused while it holds a frame that wasn't executed, its finalizers would pull the frame out from under Execute.
+        if (GetRecordFrame().compiled)
+        {
+            if (m_nRecordFrame + 1 - m_nExecuteFrame >= MaxFrames)
+            {
+                return false;
+            }
+            m_nRecordFrame++;
+        }
+
+        // the calling thread starts recording, lookups go to the record frame again
+        if (t_pExecuteGraph == this)
+        {
+            t_pExecuteGraph = nullptr;
+        }
+
+        Frame& frame = GetRecordFrame();
+        for (size_t i = 0; i < frame.objFinalizer.size(); ++i)
+        {
+            frame.objFinalizer[i].finalizer(frame.objFinalizer[i].obj);
+        }
+        frame.objFinalizer.clear();
+
+        frame.graph.Clear();
+
+        frame.passes.clear();
+        frame.livePasses.clear();
+        frame.resourceNodes.clear();
+        frame.resources.clear();
+
+#if RENDER_GRAPH_EVENTS
+        frame.eventStream.clear();
+        frame.liveEventStream.clear();
+        frame.pendingEvents = 0;
+#endif
+
+        frame.allocator->Reset();
+
+        frame.outputResources.clear();
+        frame.imports.clear();
+        frame.levelPasses.clear();
+        frame.levelFirst.clear();
+        frame.criticalPath.clear();
+        frame.dependencies.clear();
+        frame.promotion = {};
+        frame.clears    = {};
+
+        for (u32 i = 0; i < frame.numRecorders; ++i)
+        {
+            frame.recorders[i]->Reset();
+        }
+        frame.numRecorders       = 0;
+        frame.numMergedRecorders = 0;
+
+        frame.id                       = m_nRecordFrame;
+        frame.compiled                 = false;
+        frame.cached                   = false;
+        frame.graphicsConstantsPending = false;
+        frame.uploadSize               = 0;
+        frame.readbackSize             = 0;
+        frame.stagingFence             = 0;
+        return true;
+    }
+
+    void RenderGraph::Compile()
+    {
+        CPU_EVENT("Render", "RenderGraph::Compile");
+
+        // a failed Clear left the compiled frame in place
+        Frame& frame = GetRecordFrame();
+        ASSERT(!frame.compiled);
+        if (frame.compiled)
+        {
+            return;
+        }
+
+        MergeRecorders();
+
+        // whatever is written to a persistent resource is consumed by a later frame, so it may not be culled
+        for (size_t i = 0; i < frame.resourceNodes.size(); ++i)
+        {
+            RenderGraphResourceNode* node = frame.resourceNodes[i];
+            if (node->GetVersion() > 0 && node->GetResource()->IsPersistent())
+            {
+                node->MakeTarget();
+            }
+        }
+
+        frame.graph.Cull();
+
+        // a subgraph lifetime only holds while the passes at both ends of it survived culling
+        for (size_t i = 0; i < frame.resources.size(); ++i)
+        {
+            RenderGraphResource* resource = frame.resources[i];
+            if (resource->IsPreResolved() && (frame.graph.GetNode(resource->GetFirstPassID())->IsCulled() || frame.graph.GetNode(resource->GetLastPassID())->IsCulled()))
+            {
+                resource->ResetPreResolved();
+            }
+        }
+
+        // folded clear passes take no dependency level, so the clears are folded first
+        frame.BuildLivePasses();
+        frame.EliminateRedundantClears();
+        frame.BuildDependencyLevels();
+
+        frame.cached = m_pCompiledGraph != nullptr && ApplyCompiled(frame, m_pCompiledGraph);
+
+        if (!frame.cached)
+        {
+            frame.PromoteAsyncCompute(m_pPromotionCost, m_pPromotionUserData, m_nPromotionMinCost, false);
+
+            RenderGraphAsyncResolveContext context;
+
+            for (size_t i = 0; i < frame.livePasses.size(); ++i)
+            {
+                frame.livePasses[i]->ResolveAsyncCompute(frame.graph, context);
+            }
+
+            RenderGraphSubmitPlanContext plan;
+
+            for (size_t i = 0; i < frame.livePasses.size(); ++i)
+            {
+                frame.livePasses[i]->PlanSubmit(plan);
+            }
+
+            // the caller keeps recording into the graphics command list after Execute
+            frame.graphicsConstantsPending = plan.constantsPending[0];
+        }
+
+        // every resource is resolved by a single job and sees its nodes in the serial order
+        frame.BucketResourceNodes(m_pResolveNodes, m_pResolveFirst);
+
+        const u32 num_resources = (u32)frame.resources.size();
+        ParallelFor(num_resources, &RenderGraph::ResolveResourcesJob);
+
+        // placement in the heaps depends on the order, only the preparation runs in parallel so the result is the same as serial
+        ParallelFor(num_resources, &RenderGraph::PrepareRealizeJob);
+
+        // placements of the previous frame may still be in use, lifetimes of different frames never overlap.
+        // History slots and ring regions are keyed by it too, not by the device frame.
+        m_resourceAllocator.SetLifetimeFrame(frame.id);
+
+        for (u32 i = 0; i < num_resources; ++i)
+        {
+            RenderGraphResource* resource = frame.resources[i];
+            if (resource->IsUsed())
+            {
+                resource->Realize();
+            }
+        }
+
+        // the aliasing lookups scan and update the heap entries the allocations just placed, so they run serially here
+        // and the barrier jobs only read what they found
+        for (u32 i = 0; i < num_resources; ++i)
+        {
+            RenderGraphResource* resource = frame.resources[i];
+            if (resource->IsUsed() && resource->IsOverlapping())
+            {
+                resource->ResolveAliasing();
+            }
+        }
+
+        ParallelFor((u32)frame.livePasses.size(), &RenderGraph::ResolveBarriersJob);
+
+        if (m_bAnalyzeBarriers)
+        {
+            m_barrierStats.Reset();
+
+            for (size_t i = 0; i < frame.livePasses.size(); ++i)
+            {
+                const vector_t<RGBarrierRecord>& records = frame.livePasses[i]->GetBarrierRecords();
+                m_barrierStats.Add(records.data(), (u32)records.size());
+            }
+        }
+
+        // the next frame is recorded before this one executes, so registered imports take their final state from here
+        m_imports.UpdateStates(frame);
+
+        // the staging ranges recorded for this frame are released with its fence, whatever the next frame allocates meanwhile
+        {
+            RenderGraphScopedLock lock(m_stagingLock);
+            frame.uploadSize   = m_uploadRing.TakePending();
+            frame.readbackSize = m_readbackRing.TakePending();
+        }
+
+        frame.compiled = true;
+    }
+
+    void RenderGraph::ParallelFor(u32 count, void (*job)(u32 begin, u32 end, void* context))
+    {
+        if (m_pJobSystem != nullptr && count > m_nJobChunkSize)
+        {
+            m_pJobSystem->ParallelFor(count, m_nJobChunkSize, job, this);
+        }
+        else
+        {
+            job(0, count, this);
+        }
+    }
+
+    void RenderGraph::ResolveResourcesJob(u32 begin, u32 end, void* context)
+    {
+        RenderGraph* graph = (RenderGraph*)context;
+        Frame&       frame = graph->GetRecordFrame();
+
+        vector_t<DAGEdge*>     edges;
+        vector_t<RGReadAccess> reads;
+
+        for (u32 r = begin; r < end; ++r)
+        {
+            // a cached lifetime still needs the read states of its edges merged, a subgraph lifetime has them merged already
+            RenderGraphResource* resource = frame.resources[r];
+            if (resource->IsPreResolved() && !frame.cached)
+            {
+                continue;
+            }
+
+            for (u32 n = graph->m_pResolveFirst[r]; n < graph->m_pResolveFirst[r + 1]; ++n)
+            {
+                RenderGraphResourceNode* node = graph->m_pResolveNodes[n];
+                if (node->IsCulled())
+                {
+                    continue;
+                }
+
+                frame.MergeReadStates(node, edges, reads);
+                if (resource->IsPreResolved())
+                {
+                    continue;
+                }
+
+                frame.graph.GetOutgoingEdges(node, edges);
+                for (size_t i = 0; i < edges.size(); ++i)
+                {
+                    RenderGraphEdge*     edge = (RenderGraphEdge*)edges[i];
+                    RenderGraphPassBase* pass = (RenderGraphPassBase*)frame.graph.GetNode(edge->GetToNode());
+
+                    if (!pass->IsCulled())
+                    {
+                        resource->Resolve(edge, pass);
+                    }
+                }
+
+                frame.graph.GetIncomingEdges(node, edges);
+                for (size_t i = 0; i < edges.size(); ++i)
+                {
+                    RenderGraphEdge*     edge = (RenderGraphEdge*)edges[i];
+                    RenderGraphPassBase* pass = (RenderGraphPassBase*)frame.graph.GetNode(edge->GetFromNode());
+
+                    if (!pass->IsCulled())
+                    {
+                        resource->Resolve(edge, pass);
+                    }
+                }
+            }
+        }
+    }
+
+    // consecutive readers of a node on the same queue share the union of their read states, so the resource is
+    // transitioned once for the whole run instead of going back and forth between e.g. pixel and non-pixel shader SRV
+    void RenderGraphFrame::MergeReadStates(RenderGraphResourceNode* node, vector_t<DAGEdge*>& edges, vector_t<RGReadAccess>& reads) const
+    {
+        graph.GetOutgoingEdges(node, edges);
+
+        reads.clear();
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            const RenderGraphEdge*     edge = (const RenderGraphEdge*)edges[i];
+            const RenderGraphPassBase* pass = (const RenderGraphPassBase*)graph.GetNode(edge->GetToNode());
+
+            RGReadAccess read = {};
+            read.usage        = edge->GetUsage();
+            read.stages       = edge->GetStages();
+            read.subresource  = edge->GetSubresource();
+            read.queue        = pass->GetType() == RenderPassType::AsyncCompute ? 1 : 0;
+            read.mergeable    = RenderGraphEdge::IsMergeableRead(edge->GetUsage()) ? 1 : 0;
+            read.culled       = pass->IsCulled() ? 1 : 0;
+            reads.push_back(read);
+        }
+
+        RGMergeReadStates(reads.data(), (u32)reads.size());
+
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            if (reads[i].merged)
+            {
+                RenderGraphEdge* edge = (RenderGraphEdge*)edges[i];
+                edge->SetState(reads[i].state);
+                edge->SetStages(reads[i].mergedStages);
+            }
+        }
+    }
+
+    void RenderGraph::PrepareRealizeJob(u32 begin, u32 end, void* context)
+    {
+        RenderGraph* graph = (RenderGraph*)context;
+        Frame&       frame = graph->GetRecordFrame();
+
+        for (u32 i = begin; i < end; ++i)
+        {
+            RenderGraphResource* resource = frame.resources[i];
+            if (resource->IsUsed())
+            {
+                resource->PrepareRealize();
+            }
+        }
+    }
+
+    void RenderGraph::ResolveBarriersJob(u32 begin, u32 end, void* context)
+    {
+        RenderGraph* graph = (RenderGraph*)context;
+        Frame&       frame = graph->GetRecordFrame();
+
+        for (u32 i = begin; i < end; ++i)
+        {
+            frame.livePasses[i]->ResolveBarriers(frame.graph, graph->m_bAnalyzeBarriers);
+        }
+    }
+
+    void RenderGraph::Execute(Renderer* pRenderer, IGfxCommandList* pCommandList, IGfxCommandList* pComputeCommandList)
+    {
+        CPU_EVENT("Render", "RenderGraph::Execute");
+        GPU_EVENT(pCommandList, "RenderGraph");
+
+        // frames execute in the order they were compiled
+        Frame& frame = m_frames[m_nExecuteFrame % MaxFrames];
+        ASSERT(frame.compiled && frame.id == m_nExecuteFrame);
+
+        t_pExecuteGraph = this;
+        t_nExecuteFrame = frame.id;
+
+        RenderGraphPassExecuteContext context = {};
+        context.renderer                      = pRenderer;
+        context.graphicsCommandList           = pCommandList;
+        context.computeCommandList            = pComputeCommandList;
+        context.computeQueueFence             = m_pComputeQueueFence.get();
+        context.graphicsQueueFence            = m_pGraphicsQueueFence.get();
+        context.initialComputeFenceValue      = m_nComputeQueueFenceValue;
+        context.initialGraphicsFenceValue     = m_nGraphicsQueueFenceValue;
+
+        for (size_t i = 0; i < frame.livePasses.size(); ++i)
+        {
+            frame.livePasses[i]->Execute(*this, context);
+        }
+
+        m_nComputeQueueFenceValue  = context.lastSignaledComputeValue;
+        m_nGraphicsQueueFenceValue = context.lastSignaledGraphicsValue;
+
+        if (frame.graphicsConstantsPending)
+        {
+            pRenderer->SetupGlobalConstants(pCommandList);
+        }
+
+        for (size_t i = 0; i < frame.outputResources.size(); ++i)
+        {
+            const PresentTarget& target = frame.outputResources[i];
+
+            // an imported resource no pass touched is still in the state it was imported with
+            const ngfx::GfxAccessFlags state = target.resource->IsUsed() ? target.resource->GetFinalState() : target.resource->GetInitialState();
+            if (state != target.state)
+            {
+                target.resource->Barrier(pCommandList, 0, state, target.state, RGGetStages(state), RGShaderStage::None);
+                target.resource->SetFinalState(target.state);
+            }
+        }
+        frame.outputResources.clear();
+
+        // applied with the next submit of the graphics command list, staging ranges of this frame are released when it is reached
+        pCommandList->Signal(m_pStagingFence, ++m_nStagingFenceValue);
+        frame.stagingFence = m_nStagingFenceValue;
+        {
+            RenderGraphScopedLock lock(m_stagingLock);
+            m_uploadRing.Submit(m_nStagingFenceValue, frame.uploadSize);
+            m_readbackRing.Submit(m_nStagingFenceValue, frame.readbackSize);
+        }
+
+        // the shared pool housekeeping runs once the frame is recorded into the command list, the frame compiled
+        // meanwhile only holds resources it used just now and the deletions are deferred past the frames in flight
+        m_resourceAllocator.Reset();
+
+        m_nExecuteFrame++;
+    }
+
+    void RenderGraph::Present(const RGHandle& handle, ngfx::GfxAccess::Flags filnal_state)
+    {
+        ASSERT(handle.IsValid());
+
+        Frame& frame = GetRecordFrame();
+
+        RenderGraphResource* resource = GetTexture(handle);
+        resource->SetOutput(true);
+
+        RenderGraphResourceNode* node = frame.resourceNodes[Resolve(handle).node];
+        node->MakeTarget();
+
+        PresentTarget target;
+        target.resource = resource;
+        target.state    = filnal_state;
+        frame.outputResources.push_back(target);
+    }
+
+    RenderGraphPassBase* const* RenderGraph::GetDependencyLevel(u32 level, u32& count) const
+    {
+        const Frame& frame = GetFrame();
+        ASSERT(level < frame.criticalPath.size());
+
+        count = frame.levelFirst[level + 1] - frame.levelFirst[level];
+        return frame.levelPasses.data() + frame.levelFirst[level];
+    }
+
+    RGTexture* RenderGraph::GetTexture(const RGHandle& handle)
+    {
+        if (!handle.IsValid())
+        {
+            return nullptr;
+        }
+
+        Frame&               frame    = GetFrame();
+        RenderGraphResource* resource = frame.resources[Resolve(handle).index];
+        ASSERT(dynamic_cast<RGTexture*>(resource) != nullptr);
+        return (RGTexture*)resource;
+    }
+
+    RGBuffer* RenderGraph::GetBuffer(const RGHandle& handle)
+    {
+        if (!handle.IsValid())
+        {
+            return nullptr;
+        }
+
+        Frame&               frame    = GetFrame();
+        RenderGraphResource* resource = frame.resources[Resolve(handle).index];
+        ASSERT(dynamic_cast<RGBuffer*>(resource) != nullptr);
+        return (RGBuffer*)resource;
+    }
+
+    // eastl::string RenderGraph::Export() { return m_graph.ExportGraphviz(); }
+
+    RGHandle RenderGraph::Import(IGfxTexture* texture, ngfx::GfxAccess::Flags state)
+    {
+        Frame& frame = GetRecordFrame();
+
+        auto resource = Allocate<RGTexture>(m_resourceAllocator, texture, state);
+        auto node     = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, 0);
+
+        RGHandle handle;
+        handle.index = (u16)frame.resources.size();
+        handle.node  = (u16)frame.resourceNodes.size();
+
+        resource->SetIndex(handle.index);
+
+        frame.resources.push_back(resource);
+        frame.resourceNodes.push_back(node);
+
+        return handle;
+    }
+
+    RGHandle RenderGraph::Import(IGfxBuffer* buffer, ngfx::GfxAccess::Flags state)
     {
-        IGfxDevice* device = pRenderer->GetDevice();
-        m_pComputeQueueFence.reset(device->CreateFence("RenderGraph::m_pComputeQueueFence"));
-        m_pGraphicsQueueFence.reset(device->CreateFence("RenderGraph::m_pGraphicsQueueFence"));
+        Frame& frame = GetRecordFrame();
+
+        auto resource = Allocate<RGBuffer>(m_resourceAllocator, buffer, state);
+        auto node     = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, 0);
+
+        RGHandle handle;
+        handle.index = (u16)frame.resources.size();
+        handle.node  = (u16)frame.resourceNodes.size();
+
+        resource->SetIndex(handle.index);
+
+        frame.resources.push_back(resource);
+        frame.resourceNodes.push_back(node);
+
+        return handle;
     }
 
-    void RenderGraph::BeginEvent(cpstr_t name) { m_eventNames.push_back(name); }
+    u32 RenderGraph::RegisterImport(IGfxTexture* texture, ngfx::GfxAccess::Flags state) { return m_imports.Register(texture, state, true); }
+    u32 RenderGraph::RegisterImport(IGfxBuffer* buffer, ngfx::GfxAccess::Flags state) { return m_imports.Register(buffer, state, false); }
 
-    void RenderGraph::EndEvent()
+    void RenderGraph::UnregisterImport(u32 id) { m_imports.Unregister(id); }
+
+    RGHandle RenderGraph::Import(u32 id)
     {
-        if (!m_eventNames.empty())
-        {
-            m_eventNames.pop_back();
-        }
-        else
+        ASSERT(m_imports.IsRegistered(id));
+
+        Frame&                            frame = GetRecordFrame();
+        RenderGraphImportRegistry::Entry& entry = m_imports.Get(id);
+        if (entry.frame == frame.id)
         {
-            m_passes.back()->EndEvent();
+            return entry.handle;
         }
+
+        entry.handle = entry.texture ? Import((IGfxTexture*)entry.resource, entry.state) : Import((IGfxBuffer*)entry.resource, entry.state);
+        entry.frame  = frame.id;
+        frame.imports.push_back(id);
+
+        return entry.handle;
     }
 
-    void RenderGraph::Clear()
+    RGHandle RenderGraph::AddClearPass(cpstr_t name, const RGHandle& target, u32 subresource, const float4& clear_color)
     {
-        for (size_t i = 0; i < m_objFinalizer.size(); ++i)
-        {
-            m_objFinalizer[i].finalizer(m_objFinalizer[i].obj);
-        }
-        m_objFinalizer.clear();
+        RGHandle output;
 
-        m_graph.Clear();
+        RenderGraphPass<ClearPassData>& pass = AddPass<ClearPassData>(
+            name, RenderPassType::Graphics, [&](ClearPassData& data, RGBuilder& builder) { output = builder.WriteColor(0, target, subresource, ngfx::GfxRenderPass::LoadClear, clear_color); },
+            [](const ClearPassData& data, IGfxCommandList* pCommandList) {});
+        pass.SetClearPass();
+
+        return output;
+    }
 
-        m_passes.clear();
-        m_resourceNodes.clear();
-        m_resources.clear();
+    RGHandle RenderGraph::AddClearDepthPass(cpstr_t name, const RGHandle& target, u32 subresource, float clear_depth, u32 clear_stencil)
+    {
+        RGHandle output;
 
-        m_allocator.Reset();
-        m_resourceAllocator.Reset();
+        RenderGraphPass<ClearPassData>& pass = AddPass<ClearPassData>(
+            name, RenderPassType::Graphics,
+            [&](ClearPassData& data, RGBuilder& builder) { output = builder.WriteDepth(target, subresource, ngfx::GfxRenderPass::LoadClear, ngfx::GfxRenderPass::LoadClear, clear_depth, clear_stencil); },
+            [](const ClearPassData& data, IGfxCommandList* pCommandList) {});
+        pass.SetClearPass();
 
-        m_outputResources.clear();
+        return output;
     }
 
-    void RenderGraph::Compile()
+    const RGSubgraphInstance& RenderGraph::Instantiate(const RenderGraphSubgraph& subgraph, const RGHandle* inputs, u32 num_inputs, u32 index)
     {
-        CPU_EVENT("Render", "RenderGraph::Compile");
+        ASSERT(subgraph.IsCompiled());
+        ASSERT(num_inputs == subgraph.GetNumInputs());
+
+        Frame& frame = GetRecordFrame();
 
-        m_graph.Cull();
+        const u32 num_nodes  = (u32)subgraph.m_nodeResources.size();
+        const u32 num_passes = (u32)subgraph.m_passes.size();
 
-        RenderGraphAsyncResolveContext context;
+        RGSubgraphInstance* instance = AllocatePOD<RGSubgraphInstance>();
+        instance->m_handles          = (RGHandle*)frame.allocator->Alloc(sizeof(RGHandle) * num_nodes);
+        instance->m_numHandles       = num_nodes;
+        instance->m_index            = index;
 
-        for (size_t i = 0; i < m_passes.size(); ++i)
+        // version 0 of every resource, the other nodes are created while replaying the writes
+        RGHandle* handles = instance->m_handles;
+        for (size_t i = 0; i < subgraph.m_resources.size(); ++i)
         {
-            RenderGraphPassBase* pass = m_passes[i];
-            if (!pass->IsCulled())
+            const RenderGraphSubgraph::Resource& resource = subgraph.m_resources[i];
+
+            if (resource.input >= 0)
+            {
+                ASSERT(inputs[resource.input].IsValid());
+                handles[resource.node] = Resolve(inputs[resource.input]);
+            }
+            else if (resource.texture)
+            {
+                handles[resource.node] = Create<RGTexture>(resource.texture_desc, resource.name);
+            }
+            else
             {
-                pass->ResolveAsyncCompute(m_graph, context);
+                handles[resource.node] = Create<RGBuffer>(resource.buffer_desc, resource.name);
             }
         }
 
-        vector_t<DAGEdge*> edges;
+        RenderGraphPassBase** passes = (RenderGraphPassBase**)frame.allocator->Alloc(sizeof(RenderGraphPassBase*) * num_passes);
 
-        for (size_t i = 0; i < m_resourceNodes.size(); ++i)
+        for (u32 p = 0; p < num_passes; ++p)
         {
-            RenderGraphResourceNode* node = m_resourceNodes[i];
-            if (node->IsCulled())
+            const RenderGraphSubgraph::Pass& record = subgraph.m_passes[p];
+
+            RenderGraphPassBase* pass = record.proto->Instantiate(*this, instance);
+            passes[p]                 = pass;
+
+#if RENDER_GRAPH_EVENTS
+            AttachPendingEvents(pass);
+#endif
+
+            if (record.skip_culling)
             {
-                continue;
+                pass->MakeTarget();
             }
 
-            RenderGraphResource* resource = node->GetResource();
-
-            m_graph.GetOutgoingEdges(node, edges);
-            for (size_t i = 0; i < edges.size(); ++i)
+            for (u32 o = record.first_op; o < record.first_op + record.num_ops; ++o)
             {
-                RenderGraphEdge*     edge = (RenderGraphEdge*)edges[i];
-                RenderGraphPassBase* pass = (RenderGraphPassBase*)m_graph.GetNode(edge->GetToNode());
+                const RenderGraphSubgraph::Op& op    = subgraph.m_ops[o];
+                const RGHandle&                input = handles[op.input_node];
 
-                if (!pass->IsCulled())
+                RGHandle output;
+                switch (op.type)
                 {
-                    resource->Resolve(edge, pass);
+                    case RenderGraphSubgraph::OpType::Read: output = Read(pass, input, op.usage, op.subresource, op.stages); break;
+                    case RenderGraphSubgraph::OpType::Write: output = Write(pass, input, op.usage, op.subresource, op.non_overlapping, op.stages, op.full_coverage); break;
+                    case RenderGraphSubgraph::OpType::WriteColor:
+                        output = WriteColor(pass, op.color_index, input, op.subresource, op.load_op, float4(op.clear_color[0], op.clear_color[1], op.clear_color[2], op.clear_color[3]), op.full_coverage);
+                        break;
+                    case RenderGraphSubgraph::OpType::WriteDepth: output = WriteDepth(pass, input, op.subresource, op.load_op, op.stencil_load_op, op.clear_depth, op.clear_stencil, op.full_coverage); break;
+                    case RenderGraphSubgraph::OpType::ReadDepth: output = ReadDepth(pass, input, op.subresource); break;
+                    default: ASSERT(false); break;
                 }
-            }
 
-            m_graph.GetIncomingEdges(node, edges);
-            for (size_t i = 0; i < edges.size(); ++i)
-            {
-                RenderGraphEdge*     edge = (RenderGraphEdge*)edges[i];
-                RenderGraphPassBase* pass = (RenderGraphPassBase*)m_graph.GetNode(edge->GetToNode());
+                if (op.output_node != RenderGraphSubgraph::InvalidIndex)
+                {
+                    handles[op.output_node] = output;
+                }
 
-                if (!pass->IsCulled())
+                if (op.prev_pass != RenderGraphSubgraph::InvalidIndex)
                 {
-                    resource->Resolve(edge, pass);
+                    pass->AddPrecompiledState(frame.resources[input.index], op.subresource, passes[op.prev_pass]->GetId(), op.old_state, op.old_stages, op.uav_barrier);
                 }
             }
+
+            pass->SetIndex((u32)frame.passes.size());
+
+            frame.passes.push_back(pass);
         }
 
-        for (size_t i = 0; i < m_resources.size(); ++i)
+        for (size_t i = 0; i < subgraph.m_resources.size(); ++i)
         {
-            RenderGraphResource* resource = m_resources[i];
-            if (resource->IsUsed())
+            const RenderGraphSubgraph::Resource& resource = subgraph.m_resources[i];
+            if (resource.pre_resolved)
             {
-                resource->Realize();
+                frame.resources[handles[resource.node].index]->SetPreResolved(passes[resource.first_pass]->GetId(), passes[resource.last_pass]->GetId(), resource.last_state);
             }
         }
 
-        for (size_t i = 0; i < m_passes.size(); ++i)
+        return *instance;
+    }
+
+    RenderGraphRecorder* RenderGraph::CreateRecorder(u32 sort_key)
+    {
+        Frame& frame = GetRecordFrame();
+        ASSERT(!frame.compiled);
+
+        if (frame.numRecorders == (u32)frame.recorders.size())
         {
-            RenderGraphPassBase* pass = m_passes[i];
-            if (!pass->IsCulled())
-            {
-                pass->ResolveBarriers(m_graph);
-            }
+            frame.recorders.push_back(new RenderGraphRecorder());
         }
+
+        RenderGraphRecorder* recorder = frame.recorders[frame.numRecorders++];
+        recorder->m_scope             = (u16)frame.numRecorders;
+        recorder->m_sortKey           = sort_key;
+        return recorder;
     }
 
-    void RenderGraph::Execute(Renderer* pRenderer, IGfxCommandList* pCommandList, IGfxCommandList* pComputeCommandList)
+    // the order only depends on the sort keys and the order the recorders were created in, not on the worker threads
+    void RenderGraph::MergeRecorders()
     {
-        CPU_EVENT("Render", "RenderGraph::Execute");
-        GPU_EVENT(pCommandList, "RenderGraph");
+        Frame& frame = GetRecordFrame();
 
-        RenderGraphPassExecuteContext context = {};
-        context.renderer                      = pRenderer;
-        context.graphicsCommandList           = pCommandList;
-        context.computeCommandList            = pComputeCommandList;
-        context.computeQueueFence             = m_pComputeQueueFence.get();
-        context.graphicsQueueFence            = m_pGraphicsQueueFence.get();
-        context.initialComputeFenceValue      = m_nComputeQueueFenceValue;
-        context.initialGraphicsFenceValue     = m_nGraphicsQueueFenceValue;
+        const u32 first = frame.numMergedRecorders;
+        const u32 count = frame.numRecorders - first;
+        if (count == 0)
+        {
+            return;
+        }
 
-        for (size_t i = 0; i < m_passes.size(); ++i)
+        u32* sort_keys = (u32*)frame.allocator->Alloc(sizeof(u32) * count);
+        u32* order     = (u32*)frame.allocator->Alloc(sizeof(u32) * count);
+        for (u32 i = 0; i < count; ++i)
         {
-            RenderGraphPassBase* pass = m_passes[i];
+            sort_keys[i] = frame.recorders[first + i]->m_sortKey;
+        }
+        RGSortMergeOrder(sort_keys, count, order);
 
-            pass->Execute(*this, context);
+        for (u32 i = 0; i < count; ++i)
+        {
+            Merge(frame.recorders[first + order[i]]);
         }
+        frame.numMergedRecorders = frame.numRecorders;
+    }
 
-        m_nComputeQueueFenceValue  = context.lastSignaledComputeValue;
-        m_nGraphicsQueueFenceValue = context.lastSignaledGraphicsValue;
+    void RenderGraph::Merge(RenderGraphRecorder* recorder)
+    {
+        Frame& frame = GetRecordFrame();
+
+        for (size_t i = 0; i < recorder->m_resources.size(); ++i)
+        {
+            const RenderGraphRecorder::Resource& resource = recorder->m_resources[i];
+            recorder->m_nodes[resource.node]              = resource.texture ? Create<RGTexture>(resource.texture_desc, resource.name) : Create<RGBuffer>(resource.buffer_desc, resource.name);
+        }
 
-        for (size_t i = 0; i < m_outputResources.size(); ++i)
+        for (size_t p = 0; p < recorder->m_passes.size(); ++p)
         {
-            const PresentTarget& target = m_outputResources[i];
-            if (target.resource->GetFinalState() != target.state)
+            const RenderGraphRecorder::Pass& record = recorder->m_passes[p];
+
+            RenderGraphPassBase* pass = record.proto->Instantiate(*this);
+#if RENDER_GRAPH_EVENTS
+            AttachPendingEvents(pass);
+#endif
+            if (record.skip_culling)
             {
-                target.resource->Barrier(pCommandList, 0, target.resource->GetFinalState(), target.state);
-                target.resource->SetFinalState(target.state);
+                pass->MakeTarget();
+            }
+
+            for (u32 o = record.first_op; o < record.first_op + record.num_ops; ++o)
+            {
+                const RenderGraphRecorder::Op& op = recorder->m_ops[o];
+
+                // a local input was created by an earlier op, so it is already mapped to the render graph
+                const RGHandle input = op.input.scope == recorder->m_scope ? recorder->m_nodes[op.input.node] : Resolve(op.input);
+
+                RGHandle output;
+                switch (op.type)
+                {
+                    case RenderGraphRecorder::OpType::Read: output = Read(pass, input, op.usage, op.subresource, op.stages); break;
+                    case RenderGraphRecorder::OpType::Write: output = Write(pass, input, op.usage, op.subresource, op.non_overlapping, op.stages, op.full_coverage); break;
+                    case RenderGraphRecorder::OpType::WriteColor:
+                        output = WriteColor(pass, op.color_index, input, op.subresource, op.load_op, float4(op.clear_color[0], op.clear_color[1], op.clear_color[2], op.clear_color[3]), op.full_coverage);
+                        break;
+                    case RenderGraphRecorder::OpType::WriteDepth: output = WriteDepth(pass, input, op.subresource, op.load_op, op.stencil_load_op, op.clear_depth, op.clear_stencil, op.full_coverage); break;
+                    case RenderGraphRecorder::OpType::ReadDepth: output = ReadDepth(pass, input, op.subresource); break;
+                    default: ASSERT(false); break;
+                }
+
+                if (op.output_node != RenderGraphRecorder::InvalidIndex)
+                {
+                    recorder->m_nodes[op.output_node] = output;
+                }
             }
+
+            pass->SetIndex((u32)frame.passes.size());
+
+            frame.passes.push_back(pass);
         }
-        m_outputResources.clear();
+
+        recorder->m_bMerged = true;
     }
 
-    void RenderGraph::Present(const RGHandle& handle, ngfx::GfxAccess::Flags filnal_state)
+    // handles of a recorder refer to its local nodes, the render graph handle is known once the recorder was merged
+    RGHandle RenderGraph::Resolve(const RGHandle& handle) const
     {
-        ASSERT(handle.IsValid());
+        if (handle.scope == 0)
+        {
+            return handle;
+        }
 
-        RenderGraphResource* resource = GetTexture(handle);
-        resource->SetOutput(true);
+        const Frame& frame = GetFrame();
+        ASSERT(handle.scope <= frame.numRecorders);
+        return frame.recorders[handle.scope - 1]->Resolve(handle);
+    }
 
-        RenderGraphResourceNode* node = m_resourceNodes[handle.node];
-        node->MakeTarget();
+    namespace
+    {
+        u64 HashEdges(const DirectedAcyclicGraph& graph, const vector_t<DAGEdge*>& edges, bool incoming, u64 hash)
+        {
+            hash = RGHashValue((u32)edges.size(), hash);
+            for (size_t i = 0; i < edges.size(); ++i)
+            {
+                const RenderGraphEdge*         edge = (const RenderGraphEdge*)edges[i];
+                const RenderGraphResourceNode* node = (const RenderGraphResourceNode*)graph.GetNode(incoming ? edge->GetFromNode() : edge->GetToNode());
+
+                hash = RGHashValue(node->GetResource()->GetIndex(), hash);
+                hash = RGHashValue(node->GetVersion(), hash);
+                hash = RGHashValue(edge->GetUsage(), hash);
+                hash = RGHashValue(edge->GetSubresource(), hash);
+                hash = RGHashValue(edge->IsNonOverlappingWrite(), hash);
+            }
+            return hash;
+        }
+    } // namespace
 
-        PresentTarget target;
-        target.resource = resource;
-        target.state    = filnal_state;
-        m_outputResources.push_back(target);
+    u64 RenderGraph::GetStructuralHash() const { return HashStructure(GetRecordFrame()); }
+
+    // only positions and values go into the hash, so the same graph hashes the same across runs. Nothing Compile
+    // changes is hashed, the hash is only computed when a cache is checked or saved.
+    u64 RenderGraph::HashStructure(const Frame& frame) const
+    {
+        u64 hash = RGHashValue(RGCompiledGraphHeader::Version, 14695981039346656037ull);
+
+        hash = RGHashValue((u32)frame.resources.size(), hash);
+        for (size_t i = 0; i < frame.resources.size(); ++i)
+        {
+            hash = frame.resources[i]->HashDesc(hash);
+        }
+
+        vector_t<DAGEdge*> edges;
+
+        hash = RGHashValue((u32)frame.passes.size(), hash);
+        for (size_t i = 0; i < frame.passes.size(); ++i)
+        {
+            RenderGraphPassBase* pass = frame.passes[i];
+            hash                      = RGHashValue(pass->GetType(), hash);
+
+            frame.graph.GetIncomingEdges(pass, edges);
+            hash = HashEdges(frame.graph, edges, true, hash);
+
+            frame.graph.GetOutgoingEdges(pass, edges);
+            hash = HashEdges(frame.graph, edges, false, hash);
+        }
+
+        for (size_t i = 0; i < frame.outputResources.size(); ++i)
+        {
+            hash = RGHashValue(frame.outputResources[i].resource->GetIndex(), hash);
+            hash = RGHashValue(frame.outputResources[i].state, hash);
+        }
+
+        return hash;
     }
 
-    RGTexture* RenderGraph::GetTexture(const RGHandle& handle)
+    u32 RenderGraph::SaveCompiled(void* data, u32 capacity) const
     {
-        if (!handle.IsValid())
+        // Execute moves the final state of the presented resources
+        const Frame& frame = GetRecordFrame();
+        ASSERT(frame.compiled && frame.stagingFence == 0);
+
+        const u32 num_passes    = (u32)frame.passes.size();
+        const u32 num_resources = (u32)frame.resources.size();
+        const u32 num_heaps     = m_resourceAllocator.GetHeapLayout(nullptr, 0);
+
+        const u32 size = RenderGraphCompiledGraph::GetSize(num_passes, num_resources, num_heaps);
+        if (data == nullptr || capacity < size)
         {
-            return nullptr;
+            return size;
         }
 
-        RenderGraphResource* resource = m_resources[handle.index];
-        ASSERT(dynamic_cast<RGTexture*>(resource) != nullptr);
-        return (RGTexture*)resource;
+        RGCompiledGraphHeader* header    = RenderGraphCompiledGraph::Init(data, HashStructure(frame), num_passes, num_resources, num_heaps);
+        header->graphicsConstantsPending = frame.graphicsConstantsPending ? 1 : 0;
+
+        RGCompiledPass* passes = RenderGraphCompiledGraph::GetPasses(header);
+        for (u32 i = 0; i < num_passes; ++i)
+        {
+            frame.passes[i]->SaveCompiled(frame.graph, passes[i]);
+        }
+
+        RGCompiledResource* resources = RenderGraphCompiledGraph::GetResources(header);
+        for (u32 i = 0; i < num_resources; ++i)
+        {
+            const RenderGraphResource* resource = frame.resources[i];
+            RGCompiledResource&        record   = resources[i];
+
+            record.firstPass = RGCompiledPass::InvalidIndex;
+            record.lastPass  = RGCompiledPass::InvalidIndex;
+            record.lastState = resource->GetFinalState();
+            record.pad       = 0;
+
+            if (resource->IsUsed())
+            {
+                record.firstPass = ((const RenderGraphPassBase*)frame.graph.GetNode(resource->GetFirstPassID()))->GetIndex();
+                record.lastPass  = ((const RenderGraphPassBase*)frame.graph.GetNode(resource->GetLastPassID()))->GetIndex();
+            }
+        }
+
+        m_resourceAllocator.GetHeapLayout(RenderGraphCompiledGraph::GetHeaps(header), num_heaps);
+
+        return size;
     }
 
-    RGBuffer* RenderGraph::GetBuffer(const RGHandle& handle)
+    bool RenderGraph::LoadCompiled(const void* data, u32 size)
     {
-        if (!handle.IsValid())
+        m_pCompiledGraph         = RenderGraphCompiledGraph::Validate(data, size);
+        m_bCompiledHeapsReserved = false;
+        return m_pCompiledGraph != nullptr;
+    }
+
+    // the cache is only taken when the graph and its culling agree with it, nothing is touched otherwise
+    bool RenderGraph::ApplyCompiled(Frame& frame, const RGCompiledGraphHeader* header)
+    {
+        const u32 num_passes    = (u32)frame.passes.size();
+        const u32 num_resources = (u32)frame.resources.size();
+        if (header->numPasses != num_passes || header->numResources != num_resources || header->hash != HashStructure(frame))
         {
-            return nullptr;
+            return false;
         }
 
-        RenderGraphResource* resource = m_resources[handle.index];
-        ASSERT(dynamic_cast<RGBuffer*>(resource) != nullptr);
-        return (RGBuffer*)resource;
+        const RGCompiledPass*     passes    = RenderGraphCompiledGraph::GetPasses(header);
+        const RGCompiledResource* resources = RenderGraphCompiledGraph::GetResources(header);
+
+        for (u32 i = 0; i < num_passes; ++i)
+        {
+            const RGCompiledPass& record = passes[i];
+            if ((record.culled != 0) != frame.passes[i]->IsCulled() || (record.asyncPromoted != 0 && frame.passes[i]->GetType() != RenderPassType::Compute))
+            {
+                return false;
+            }
+            if ((record.waitGraphicsPass != RGCompiledPass::InvalidIndex && record.waitGraphicsPass >= num_passes) ||
+                (record.signalGraphicsPass != RGCompiledPass::InvalidIndex && record.signalGraphicsPass >= num_passes))
+            {
+                return false;
+            }
+        }
+
+        for (u32 i = 0; i < num_resources; ++i)
+        {
+            const RGCompiledResource& record = resources[i];
+            if (record.firstPass != RGCompiledPass::InvalidIndex && (record.firstPass >= num_passes || record.lastPass >= num_passes))
+            {
+                return false;
+            }
+        }
+
+        for (u32 i = 0; i < num_passes; ++i)
+        {
+            frame.passes[i]->LoadCompiled(passes[i], frame.passes.data());
+        }
+        frame.graphicsConstantsPending = header->graphicsConstantsPending != 0;
+
+        for (u32 i = 0; i < num_resources; ++i)
+        {
+            const RGCompiledResource& record   = resources[i];
+            RenderGraphResource*      resource = frame.resources[i];
+            if (record.firstPass != RGCompiledPass::InvalidIndex)
+            {
+                resource->SetPreResolved(frame.passes[record.firstPass]->GetId(), frame.passes[record.lastPass]->GetId(), record.lastState);
+            }
+            else
+            {
+                resource->ResetPreResolved();
+            }
+        }
+
+        // the heap layout only matters for the first frames, later ones find the heaps in the pool
+        if (!m_bCompiledHeapsReserved)
+        {
+            m_resourceAllocator.ReserveHeaps(RenderGraphCompiledGraph::GetHeaps(header), header->numHeaps);
+            m_bCompiledHeapsReserved = true;
+        }
+
+        // the promotions came with the cache, the report of the frame is rebuilt from them
+        frame.PromoteAsyncCompute(m_pPromotionCost, m_pPromotionUserData, m_nPromotionMinCost, true);
+
+        return true;
     }
 
-    // eastl::string RenderGraph::Export() { return m_graph.ExportGraphviz(); }
+    RGHandle RenderGraph::CreateHistory(const RGTexture::Desc& desc, cpstr_t name, u32 frames_ago, u32 history_length)
+    {
+        Frame& frame = GetRecordFrame();
 
-    RGHandle RenderGraph::Import(IGfxTexture* texture, ngfx::GfxAccess::Flags state)
+        auto resource = Allocate<RGTexture>(m_resourceAllocator, name, desc, history_length, frames_ago);
+        auto node     = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, 0);
+
+        RGHandle handle;
+        handle.index = (u16)frame.resources.size();
+        handle.node  = (u16)frame.resourceNodes.size();
+
+        resource->SetIndex(handle.index);
+
+        frame.resources.push_back(resource);
+        frame.resourceNodes.push_back(node);
+
+        return handle;
+    }
+
+    RGHandle RenderGraph::CreateUploadBuffer(u32 size, cpstr_t name, void*& cpu_address)
     {
-        auto resource = Allocate<RGTexture>(m_resourceAllocator, texture, state);
-        auto node     = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, 0);
+        Frame& frame = GetRecordFrame();
+
+        u32 offset;
+        {
+            RenderGraphScopedLock lock(m_stagingLock);
+            m_uploadRing.Retire(m_pStagingFence->GetCompletedValue());
+
+            if (!m_uploadRing.Allocate(size, 512, offset))
+            {
+                cpu_address = nullptr;
+                return RGHandle();
+            }
+        }
+        cpu_address = m_uploadRing.GetCpuAddress() + offset;
+
+        auto resource = Allocate<RGBuffer>(m_resourceAllocator, name, m_uploadRing.GetBuffer(), offset, size, ngfx::GfxAccess::CopySrc);
+        auto node     = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, 0);
 
         RGHandle handle;
-        handle.index = (u16)m_resources.size();
-        handle.node  = (u16)m_resourceNodes.size();
+        handle.index = (u16)frame.resources.size();
+        handle.node  = (u16)frame.resourceNodes.size();
 
-        m_resources.push_back(resource);
-        m_resourceNodes.push_back(node);
+        resource->SetIndex(handle.index);
+
+        frame.resources.push_back(resource);
+        frame.resourceNodes.push_back(node);
 
         return handle;
     }
 
-    RGHandle RenderGraph::Import(IGfxBuffer* buffer, ngfx::GfxAccess::Flags state)
+    RGHandle RenderGraph::CreateReadbackBuffer(u32 size, cpstr_t name)
     {
-        auto resource = Allocate<RGBuffer>(m_resourceAllocator, buffer, state);
-        auto node     = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, 0);
+        Frame& frame = GetRecordFrame();
+
+        u32 offset;
+        {
+            RenderGraphScopedLock lock(m_stagingLock);
+
+            // keep the range of a finished readback around for a few frames, so there is time to read it
+            u64 completed = m_pStagingFence->GetCompletedValue();
+            m_readbackRing.Retire(completed > GFX_MAX_INFLIGHT_FRAMES ? completed - GFX_MAX_INFLIGHT_FRAMES : 0);
+
+            if (!m_readbackRing.Allocate(size, 512, offset))
+            {
+                return RGHandle();
+            }
+        }
+
+        auto resource = Allocate<RGBuffer>(m_resourceAllocator, name, m_readbackRing.GetBuffer(), offset, size, ngfx::GfxAccess::CopyDst);
+        auto node     = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, 0);
 
         RGHandle handle;
-        handle.index = (u16)m_resources.size();
-        handle.node  = (u16)m_resourceNodes.size();
+        handle.index = (u16)frame.resources.size();
+        handle.node  = (u16)frame.resourceNodes.size();
+
+        resource->SetIndex(handle.index);
 
-        m_resources.push_back(resource);
-        m_resourceNodes.push_back(node);
+        frame.resources.push_back(resource);
+        frame.resourceNodes.push_back(node);
 
         return handle;
     }
 
-    RGHandle RenderGraph::Read(RenderGraphPassBase* pass, const RGHandle& input, ngfx::GfxAccess::Flags usage, u32 subresource)
+    RGReadback RenderGraph::GetReadback(const RGHandle& handle) const
+    {
+        ASSERT(handle.IsValid());
+
+        // the fence of a frame is known once it was executed
+        const Frame& frame = GetFrame();
+        ASSERT(frame.stagingFence != 0);
+
+        RGBuffer* buffer = (RGBuffer*)frame.resources[Resolve(handle).index];
+        ASSERT(buffer->IsReadback());
+
+        RGReadback readback;
+        readback.fence  = frame.stagingFence;
+        readback.offset = buffer->GetOffset();
+        readback.size   = buffer->GetSize();
+        return readback;
+    }
+
+    const void* RenderGraph::MapReadback(const RGReadback& readback) const
+    {
+        if (!readback.IsValid() || m_pStagingFence->GetCompletedValue() < readback.fence)
+        {
+            return nullptr;
+        }
+        return m_readbackRing.GetCpuAddress() + readback.offset;
+    }
+
+    RGHandle RenderGraph::Read(RenderGraphPassBase* pass, const RGHandle& handle, ngfx::GfxAccess::Flags usage, u32 subresource, RGShaderStage stages)
     {
-        ASSERT(input.IsValid());
-        RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
+        ASSERT(handle.IsValid());
+        const RGHandle input = Resolve(handle);
 
-        AllocatePOD<RenderGraphEdge>(m_graph, input_node, pass, usage, subresource);
+        Frame&                   frame      = GetRecordFrame();
+        RenderGraphResourceNode* input_node = frame.resourceNodes[input.node];
+
+        RenderGraphEdge* edge = AllocatePOD<RenderGraphEdge>(frame.graph, input_node, pass, usage, subresource);
+        if (stages != RGShaderStage::None)
+        {
+            edge->SetStages(stages);
+        }
 
         return input;
     }
 
-    RGHandle RenderGraph::Write(RenderGraphPassBase* pass, const RGHandle& input, ngfx::GfxAccess::Flags usage, u32 subresource)
+    RGHandle RenderGraph::Write(RenderGraphPassBase* pass, const RGHandle& handle, ngfx::GfxAccess::Flags usage, u32 subresource, bool non_overlapping, RGShaderStage stages, bool full_coverage)
     {
-        ASSERT(input.IsValid());
-        RenderGraphResource* resource = m_resources[input.index];
+        ASSERT(handle.IsValid());
+        const RGHandle input = Resolve(handle);
+
+        Frame&               frame    = GetRecordFrame();
+        RenderGraphResource* resource = frame.resources[input.index];
+
+        RenderGraphResourceNode* input_node = frame.resourceNodes[input.node];
+        RenderGraphEdge*         input_edge = AllocatePOD<RenderGraphEdge>(frame.graph, input_node, pass, usage, subresource);
+
+        RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, input_node->GetVersion() + 1);
+        RenderGraphEdge*         output_edge = AllocatePOD<RenderGraphEdge>(frame.graph, pass, output_node, usage, subresource);
+
+        // both edges carry the flag, the next writer finds this pass through the output node
+        if (non_overlapping)
+        {
+            input_edge->SetNonOverlappingWrite();
+            output_edge->SetNonOverlappingWrite();
+        }
 
-        RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
-        AllocatePOD<RenderGraphEdge>(m_graph, input_node, pass, usage, subresource);
+        if (full_coverage)
+        {
+            input_edge->SetFullCoverageWrite();
+            output_edge->SetFullCoverageWrite();
+        }
 
-        RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, input_node->GetVersion() + 1);
-        AllocatePOD<RenderGraphEdge>(m_graph, pass, output_node, usage, subresource);
+        if (stages != RGShaderStage::None)
+        {
+            input_edge->SetStages(stages);
+            output_edge->SetStages(stages);
+        }
 
         RGHandle output;
         output.index = input.index;
-        output.node  = (u16)m_resourceNodes.size();
+        output.node  = (u16)frame.resourceNodes.size();
 
-        m_resourceNodes.push_back(output_node);
+        frame.resourceNodes.push_back(output_node);
 
         return output;
     }
 
-    RGHandle RenderGraph::WriteColor(RenderGraphPassBase* pass, u32 color_index, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, const float4& clear_color)
+    RGHandle RenderGraph::WriteColor(RenderGraphPassBase* pass, u32 color_index, const RGHandle& handle, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, const float4& clear_color, bool full_coverage)
     {
-        ASSERT(input.IsValid());
-        RenderGraphResource* resource = m_resources[input.index];
+        ASSERT(handle.IsValid());
+        const RGHandle input = Resolve(handle);
+
+        Frame&               frame    = GetRecordFrame();
+        RenderGraphResource* resource = frame.resources[input.index];
 
         ngfx::GfxAccess::Flags usage = ngfx::GfxAccess::RTV;
 
-        RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
-        AllocatePOD<RenderGraphEdgeColorAttchment>(m_graph, input_node, pass, usage, subresource, color_index, load_op, clear_color);
+        RenderGraphResourceNode* input_node = frame.resourceNodes[input.node];
+        RenderGraphEdge*         input_edge = AllocatePOD<RenderGraphEdgeColorAttchment>(frame.graph, input_node, pass, usage, subresource, color_index, load_op, clear_color);
 
-        RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, input_node->GetVersion() + 1);
-        AllocatePOD<RenderGraphEdgeColorAttchment>(m_graph, pass, output_node, usage, subresource, color_index, load_op, clear_color);
+        RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, input_node->GetVersion() + 1);
+        RenderGraphEdge*         output_edge = AllocatePOD<RenderGraphEdgeColorAttchment>(frame.graph, pass, output_node, usage, subresource, color_index, load_op, clear_color);
+
+        if (full_coverage)
+        {
+            input_edge->SetFullCoverageWrite();
+            output_edge->SetFullCoverageWrite();
+        }
 
         RGHandle output;
         output.index = input.index;
-        output.node  = (u16)m_resourceNodes.size();
+        output.node  = (u16)frame.resourceNodes.size();
 
-        m_resourceNodes.push_back(output_node);
+        frame.resourceNodes.push_back(output_node);
 
         return output;
     }
 
-    RGHandle RenderGraph::WriteDepth(RenderGraphPassBase* pass, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth, u32 clear_stencil)
+    RGHandle RenderGraph::WriteDepth(RenderGraphPassBase* pass, const RGHandle& handle, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth, u32 clear_stencil, bool full_coverage)
     {
-        ASSERT(input.IsValid());
-        RenderGraphResource* resource = m_resources[input.index];
+        ASSERT(handle.IsValid());
+        const RGHandle input = Resolve(handle);
+
+        Frame&               frame    = GetRecordFrame();
+        RenderGraphResource* resource = frame.resources[input.index];
 
         ngfx::GfxAccess::Flags usage = ngfx::GfxAccess::DSV;
 
-        RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
-        AllocatePOD<RenderGraphEdgeDepthAttchment>(m_graph, input_node, pass, usage, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
+        RenderGraphResourceNode* input_node = frame.resourceNodes[input.node];
+        RenderGraphEdge*         input_edge = AllocatePOD<RenderGraphEdgeDepthAttchment>(frame.graph, input_node, pass, usage, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
+
+        RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, input_node->GetVersion() + 1);
+        RenderGraphEdge*         output_edge = AllocatePOD<RenderGraphEdgeDepthAttchment>(frame.graph, pass, output_node, usage, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
 
-        RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, input_node->GetVersion() + 1);
-        AllocatePOD<RenderGraphEdgeDepthAttchment>(m_graph, pass, output_node, usage, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
+        if (full_coverage)
+        {
+            input_edge->SetFullCoverageWrite();
+            output_edge->SetFullCoverageWrite();
+        }
 
         RGHandle output;
         output.index = input.index;
-        output.node  = (u16)m_resourceNodes.size();
+        output.node  = (u16)frame.resourceNodes.size();
 
-        m_resourceNodes.push_back(output_node);
+        frame.resourceNodes.push_back(output_node);
 
         return output;
     }
 
-    RGHandle RenderGraph::ReadDepth(RenderGraphPassBase* pass, const RGHandle& input, u32 subresource)
+    RGHandle RenderGraph::ReadDepth(RenderGraphPassBase* pass, const RGHandle& handle, u32 subresource)
     {
-        ASSERT(input.IsValid());
-        RenderGraphResource* resource = m_resources[input.index];
+        ASSERT(handle.IsValid());
+        const RGHandle input = Resolve(handle);
+
+        Frame&               frame    = GetRecordFrame();
+        RenderGraphResource* resource = frame.resources[input.index];
 
         ngfx::GfxAccess::Flags usage = ngfx::GfxAccess::DSVReadOnly;
 
-        RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
-        AllocatePOD<RenderGraphEdgeDepthAttchment>(m_graph, input_node, pass, usage, subresource, ngfx::GfxRenderPass::LoadLoad, ngfx::GfxRenderPass::LoadLoad, 0.0f, 0);
+        RenderGraphResourceNode* input_node = frame.resourceNodes[input.node];
+        AllocatePOD<RenderGraphEdgeDepthAttchment>(frame.graph, input_node, pass, usage, subresource, ngfx::GfxRenderPass::LoadLoad, ngfx::GfxRenderPass::LoadLoad, 0.0f, 0);
 
-        RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, input_node->GetVersion() + 1);
-        AllocatePOD<RenderGraphEdgeDepthAttchment>(m_graph, pass, output_node, usage, subresource, ngfx::GfxRenderPass::LoadLoad, ngfx::GfxRenderPass::LoadLoad, 0.0f, 0);
+        RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, input_node->GetVersion() + 1);
+        AllocatePOD<RenderGraphEdgeDepthAttchment>(frame.graph, pass, output_node, usage, subresource, ngfx::GfxRenderPass::LoadLoad, ngfx::GfxRenderPass::LoadLoad, 0.0f, 0);
 
         RGHandle output;
         output.index = input.index;
-        output.node  = (u16)m_resourceNodes.size();
+        output.node  = (u16)frame.resourceNodes.size();
 
-        m_resourceNodes.push_back(output_node);
+        frame.resourceNodes.push_back(output_node);
 
         return output;
     }
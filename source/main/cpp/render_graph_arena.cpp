@@ -0,0 +1,86 @@
+#include "crendergraph/render_graph_arena.h"
+#include "cbase/c_allocator.h"
+#include "cbase/c_context.h"
+
+namespace ncore
+{
+    static const u32 BlockHeader = 16;
+
+    RenderGraphArena::RenderGraphArena(u32 block_size)
+        : m_blockSize(block_size)
+    {
+        m_pCurrent = AddBlock(block_size);
+    }
+
+    RenderGraphArena::~RenderGraphArena()
+    {
+        Block* block = m_pFirst;
+        while (block != nullptr)
+        {
+            Block* next = block->next;
+            context_t::system_alloc()->deallocate(block);
+            block = next;
+        }
+    }
+
+    u8* RenderGraphArena::GetData(Block* block) { return (u8*)block + BlockHeader; }
+
+    RenderGraphArena::Block* RenderGraphArena::AddBlock(u32 min_size)
+    {
+        const u32 size = min_size > m_blockSize ? min_size : m_blockSize;
+
+        Block* block = (Block*)context_t::system_alloc()->allocate(BlockHeader + size, 16);
+        ASSERT(block != nullptr);
+
+        block->next = nullptr;
+        block->size = size;
+        block->used = 0;
+
+        if (m_pLast != nullptr)
+        {
+            m_pLast->next = block;
+        }
+        else
+        {
+            m_pFirst = block;
+        }
+        m_pLast = block;
+        m_numBlocks++;
+        return block;
+    }
+
+    // a request that doesn't fit the current block moves on to the next one, the rest of the block stays unused until Reset
+    void* RenderGraphArena::Alloc(u32 size, u32 alignment)
+    {
+        ASSERT((alignment & (alignment - 1)) == 0);
+
+        for (;;)
+        {
+            const uintptr_t base    = (uintptr_t)GetData(m_pCurrent);
+            const uintptr_t aligned = (base + m_pCurrent->used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            if (aligned + size <= base + m_pCurrent->size)
+            {
+                m_pCurrent->used = (u32)(aligned + size - base);
+                return (void*)aligned;
+            }
+
+            if (m_pCurrent->next == nullptr)
+            {
+                m_pCurrent = AddBlock(size + alignment);
+            }
+            else
+            {
+                m_pCurrent = m_pCurrent->next;
+            }
+        }
+    }
+
+    void RenderGraphArena::Reset()
+    {
+        for (Block* block = m_pFirst; block != nullptr; block = block->next)
+        {
+            block->used = 0;
+        }
+        m_pCurrent = m_pFirst;
+    }
+} // namespace ncore
@@ -0,0 +1,159 @@
+#include "crendergraph/render_graph_barrier_stats.h"
+#include "crendergraph/render_graph.h"
+
+namespace ncore
+{
+    void RenderGraphBarrierStats::Reset()
+    {
+        m_records.clear();
+        m_transitions.Clear();
+        m_discards.Clear();
+
+        for (u32 i = 0; i < (u32)RGBarrierClass::Count; ++i)
+        {
+            m_counts[i] = 0;
+        }
+        m_nResourceBarriers = 0;
+        m_nDiscardBarriers  = 0;
+    }
+
+    void RenderGraphBarrierStats::Add(const RGBarrierRecord* records, u32 count)
+    {
+        for (u32 i = 0; i < count; ++i)
+        {
+            RGBarrierRecord record = records[i];
+            record.type            = RGBarrierClass::Required;
+
+            if (record.discard)
+            {
+                // nothing to preserve when the previous owner never left the discard state or another resource discarded it first
+                if ((record.old_state & ~GfxAccessDiscard) == 0 || IsDiscarded(record.aliased))
+                {
+                    record.type = RGBarrierClass::RedundantDiscard;
+                }
+                m_nDiscardBarriers++;
+            }
+            else
+            {
+                // a UAV barrier keeps the state, it can't undo anything
+                const RGBarrierRecord* prev = FindPrevTransition(record);
+                if (record.old_state != record.new_state && prev != nullptr && prev->old_state == record.new_state && prev->new_state == record.old_state)
+                {
+                    record.type = RGBarrierClass::Undone;
+                }
+                else if (IsReadOnly(record.old_state) && IsReadOnly(record.new_state))
+                {
+                    record.type = RGBarrierClass::ReadToRead;
+                }
+                m_nResourceBarriers++;
+            }
+
+            m_counts[(u32)record.type]++;
+            m_records.push_back(record);
+
+            const u32 index = (u32)m_records.size() - 1;
+            if (!record.discard)
+            {
+                m_transitions.Set(record.resource, record.subresource, index);
+            }
+            else if (record.aliased != nullptr && m_discards.Find(record.aliased, 0) == InvalidRecord)
+            {
+                m_discards.Set(record.aliased, 0, index);
+            }
+        }
+    }
+
+    RGBarrierSource RenderGraphBarrierStats::GetSource(ngfx::GfxAccessFlags new_state)
+    {
+        if (new_state & GfxAccessRTV)
+        {
+            return RGBarrierSource::WriteColor;
+        }
+        if (new_state & GfxAccessDSV)
+        {
+            return RGBarrierSource::WriteDepth;
+        }
+        if (new_state & GfxAccessDSVReadOnly)
+        {
+            return RGBarrierSource::ReadDepth;
+        }
+        if (new_state & (GfxAccessMaskUAV | GfxAccessCopyDst))
+        {
+            return RGBarrierSource::Write;
+        }
+        return RGBarrierSource::Read;
+    }
+
+    bool RenderGraphBarrierStats::IsReadOnly(ngfx::GfxAccessFlags state) { return state != 0 && (state & (GfxAccessRTV | GfxAccessDSV | GfxAccessMaskUAV | GfxAccessCopyDst | GfxAccessDiscard | ngfx::GfxAccess::Present)) == 0; }
+
+    const RGBarrierRecord* RenderGraphBarrierStats::FindPrevTransition(const RGBarrierRecord& record) const
+    {
+        const u32 index = m_transitions.Find(record.resource, record.subresource);
+        return index != InvalidRecord ? &m_records[index] : nullptr;
+    }
+
+    bool RenderGraphBarrierStats::IsDiscarded(IGfxResource* aliased) const { return aliased != nullptr && m_discards.Find(aliased, 0) != InvalidRecord; }
+
+    void RenderGraphBarrierStats::Index::Clear()
+    {
+        slots.clear();
+        count = 0;
+    }
+
+    u32 RenderGraphBarrierStats::Index::Find(const void* key, u32 subresource) const
+    {
+        if (slots.empty())
+        {
+            return InvalidRecord;
+        }
+        return const_cast<Index*>(this)->Probe(key, subresource).record;
+    }
+
+    RenderGraphBarrierStats::IndexSlot& RenderGraphBarrierStats::Index::Probe(const void* key, u32 subresource)
+    {
+        u64 hash = (u64)(uintptr_t)key ^ ((u64)subresource * 0x9e3779b97f4a7c15ull);
+        hash     = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdull;
+
+        const u32 mask = (u32)slots.size() - 1;
+        for (u32 i = (u32)(hash ^ (hash >> 33)) & mask;; i = (i + 1) & mask)
+        {
+            IndexSlot& slot = slots[i];
+            if (slot.key == nullptr || (slot.key == key && slot.subresource == subresource))
+            {
+                return slot;
+            }
+        }
+    }
+
+    void RenderGraphBarrierStats::Index::Set(const void* key, u32 subresource, u32 record)
+    {
+        if ((count + 1) * 2 > (u32)slots.size())
+        {
+            vector_t<IndexSlot> old = slots;
+
+            const u32 capacity = slots.empty() ? 64 : (u32)slots.size() * 2;
+            slots.clear();
+            for (u32 i = 0; i < capacity; ++i)
+            {
+                slots.push_back({nullptr, 0, InvalidRecord});
+            }
+
+            for (size_t i = 0; i < old.size(); ++i)
+            {
+                if (old[i].key != nullptr)
+                {
+                    Probe(old[i].key, old[i].subresource) = old[i];
+                }
+            }
+        }
+
+        IndexSlot& slot = Probe(key, subresource);
+        if (slot.key == nullptr)
+        {
+            slot.key         = key;
+            slot.subresource = subresource;
+            count++;
+        }
+        slot.record = record;
+    }
+} // namespace ncore
@@ -0,0 +1,52 @@
+#include "crendergraph/render_graph_cache.h"
+
+namespace ncore
+{
+    u32 RenderGraphCompiledGraph::GetSize(u32 num_passes, u32 num_resources, u32 num_heaps)
+    {
+        return sizeof(RGCompiledGraphHeader) + sizeof(RGCompiledPass) * num_passes + sizeof(RGCompiledResource) * num_resources + sizeof(RenderGraphResourceAllocator::HeapLayout) * num_heaps;
+    }
+
+    RGCompiledGraphHeader* RenderGraphCompiledGraph::Init(void* data, u64 hash, u32 num_passes, u32 num_resources, u32 num_heaps)
+    {
+        RGCompiledGraphHeader* header    = (RGCompiledGraphHeader*)data;
+        header->magic                    = RGCompiledGraphHeader::Magic;
+        header->version                  = RGCompiledGraphHeader::Version;
+        header->hash                     = hash;
+        header->size                     = GetSize(num_passes, num_resources, num_heaps);
+        header->numPasses                = num_passes;
+        header->numResources             = num_resources;
+        header->numHeaps                 = num_heaps;
+        header->passOffset               = sizeof(RGCompiledGraphHeader);
+        header->resourceOffset           = header->passOffset + sizeof(RGCompiledPass) * num_passes;
+        header->heapOffset               = header->resourceOffset + sizeof(RGCompiledResource) * num_resources;
+        header->graphicsConstantsPending = 0;
+        header->pad[0] = header->pad[1] = header->pad[2] = 0;
+        return header;
+    }
+
+    const RGCompiledGraphHeader* RenderGraphCompiledGraph::Validate(const void* data, u32 size)
+    {
+        if (data == nullptr || size < sizeof(RGCompiledGraphHeader))
+        {
+            return nullptr;
+        }
+
+        const RGCompiledGraphHeader* header = (const RGCompiledGraphHeader*)data;
+        if (header->magic != RGCompiledGraphHeader::Magic || header->version != RGCompiledGraphHeader::Version || header->size > size)
+        {
+            return nullptr;
+        }
+
+        // the arrays are written back to back, anything else is a corrupt or foreign file
+        const u64 pass_end     = (u64)header->passOffset + (u64)sizeof(RGCompiledPass) * header->numPasses;
+        const u64 resource_end = (u64)header->resourceOffset + (u64)sizeof(RGCompiledResource) * header->numResources;
+        const u64 heap_end     = (u64)header->heapOffset + (u64)sizeof(RenderGraphResourceAllocator::HeapLayout) * header->numHeaps;
+        if (header->passOffset != sizeof(RGCompiledGraphHeader) || header->resourceOffset != pass_end || header->heapOffset != resource_end || heap_end != header->size)
+        {
+            return nullptr;
+        }
+
+        return header;
+    }
+} // namespace ncore
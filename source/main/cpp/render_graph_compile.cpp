@@ -0,0 +1,225 @@
+#include "crendergraph/render_graph_compile.h"
+
+namespace ncore
+{
+    // the pairs are in the order of the later pass, so the level of the earlier pass is final when a pair is visited,
+    // and in reverse the latest level of the later pass is
+    u32 RGComputeDependencyLevels(u32 num_passes, const u32* dependencies, u32 num_dependencies, u32* level, u32* latest, u32* critical, const u8* skipped)
+    {
+        for (u32 i = 0; i < num_passes; ++i)
+        {
+            level[i]    = 0;
+            critical[i] = RGNoDependency;
+        }
+
+        for (u32 d = 0; d < num_dependencies; ++d)
+        {
+            const u32 j = dependencies[d * 2];
+            const u32 i = dependencies[d * 2 + 1];
+            if (level[j] + 1 > level[i])
+            {
+                level[i]    = level[j] + 1;
+                critical[i] = j;
+            }
+        }
+
+        u32 num_levels = 0;
+        for (u32 i = 0; i < num_passes; ++i)
+        {
+            if (skipped == nullptr || skipped[i] == 0)
+            {
+                num_levels = math::max(num_levels, level[i] + 1);
+            }
+        }
+
+        for (u32 i = 0; i < num_passes; ++i)
+        {
+            latest[i] = (skipped == nullptr || skipped[i] == 0) ? num_levels - 1 : 0;
+        }
+        for (u32 d = num_dependencies; d > 0; --d)
+        {
+            const u32 j = dependencies[d * 2 - 2];
+            const u32 i = dependencies[d * 2 - 1];
+            latest[j]   = math::min(latest[j], latest[i] - 1);
+        }
+
+        return num_levels;
+    }
+
+    u32 RGGetCriticalPath(u32 num_passes, const u32* level, const u32* critical, u32 num_levels, u32* path, const u8* skipped)
+    {
+        u32 tail = RGNoDependency;
+        for (u32 i = 0; i < num_passes; ++i)
+        {
+            if (level[i] == num_levels - 1 && (skipped == nullptr || skipped[i] == 0))
+            {
+                tail = i;
+            }
+        }
+
+        u32 length = 0;
+        for (u32 i = tail; i != RGNoDependency; i = critical[i])
+        {
+            path[length++] = i;
+        }
+        for (u32 a = 0, b = length - 1; length > 0 && a < b; ++a, --b)
+        {
+            const u32 pass = path[a];
+            path[a]        = path[b];
+            path[b]        = pass;
+        }
+
+        return length;
+    }
+
+    namespace
+    {
+        bool IsReadRun(const RGReadAccess& read, u32 subresource, u8 queue) { return read.subresource == subresource && read.queue == queue && read.mergeable != 0; }
+    } // namespace
+
+    void RGMergeReadStates(RGReadAccess* reads, u32 count)
+    {
+        for (u32 i = 0; i < count; ++i)
+        {
+            reads[i].merged = 0;
+        }
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            const RGReadAccess& read = reads[i];
+            if (read.culled || !read.mergeable)
+            {
+                continue;
+            }
+
+            // only the first read of a run does the work
+            bool run_start = true;
+            for (u32 j = i; j > 0; --j)
+            {
+                const RGReadAccess& prev = reads[j - 1];
+                if (prev.subresource == read.subresource && !prev.culled)
+                {
+                    run_start = !IsReadRun(prev, read.subresource, read.queue);
+                    break;
+                }
+            }
+            if (!run_start)
+            {
+                continue;
+            }
+
+            ngfx::GfxAccessFlags state  = 0;
+            RGShaderStage        stages = RGShaderStage::None;
+            u32                  end    = i;
+            for (; end < count; ++end)
+            {
+                const RGReadAccess& next = reads[end];
+                if (next.subresource != read.subresource || next.culled)
+                {
+                    continue;
+                }
+                if (!IsReadRun(next, read.subresource, read.queue))
+                {
+                    break;
+                }
+                state |= next.usage;
+                stages = stages | next.stages;
+            }
+
+            const u32 subresource = read.subresource;
+            for (u32 j = i; j < end; ++j)
+            {
+                RGReadAccess& next = reads[j];
+                if (next.subresource == subresource && !next.culled)
+                {
+                    next.merged       = 1;
+                    next.state        = state;
+                    next.mergedStages = stages;
+                }
+            }
+        }
+    }
+
+    u32 RGRebalanceEvents(RGPassEvents* passes, u32 num_passes, const u32* stream, u32* live_stream, u32* deferred)
+    {
+        u32 num_live     = 0;
+        u32 num_deferred = 0; // begun events that wait for a live pass
+        u32 prev_live    = RGNoDependency;
+
+        for (u32 i = 0; i < num_passes; ++i)
+        {
+            RGPassEvents& pass = passes[i];
+
+            for (u32 j = 0; j < pass.numBeginEvents; ++j)
+            {
+                deferred[num_deferred++] = stream[pass.firstEvent + j];
+            }
+
+            if (pass.culled)
+            {
+                for (u32 j = 0; j < pass.numEndEvents; ++j)
+                {
+                    if (num_deferred > 0)
+                    {
+                        num_deferred--;
+                    }
+                    else
+                    {
+                        // begun by a live pass, so there is one before this pass
+                        ASSERT(prev_live != RGNoDependency);
+                        passes[prev_live].numEndEvents++;
+                    }
+                }
+                continue;
+            }
+
+            pass.firstEvent     = num_live;
+            pass.numBeginEvents = (u16)num_deferred;
+            for (u32 j = 0; j < num_deferred; ++j)
+            {
+                live_stream[num_live++] = deferred[j];
+            }
+            num_deferred = 0;
+            prev_live    = i;
+        }
+
+        return num_live;
+    }
+
+    RGClearFold RGFoldClear(ngfx::GfxAccessFlags clear_usage, ngfx::GfxAccessFlags write_usage, bool full_coverage, ngfx::GfxRenderPass::LoadOp load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op)
+    {
+        RGClearFold fold = {};
+
+        const bool color = clear_usage == ngfx::GfxAccess::RTV && write_usage == ngfx::GfxAccess::RTV;
+        const bool depth = clear_usage == ngfx::GfxAccess::DSV && write_usage == ngfx::GfxAccess::DSV;
+
+        // EliminateRedundantClears turns the load op of a full coverage write into DontCare
+        if (full_coverage)
+        {
+            fold.folded        = true;
+            fold.stencilLoadOp = depth && RGIsLoad(stencil_load_op);
+        }
+        else if (color || depth)
+        {
+            fold.folded        = true;
+            fold.loadOp        = RGIsLoad(load_op);
+            fold.stencilLoadOp = depth && RGIsLoad(stencil_load_op);
+        }
+
+        return fold;
+    }
+
+    // insertion sort, a frame has a handful of recorders and it is stable
+    void RGSortMergeOrder(const u32* sort_keys, u32 count, u32* order)
+    {
+        for (u32 i = 0; i < count; ++i)
+        {
+            u32 j = i;
+            for (; j > 0 && sort_keys[order[j - 1]] > sort_keys[i]; --j)
+            {
+                order[j] = order[j - 1];
+            }
+            order[j] = i;
+        }
+    }
+} // namespace ncore
@@ -0,0 +1,80 @@
+#include "crendergraph/render_graph_event.h"
+#include "crendergraph/render_graph_job.h"
+
+namespace ncore
+{
+#if RENDER_GRAPH_EVENTS
+    namespace
+    {
+        const u32 MaxEventNames = 1024; // power of two
+
+        struct EventName
+        {
+            std::atomic<u32> id;
+            const char*      name;
+        };
+
+        EventName           s_eventNames[MaxEventNames];
+        RenderGraphSpinLock s_eventLock;
+
+        // the same name may be a different literal in every translation unit, so the characters are compared
+        bool IsSameName(const char* a, const char* b)
+        {
+            while (*a != 0 && *a == *b)
+            {
+                ++a;
+                ++b;
+            }
+            return *a == *b;
+        }
+    } // namespace
+
+    // open addressing on the id, an id of 0 marks a free slot. Ids are published after their name, so lookups don't lock.
+    u32 RenderGraphEventTable::Register(u32 id, const char* name)
+    {
+        ASSERT(id != 0);
+
+        RenderGraphScopedLock lock(s_eventLock);
+
+        for (u32 i = 0; i < MaxEventNames; ++i)
+        {
+            EventName& entry = s_eventNames[(id + i) & (MaxEventNames - 1)];
+
+            u32 entry_id = entry.id.load(std::memory_order_relaxed);
+            if (entry_id == id)
+            {
+                ASSERT(IsSameName(entry.name, name)); // hash collision, rename one of the events
+                return id;
+            }
+            if (entry_id == 0)
+            {
+                entry.name = name;
+                entry.id.store(id, std::memory_order_release);
+                return id;
+            }
+        }
+
+        ASSERT(false); // increase MaxEventNames
+        return id;
+    }
+
+    const char* RenderGraphEventTable::GetName(u32 id)
+    {
+        for (u32 i = 0; i < MaxEventNames; ++i)
+        {
+            const EventName& entry = s_eventNames[(id + i) & (MaxEventNames - 1)];
+
+            u32 entry_id = entry.id.load(std::memory_order_acquire);
+            if (entry_id == id)
+            {
+                return entry.name;
+            }
+            if (entry_id == 0)
+            {
+                break;
+            }
+        }
+        return "unknown event";
+    }
+#endif
+} // namespace ncore
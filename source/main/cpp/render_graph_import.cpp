@@ -0,0 +1,65 @@
+#include "crendergraph/render_graph_import.h"
+#include "crendergraph/render_graph.h"
+
+namespace ncore
+{
+    u32 RenderGraphImportRegistry::Register(IGfxResource* resource, ngfx::GfxAccessFlags state, bool texture)
+    {
+        ASSERT(resource != nullptr);
+
+        Entry entry    = {};
+        entry.resource = resource;
+        entry.state    = state;
+        entry.frame    = UINT64_MAX;
+        entry.nextFree = InvalidId;
+        entry.texture  = texture;
+
+        if (m_firstFree != InvalidId)
+        {
+            const u32 id  = m_firstFree;
+            m_firstFree   = m_entries[id].nextFree;
+            m_entries[id] = entry;
+            return id;
+        }
+
+        m_entries.push_back(entry);
+        return (u32)m_entries.size() - 1;
+    }
+
+    void RenderGraphImportRegistry::Unregister(u32 id)
+    {
+        ASSERT(IsRegistered(id));
+
+        Entry& entry   = m_entries[id];
+        entry.resource = nullptr;
+        entry.frame    = UINT64_MAX;
+        entry.nextFree = m_firstFree;
+        m_firstFree    = id;
+    }
+
+    void RenderGraphImportRegistry::UpdateStates(const RenderGraphFrame& frame)
+    {
+        for (size_t i = 0; i < frame.imports.size(); ++i)
+        {
+            Entry& entry = m_entries[frame.imports[i]];
+            if (entry.frame != frame.id)
+            {
+                continue; // unregistered since
+            }
+
+            RenderGraphResource* resource = frame.resources[entry.handle.index];
+            if (resource->IsUsed())
+            {
+                entry.state = resource->GetFinalState();
+            }
+
+            for (size_t j = 0; j < frame.outputResources.size(); ++j)
+            {
+                if (frame.outputResources[j].resource == resource)
+                {
+                    entry.state = frame.outputResources[j].state;
+                }
+            }
+        }
+    }
+} // namespace ncore
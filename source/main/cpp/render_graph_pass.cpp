@@ -12,8 +12,10 @@ namespace ncore
     }
 
     // todo : https://docs.microsoft.com/en-us/windows/win32/direct3d12/executing-and-synchronizing-command-lists#accessing-resources-from-multiple-command-queues
-    void RenderGraphPassBase::ResolveBarriers(const DirectedAcyclicGraph& graph)
+    void RenderGraphPassBase::ResolveBarriers(const DirectedAcyclicGraph& graph, bool analyze)
     {
+        m_barrierRecords.clear();
+
         vector_t<DAGEdge*> edges;
 
         vector_t<DAGEdge*> resource_incoming;
@@ -28,16 +30,41 @@ namespace ncore
             RenderGraphResourceNode* resource_node = (RenderGraphResourceNode*)graph.GetNode(edge->GetFromNode());
             RenderGraphResource*     resource      = resource_node->GetResource();
 
+            const PrecompiledState* precompiled = FindPrecompiledState(resource, edge->GetSubresource());
+            if (precompiled != nullptr && !graph.GetNode(precompiled->prev_pass)->IsCulled())
+            {
+                if (precompiled->old_state != edge->GetState() || precompiled->uav_barrier)
+                {
+                    ResourceBarrier barrier;
+                    barrier.resource     = resource;
+                    barrier.sub_resource = edge->GetSubresource();
+                    barrier.old_state    = precompiled->old_state;
+                    barrier.new_state    = edge->GetState();
+                    barrier.old_stages   = precompiled->old_stages;
+                    barrier.new_stages   = edge->GetStages();
+                    m_resourceBarriers.push_back(barrier);
+
+                    if (analyze)
+                    {
+                        AddBarrierRecord(precompiled->prev_pass, resource, nullptr, barrier.sub_resource, barrier.old_state, barrier.new_state, barrier.old_stages, barrier.new_stages);
+                    }
+                }
+                continue;
+            }
+
             graph.GetIncomingEdges(resource_node, resource_incoming);
             graph.GetOutgoingEdges(resource_node, resource_outgoing);
             ASSERT(resource_incoming.size() <= 1);
             ASSERT(resource_outgoing.size() >= 1);
 
-            ngfx::GfxAccess::Flags old_state = ngfx::GfxAccess::Present;
-            ngfx::GfxAccess::Flags new_state = edge->GetUsage();
+            ngfx::GfxAccess::Flags old_state  = ngfx::GfxAccess::Present;
+            ngfx::GfxAccess::Flags new_state  = edge->GetState();
+            RGShaderStage          old_stages = RGShaderStage::None;
+            DAGNode*               prev_pass  = nullptr;
+            RenderGraphEdge*       prev_edge  = nullptr;
 
-            // try to find previous state from last pass which used this resource
-            if (resource_outgoing.size() > 1) // todo : should merge states if possible, eg. shader resource ps + shader resource non-ps -> shader resource all
+            // try to find previous state from last pass which used this resource, reads next to each other already share a merged state
+            if (resource_outgoing.size() > 1)
             {
                 // resource_outgoing should be sorted
                 for (int i = (int)resource_outgoing.size() - 1; i >= 0; --i)
@@ -46,7 +73,10 @@ namespace ncore
                     DAGNode* pass_id     = resource_outgoing[i]->GetToNode();
                     if (subresource == edge->GetSubresource() && pass_id < this->GetId() && !graph.GetNode(pass_id)->IsCulled())
                     {
-                        old_state = ((RenderGraphEdge*)resource_outgoing[i])->GetUsage();
+                        old_state  = ((RenderGraphEdge*)resource_outgoing[i])->GetState();
+                        old_stages = ((RenderGraphEdge*)resource_outgoing[i])->GetStages();
+                        prev_pass  = pass_id;
+                        prev_edge = (RenderGraphEdge*)resource_outgoing[i];
                         break;
                     }
                 }
@@ -58,11 +88,15 @@ namespace ncore
                 if (resource_incoming.empty())
                 {
                     ASSERT(resource_node->GetVersion() == 0);
-                    old_state = resource->GetInitialState();
+                    old_state  = resource->GetInitialState();
+                    old_stages = RGGetStages(old_state);
                 }
                 else
                 {
-                    old_state = ((RenderGraphEdge*)resource_incoming[0])->GetUsage();
+                    old_state  = ((RenderGraphEdge*)resource_incoming[0])->GetState();
+                    old_stages = ((RenderGraphEdge*)resource_incoming[0])->GetStages();
+                    prev_pass  = resource_incoming[0]->GetFromNode();
+                    prev_edge = (RenderGraphEdge*)resource_incoming[0];
                 }
             }
 
@@ -74,27 +108,47 @@ namespace ncore
                 IGfxResource* aliased_resource = resource->GetAliasedPrevResource(alias_state);
                 if (aliased_resource)
                 {
-                    m_discardBarriers.push_back({aliased_resource, alias_state, new_state | GfxAccessDiscard});
+                    m_discardBarriers.push_back({aliased_resource, alias_state, new_state | GfxAccessDiscard, RGGetStages(alias_state), edge->GetStages()});
+
+                    if (analyze)
+                    {
+                        AddBarrierRecord(nullptr, resource, aliased_resource, GFX_ALL_SUB_RESOURCE, alias_state, new_state | GfxAccessDiscard, RGGetStages(alias_state), edge->GetStages());
+                    }
 
                     is_aliased = true;
                 }
             }
 
-            if (old_state != new_state || is_aliased)
+            // the same UAV state on both sides of a barrier is a UAV barrier, the previous writer is a dependency of this pass.
+            // It is only left out when both passes declared that their writes don't overlap.
+            bool uav_barrier = false;
+            if (old_state == new_state && (new_state & GfxAccessMaskUAV) && prev_edge != nullptr)
+            {
+                uav_barrier = !(prev_edge->IsNonOverlappingWrite() && edge->IsNonOverlappingWrite());
+            }
+
+            if (old_state != new_state || is_aliased || uav_barrier)
             {
-                // TODO : uav barrier
                 ResourceBarrier barrier;
                 barrier.resource     = resource;
                 barrier.sub_resource = edge->GetSubresource();
                 barrier.old_state    = old_state;
                 barrier.new_state    = new_state;
+                barrier.old_stages   = old_stages;
+                barrier.new_stages   = edge->GetStages();
 
                 if (is_aliased)
                 {
                     barrier.old_state |= alias_state | GfxAccessDiscard;
+                    barrier.old_stages = barrier.old_stages | RGGetStages(alias_state);
                 }
 
                 m_resourceBarriers.push_back(barrier);
+
+                if (analyze)
+                {
+                    AddBarrierRecord(prev_pass, resource, nullptr, barrier.sub_resource, barrier.old_state, barrier.new_state, barrier.old_stages, barrier.new_stages);
+                }
             }
         }
 
@@ -122,6 +176,37 @@ namespace ncore
         }
     }
 
+    const RenderGraphPassBase::PrecompiledState* RenderGraphPassBase::FindPrecompiledState(RenderGraphResource* resource, u32 subresource) const
+    {
+        for (size_t i = 0; i < m_precompiledStates.size(); ++i)
+        {
+            if (m_precompiledStates[i].resource == resource && m_precompiledStates[i].sub_resource == subresource)
+            {
+                return &m_precompiledStates[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void RenderGraphPassBase::AddBarrierRecord(DAGNode* prev_pass, RenderGraphResource* resource, IGfxResource* aliased, u32 subresource, ngfx::GfxAccess::Flags old_state, ngfx::GfxAccess::Flags new_state, RGShaderStage old_stages,
+                                               RGShaderStage new_stages)
+    {
+        RGBarrierRecord record;
+        record.pass        = GetId();
+        record.prev_pass   = prev_pass;
+        record.resource    = resource;
+        record.aliased     = aliased;
+        record.subresource = subresource;
+        record.old_state   = old_state;
+        record.new_state   = new_state;
+        record.old_stages  = old_stages;
+        record.new_stages  = new_stages;
+        record.source      = RenderGraphBarrierStats::GetSource(new_state);
+        record.type        = RGBarrierClass::Required;
+        record.discard     = aliased != nullptr;
+        m_barrierRecords.push_back(record);
+    }
+
     void RenderGraphPassBase::ResolveAsyncCompute(const DirectedAcyclicGraph& graph, RenderGraphAsyncResolveContext& context)
     {
         if (m_type == RenderPassType::AsyncCompute)
@@ -224,17 +309,70 @@ namespace ncore
         }
     }
 
+    // all passes between two sync points of a queue go into one submit. Adjacent sync points share a submit, e.g. a signal
+    // followed by a wait, since waits and signals are applied with the next Submit of the command list.
+    void RenderGraphPassBase::PlanSubmit(RenderGraphSubmitPlanContext& context)
+    {
+        u32 queue = m_type == RenderPassType::AsyncCompute ? 1 : 0;
+
+        m_bSubmitBeforeWait = m_waitValue != -1 && context.dirty[queue];
+        if (m_bSubmitBeforeWait)
+        {
+            context.constantsPending[queue] = true;
+        }
+
+        // global constants are only set up again when the new command list actually records a pass
+        m_bSetupGlobalConstants         = context.constantsPending[queue];
+        context.constantsPending[queue] = false;
+        context.dirty[queue]            = true;
+
+        if (m_signalValue != -1)
+        {
+            context.dirty[queue]            = false;
+            context.constantsPending[queue] = true;
+        }
+    }
+
+    void RenderGraphPassBase::SaveCompiled(const DirectedAcyclicGraph& graph, RGCompiledPass& record) const
+    {
+        record.signalValue          = m_signalValue;
+        record.waitValue            = m_waitValue;
+        record.waitGraphicsPass     = m_waitGraphicsPass != nullptr ? ((const RenderGraphPassBase*)graph.GetNode(m_waitGraphicsPass))->GetIndex() : RGCompiledPass::InvalidIndex;
+        record.signalGraphicsPass   = m_signalGraphicsPass != nullptr ? ((const RenderGraphPassBase*)graph.GetNode(m_signalGraphicsPass))->GetIndex() : RGCompiledPass::InvalidIndex;
+        record.culled               = IsCulled() ? 1 : 0;
+        record.submitBeforeWait     = m_bSubmitBeforeWait ? 1 : 0;
+        record.setupGlobalConstants = m_bSetupGlobalConstants ? 1 : 0;
+        record.asyncPromoted        = m_bAsyncPromoted ? 1 : 0;
+    }
+
+    void RenderGraphPassBase::LoadCompiled(const RGCompiledPass& record, RenderGraphPassBase* const* passes)
+    {
+        m_signalValue           = record.signalValue;
+        m_waitValue             = record.waitValue;
+        m_waitGraphicsPass      = record.waitGraphicsPass != RGCompiledPass::InvalidIndex ? passes[record.waitGraphicsPass]->GetId() : nullptr;
+        m_signalGraphicsPass    = record.signalGraphicsPass != RGCompiledPass::InvalidIndex ? passes[record.signalGraphicsPass]->GetId() : nullptr;
+        m_bSubmitBeforeWait     = record.submitBeforeWait != 0;
+        m_bSetupGlobalConstants = record.setupGlobalConstants != 0;
+
+        if (record.asyncPromoted != 0)
+        {
+            PromoteToAsyncCompute();
+        }
+    }
+
     void RenderGraphPassBase::Execute(const RenderGraph& graph, RenderGraphPassExecuteContext& context)
     {
+        ASSERT(!IsCulled()); // culled passes are not in the live pass list
         IGfxCommandList* pCommandList = m_type == RenderPassType::AsyncCompute ? context.computeCommandList : context.graphicsCommandList;
 
         if (m_waitValue != -1)
         {
-            pCommandList->End();
-            pCommandList->Submit();
-
-            pCommandList->Begin();
-            context.renderer->SetupGlobalConstants(pCommandList);
+            if (m_bSubmitBeforeWait)
+            {
+                pCommandList->End();
+                pCommandList->Submit();
+                pCommandList->Begin();
+            }
 
             if (m_type == RenderPassType::AsyncCompute)
             {
@@ -246,26 +384,58 @@ namespace ncore
             }
         }
 
-        for (size_t i = 0; i < m_eventNames.size(); ++i)
+#if RENDER_GRAPH_EVENTS
+        const u32* events = graph.GetEventStream() + m_firstEvent;
+        for (u32 i = 0; i < m_nBeginEvents; ++i)
         {
-            context.graphicsCommandList->BeginEvent(m_eventNames[i]);
-            BeginMPGpuEvent(context.graphicsCommandList, m_eventNames[i]);
+            const char* name = RenderGraphEventTable::GetName(events[i]);
+            context.graphicsCommandList->BeginEvent(name);
+            BeginMPGpuEvent(context.graphicsCommandList, name);
+        }
+#endif
+
+        if (m_bSetupGlobalConstants)
+        {
+            context.renderer->SetupGlobalConstants(pCommandList);
         }
 
-        if (!IsCulled())
         {
             GPU_EVENT(pCommandList, m_name);
 
-            Begin(graph, pCommandList);
-            ExecuteImpl(pCommandList);
-            End(pCommandList);
+#if RENDER_GRAPH_PASS_TIMINGS
+            if (RenderGraphPassTimings::IsEnabled())
+            {
+                const u64 begin = RenderGraphPassTimings::Now();
+                Begin(graph, pCommandList);
+                const u64 record = RenderGraphPassTimings::Now();
+                ExecuteImpl(pCommandList);
+                const u64 end = RenderGraphPassTimings::Now();
+                End(pCommandList);
+                const u64 done = RenderGraphPassTimings::Now();
+
+                if (m_timingSlot == RenderGraphPassTimings::InvalidSlot)
+                {
+                    m_timingSlot = RenderGraphPassTimings::Register(m_name);
+                }
+                RenderGraphPassTimings::AddSample(m_timingSlot, RGPassTimer::Record, end - record);
+                RenderGraphPassTimings::AddSample(m_timingSlot, RGPassTimer::Setup, (record - begin) + (done - end));
+            }
+            else
+#endif
+            {
+                Begin(graph, pCommandList);
+                ExecuteImpl(pCommandList);
+                End(pCommandList);
+            }
         }
 
-        for (u32 i = 0; i < m_nEndEventNum; ++i)
+#if RENDER_GRAPH_EVENTS
+        for (u32 i = 0; i < m_nEndEvents; ++i)
         {
             context.graphicsCommandList->EndEvent();
             EndMPGpuEvent(context.graphicsCommandList);
         }
+#endif
 
         if (m_signalValue != -1)
         {
@@ -283,7 +453,6 @@ namespace ncore
             pCommandList->Submit();
 
             pCommandList->Begin();
-            context.renderer->SetupGlobalConstants(pCommandList);
         }
     }
 
@@ -295,18 +464,18 @@ namespace ncore
 
             if (barrier.resource->IsTexture())
             {
-                pCommandList->TextureBarrier((IGfxTexture*)barrier.resource, GFX_ALL_SUB_RESOURCE, barrier.acess_before, barrier.acess_after);
+                pCommandList->TextureBarrier((IGfxTexture*)barrier.resource, GFX_ALL_SUB_RESOURCE, barrier.acess_before, barrier.acess_after, RGGetStageMask(barrier.stages_before), RGGetStageMask(barrier.stages_after));
             }
             else
             {
-                pCommandList->BufferBarrier((IGfxBuffer*)barrier.resource, barrier.acess_before, barrier.acess_after);
+                pCommandList->BufferBarrier((IGfxBuffer*)barrier.resource, barrier.acess_before, barrier.acess_after, RGGetStageMask(barrier.stages_before), RGGetStageMask(barrier.stages_after));
             }
         }
 
         for (size_t i = 0; i < m_resourceBarriers.size(); ++i)
         {
             const ResourceBarrier& barrier = m_resourceBarriers[i];
-            barrier.resource->Barrier(pCommandList, barrier.sub_resource, barrier.old_state, barrier.new_state);
+            barrier.resource->Barrier(pCommandList, barrier.sub_resource, barrier.old_state, barrier.new_state, barrier.old_stages, barrier.new_stages);
         }
 
         if (HasGfxRenderPass())
@@ -366,6 +535,11 @@ namespace ncore
 
     bool RenderGraphPassBase::HasGfxRenderPass() const
     {
+        if (m_bFolded)
+        {
+            return false; // merged into the render pass of the next pass
+        }
+
         for (int i = 0; i < 8; i++)
         {
             if (m_pColorRT[i] != nullptr)
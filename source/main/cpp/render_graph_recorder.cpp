@@ -0,0 +1,163 @@
+#include "crendergraph/render_graph_recorder.h"
+#include "crendergraph/render_graph.h"
+
+namespace ncore
+{
+    RenderGraphRecorder::RenderGraphRecorder() { m_allocator = new RenderGraphArena(ArenaSize); }
+
+    RenderGraphRecorder::~RenderGraphRecorder()
+    {
+        Reset();
+        delete m_allocator;
+    }
+
+    void RenderGraphRecorder::Reset()
+    {
+        for (size_t i = 0; i < m_objFinalizer.size(); ++i)
+        {
+            m_objFinalizer[i].finalizer(m_objFinalizer[i].obj);
+        }
+        m_objFinalizer.clear();
+
+        m_allocator->Reset();
+
+        m_resources.clear();
+        m_nodes.clear();
+        m_ops.clear();
+        m_passes.clear();
+
+        m_bMerged = false;
+    }
+
+    RGHandle RenderGraphRecorder::AddResource(const RGTexture::Desc& desc, cpstr_t name)
+    {
+        ASSERT(!m_bMerged);
+
+        RGHandle handle = AddNode();
+
+        Resource resource     = {};
+        resource.node         = handle.node;
+        resource.texture      = true;
+        resource.texture_desc = desc;
+        resource.name         = name;
+        m_resources.push_back(resource);
+
+        return handle;
+    }
+
+    RGHandle RenderGraphRecorder::AddResource(const RGBuffer::Desc& desc, cpstr_t name)
+    {
+        ASSERT(!m_bMerged);
+
+        RGHandle handle = AddNode();
+
+        Resource resource    = {};
+        resource.node        = handle.node;
+        resource.texture     = false;
+        resource.buffer_desc = desc;
+        resource.name        = name;
+        m_resources.push_back(resource);
+
+        return handle;
+    }
+
+    // only the node of a local handle is used, it is replaced by a render graph handle when the recorder is merged
+    RGHandle RenderGraphRecorder::AddNode()
+    {
+        RGHandle handle;
+        handle.index = (u16)m_nodes.size();
+        handle.node  = (u16)m_nodes.size();
+        handle.scope = m_scope;
+
+        m_nodes.push_back(RGHandle());
+
+        return handle;
+    }
+
+    RGHandle RenderGraphRecorder::PushOp(u32 pass, const Op& op, bool write)
+    {
+        ASSERT(!m_bMerged);
+        ASSERT(op.input.IsValid());
+
+        Op       record    = op;
+        RGHandle output    = op.input;
+        record.output_node = InvalidIndex;
+
+        if (write)
+        {
+            output             = AddNode();
+            record.output_node = output.node;
+        }
+
+        m_ops.push_back(record);
+        m_passes[pass].num_ops++;
+
+        return output;
+    }
+
+    RGHandle RenderGraphRecorder::Read(u32 pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, RGShaderStage stages)
+    {
+        Op op          = {};
+        op.type        = OpType::Read;
+        op.input       = input;
+        op.usage       = usage;
+        op.stages      = stages != RGShaderStage::None ? stages : RGGetStages(usage);
+        op.subresource = subresource;
+        return PushOp(pass, op, false);
+    }
+
+    RGHandle RenderGraphRecorder::Write(u32 pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, bool non_overlapping, RGShaderStage stages, bool full_coverage)
+    {
+        Op op              = {};
+        op.type            = OpType::Write;
+        op.input           = input;
+        op.usage           = usage;
+        op.stages          = stages != RGShaderStage::None ? stages : RGGetStages(usage);
+        op.subresource     = subresource;
+        op.non_overlapping = non_overlapping;
+        op.full_coverage   = full_coverage;
+        return PushOp(pass, op, true);
+    }
+
+    RGHandle RenderGraphRecorder::WriteColor(u32 pass, u32 color_index, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, const float4& clear_color, bool full_coverage)
+    {
+        Op op             = {};
+        op.type           = OpType::WriteColor;
+        op.input          = input;
+        op.usage          = ngfx::GfxAccess::RTV;
+        op.subresource    = subresource;
+        op.color_index    = color_index;
+        op.load_op        = load_op;
+        op.clear_color[0] = clear_color[0];
+        op.clear_color[1] = clear_color[1];
+        op.clear_color[2] = clear_color[2];
+        op.clear_color[3] = clear_color[3];
+        op.full_coverage  = full_coverage;
+        return PushOp(pass, op, true);
+    }
+
+    RGHandle RenderGraphRecorder::WriteDepth(u32 pass, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth, u32 clear_stencil, bool full_coverage)
+    {
+        Op op              = {};
+        op.type            = OpType::WriteDepth;
+        op.input           = input;
+        op.usage           = ngfx::GfxAccess::DSV;
+        op.subresource     = subresource;
+        op.load_op         = depth_load_op;
+        op.stencil_load_op = stencil_load_op;
+        op.clear_depth     = clear_depth;
+        op.clear_stencil   = clear_stencil;
+        op.full_coverage   = full_coverage;
+        return PushOp(pass, op, true);
+    }
+
+    RGHandle RenderGraphRecorder::ReadDepth(u32 pass, const RGHandle& input, u32 subresource)
+    {
+        Op op          = {};
+        op.type        = OpType::ReadDepth;
+        op.input       = input;
+        op.usage       = ngfx::GfxAccess::DSVReadOnly;
+        op.subresource = subresource;
+        return PushOp(pass, op, true);
+    }
+} // namespace ncore
@@ -1,13 +1,21 @@
 #include "crendergraph/render_graph_resource.h"
 #include "crendergraph/render_graph.h"
+#include "crendergraph/render_graph_cache.h"
 
 namespace ncore
 {
+    // imported resources only contribute their kind, the imported object differs between runs
+    u64 RenderGraphResource::HashDesc(u64 hash) const
+    {
+        const u8 kind = (m_bImported ? 1 : 0) | (m_bHistory ? 2 : 0) | (m_bReadback ? 4 : 0) | (m_bOutput ? 8 : 0);
+        return RGHashValue(kind, hash);
+    }
+
     void RenderGraphResource::Resolve(RenderGraphEdge* edge, RenderGraphPassBase* pass)
     {
         if (pass->GetId() >= m_lastPass)
         {
-            m_lastState = edge->GetUsage();
+            m_lastState = edge->GetState();
         }
 
         m_firstPass = math::min(m_firstPass, pass->GetId());
@@ -38,13 +46,28 @@ namespace ncore
         m_bImported    = true;
     }
 
+    RGTexture::RGTexture(RenderGraphResourceAllocator& allocator, cpstr_t name, const Desc& desc, u32 history_length, u32 frames_ago)
+        : RenderGraphResource(name)
+        , m_allocator(allocator)
+    {
+        m_desc             = desc;
+        m_historyLength    = history_length;
+        m_historyFramesAgo = frames_ago;
+        m_bHistory         = true;
+    }
+
     RGTexture::~RGTexture()
     {
-        if (!m_bImported)
+        if (m_bHistory)
+        {
+            // the state we leave the texture in becomes the initial state of the next frame that uses this slot
+            m_allocator.FreeHistoryTexture(m_pTexture, IsUsed() ? m_lastState : m_initialState);
+        }
+        else if (!m_bImported)
         {
             if (m_bOutput)
             {
-                m_allocator.FreeNonOverlappingTexture(m_pTexture, m_lastState);
+                m_allocator.FreeNonOverlappingTexture(m_pTexture, m_lastState, m_descriptorSet);
             }
             else
             {
@@ -60,6 +83,10 @@ namespace ncore
         GfxShaderResourceViewDesc desc;
         desc.format = m_pTexture->GetDesc().format;
 
+        if (m_descriptorSet != RenderGraphResourceAllocator::InvalidDescriptorSet)
+        {
+            return m_allocator.GetBindlessSRV(m_descriptorSet, m_pTexture, desc);
+        }
         return m_allocator.GetDescriptor(m_pTexture, desc);
     }
 
@@ -70,6 +97,10 @@ namespace ncore
         GfxUnorderedAccessViewDesc desc;
         desc.format = m_pTexture->GetDesc().format;
 
+        if (m_descriptorSet != RenderGraphResourceAllocator::InvalidDescriptorSet)
+        {
+            return m_allocator.GetBindlessUAV(m_descriptorSet, m_pTexture, desc);
+        }
         return m_allocator.GetDescriptor(m_pTexture, desc);
     }
 
@@ -104,24 +135,71 @@ namespace ncore
         }
     }
 
+    void RGTexture::PrepareRealize()
+    {
+        if (m_bImported)
+        {
+            return;
+        }
+
+        // realize with every usage this resource had in recent frames, so culling a pass doesn't change the desc
+        m_desc.usage |= m_allocator.GetStableUsage(m_name, true);
+
+        // the size query can be slow on some devices, so it is done before the serial placement
+        if (!m_bHistory && !m_bOutput)
+        {
+            m_allocationSize = m_allocator.GetAllocationSize(m_desc);
+        }
+    }
+
     void RGTexture::Realize()
     {
         if (!m_bImported)
+        {
+            m_allocator.UpdateStableUsage(m_name, true, m_desc.usage);
+        }
+
+        if (m_bHistory)
+        {
+            m_pTexture = m_allocator.AllocateHistoryTexture(m_desc, m_name, m_historyLength, m_historyFramesAgo, m_initialState, m_bHistoryValid, m_descriptorSet);
+        }
+        else if (!m_bImported)
         {
             if (m_bOutput)
             {
-                m_pTexture = m_allocator.AllocateNonOverlappingTexture(m_desc, m_name, m_initialState);
+                m_pTexture = m_allocator.AllocateNonOverlappingTexture(m_desc, m_name, m_initialState, m_descriptorSet);
             }
             else
             {
-                m_pTexture = m_allocator.AllocateTexture(m_firstPass, m_lastPass, m_lastState, m_desc, m_name, m_initialState);
+                m_pTexture = m_allocator.AllocateTexture(m_firstPass, m_lastPass, m_lastState, m_desc, m_allocationSize, m_name, m_initialState, m_descriptorSet);
             }
         }
     }
 
-    void RGTexture::Barrier(IGfxCommandList* pCommandList, u32 subresource, GfxAccessFlags acess_before, GfxAccessFlags acess_after) { pCommandList->TextureBarrier(m_pTexture, subresource, acess_before, acess_after); }
+    void RGTexture::Barrier(IGfxCommandList* pCommandList, u32 subresource, GfxAccessFlags acess_before, GfxAccessFlags acess_after, RGShaderStage stages_before, RGShaderStage stages_after)
+    {
+        pCommandList->TextureBarrier(m_pTexture, subresource, acess_before, acess_after, RGGetStageMask(stages_before), RGGetStageMask(stages_after));
+    }
 
-    IGfxResource* RGTexture::GetAliasedPrevResource(GfxAccessFlags& lastUsedState) { return m_allocator.GetAliasedPrevResource(m_pTexture, m_firstPass, lastUsedState); }
+    void RGTexture::ResolveAliasing() { m_pAliasedPrev = m_allocator.GetAliasedPrevResource(m_pTexture, m_firstPass, m_aliasedPrevState); }
+
+    // field by field, the padding of the desc is never hashed. An imported resource may live in a heap of its own,
+    // the heap and its offset are not part of the structure.
+    // the usage is left out, Compile adds to it and the accesses are hashed with the edges
+    u64 RGTexture::HashDesc(u64 hash) const
+    {
+        hash = RenderGraphResource::HashDesc(hash);
+        hash = RGHashValue(m_desc.width, hash);
+        hash = RGHashValue(m_desc.height, hash);
+        hash = RGHashValue(m_desc.depth, hash);
+        hash = RGHashValue(m_desc.mip_levels, hash);
+        hash = RGHashValue(m_desc.array_size, hash);
+        hash = RGHashValue(m_desc.type, hash);
+        hash = RGHashValue(m_desc.format, hash);
+        hash = RGHashValue(m_desc.memory_type, hash);
+        hash = RGHashValue(m_desc.alloc_type, hash);
+        return hash;
+    }
 
     RGBuffer::RGBuffer(RenderGraphResourceAllocator& allocator, const nstring::str_t const* name, const Desc& desc)
         : RenderGraphResource(name)
@@ -140,9 +218,22 @@ namespace ncore
         m_bImported    = true;
     }
 
+    RGBuffer::RGBuffer(RenderGraphResourceAllocator& allocator, cpstr_t name, IGfxBuffer* staging, u32 offset, u32 size, GfxAccessFlags state)
+        : RenderGraphResource(name)
+        , m_allocator(allocator)
+    {
+        m_desc         = staging->GetDesc();
+        m_desc.size    = size;
+        m_pBuffer      = staging;
+        m_offset       = offset;
+        m_initialState = state;
+        m_bImported    = true; // the staging ring owns the memory
+        m_bReadback    = staging->GetDesc().memory_type == GfxMemoryType::GpuToCpu;
+    }
+
     RGBuffer::~RGBuffer()
     {
-        if (!m_bImported)
+        if (!m_bImported && !m_bSubAllocated)
         {
             m_allocator.Free(m_pBuffer, m_lastState, m_bOutput);
         }
@@ -152,7 +243,8 @@ namespace ncore
     {
         RE_ASSERT(!IsImported());
 
-        const GfxBufferDesc& bufferDesc = m_pBuffer->GetDesc();
+        // a sub-allocated buffer shares its IGfxBuffer with others, our own desc describes the view
+        const GfxBufferDesc& bufferDesc = m_desc;
 
         GfxShaderResourceViewDesc desc;
         desc.format = bufferDesc.format;
@@ -170,9 +262,13 @@ namespace ncore
             desc.type = GfxShaderResourceViewType::RawBuffer;
         }
 
-        desc.buffer.offset = 0;
+        desc.buffer.offset = m_offset;
         desc.buffer.size   = bufferDesc.size;
 
+        if (m_descriptorSet != RenderGraphResourceAllocator::InvalidDescriptorSet)
+        {
+            return m_allocator.GetBindlessSRV(m_descriptorSet, m_pBuffer, desc);
+        }
         return m_allocator.GetDescriptor(m_pBuffer, desc);
     }
 
@@ -180,7 +276,7 @@ namespace ncore
     {
         RE_ASSERT(!IsImported());
 
-        const GfxBufferDesc& bufferDesc = m_pBuffer->GetDesc();
+        const GfxBufferDesc& bufferDesc = m_desc;
         RE_ASSERT(bufferDesc.usage & GfxBufferUsageUnorderedAccess);
 
         GfxUnorderedAccessViewDesc desc;
@@ -199,9 +295,13 @@ namespace ncore
             desc.type = GfxUnorderedAccessViewType::RawBuffer;
         }
 
-        desc.buffer.offset = 0;
+        desc.buffer.offset = m_offset;
         desc.buffer.size   = bufferDesc.size;
 
+        if (m_descriptorSet != RenderGraphResourceAllocator::InvalidDescriptorSet)
+        {
+            return m_allocator.GetBindlessUAV(m_descriptorSet, m_pBuffer, desc);
+        }
         return m_allocator.GetDescriptor(m_pBuffer, desc);
     }
 
@@ -215,15 +315,51 @@ namespace ncore
         }
     }
 
+    void RGBuffer::PrepareRealize()
+    {
+        if (!m_bImported)
+        {
+            m_desc.usage |= m_allocator.GetStableUsage(m_name, false);
+        }
+    }
+
     void RGBuffer::Realize()
     {
         if (!m_bImported)
         {
-            m_pBuffer = m_allocator.AllocateBuffer(m_firstPass, m_lastPass, m_lastState, m_desc, m_name, m_initialState);
+            m_allocator.UpdateStableUsage(m_name, false, m_desc.usage);
+
+            m_pBuffer = m_allocator.AllocateSubBuffer(m_desc, m_offset, m_descriptorSet);
+
+            if (m_pBuffer != nullptr)
+            {
+                m_bSubAllocated = true;
+                m_initialState  = GfxAccessDiscard;
+            }
+            else
+            {
+                m_pBuffer = m_allocator.AllocateBuffer(m_firstPass, m_lastPass, m_lastState, m_desc, m_name, m_initialState, m_descriptorSet);
+            }
         }
     }
 
-    void RGBuffer::Barrier(IGfxCommandList* pCommandList, u32 subresource, GfxAccessFlags acess_before, GfxAccessFlags acess_after) { pCommandList->BufferBarrier(m_pBuffer, acess_before, acess_after); }
+    // for a sub-allocated buffer this synchronizes the whole ring buffer, buffers have no layout so that is only a wider sync scope
+    void RGBuffer::Barrier(IGfxCommandList* pCommandList, u32 subresource, GfxAccessFlags acess_before, GfxAccessFlags acess_after, RGShaderStage stages_before, RGShaderStage stages_after)
+    {
+        pCommandList->BufferBarrier(m_pBuffer, acess_before, acess_after, RGGetStageMask(stages_before), RGGetStageMask(stages_after));
+    }
 
-    IGfxResource* RGBuffer::GetAliasedPrevResource(GfxAccessFlags& lastUsedState) { return m_allocator.GetAliasedPrevResource(m_pBuffer, m_firstPass, lastUsedState); }
+    void RGBuffer::ResolveAliasing() { m_pAliasedPrev = m_allocator.GetAliasedPrevResource(m_pBuffer, m_firstPass, m_aliasedPrevState); }
+
+    // like RGTexture::HashDesc, without the usage
+    u64 RGBuffer::HashDesc(u64 hash) const
+    {
+        hash = RenderGraphResource::HashDesc(hash);
+        hash = RGHashValue(m_desc.stride, hash);
+        hash = RGHashValue(m_desc.size, hash);
+        hash = RGHashValue(m_desc.format, hash);
+        hash = RGHashValue(m_desc.memory_type, hash);
+        hash = RGHashValue(m_desc.alloc_type, hash);
+        return hash;
+    }
 } // namespace ncore
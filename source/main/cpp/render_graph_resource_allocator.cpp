@@ -13,6 +13,7 @@ namespace ncore
             for (size_t i = 0; i < heap.resources.size(); ++i)
             {
                 DeleteDescriptor(heap.resources[i].resource);
+                ReleaseDescriptorSet(heap.resources[i].descriptorSet);
                 delete heap.resources[i].resource;
             }
 
@@ -21,13 +22,35 @@ namespace ncore
 
         for (auto iter = m_freeOverlappingTextures.begin(); iter != m_freeOverlappingTextures.end(); ++iter)
         {
+            IGfxHeap* heap = iter->texture->GetDesc().heap;
+
             DeleteDescriptor(iter->texture);
+            ReleaseDescriptorSet(iter->descriptorSet);
             delete iter->texture;
+            delete heap;
+        }
+
+        for (auto iter = m_historyTextures.begin(); iter != m_historyTextures.end(); ++iter)
+        {
+            DeleteHistoryTexture(*iter);
+        }
+
+        for (u32 r = 0; r < GFX_MAX_INFLIGHT_FRAMES; ++r)
+        {
+            for (size_t i = 0; i < m_ringDescriptorSets[r].size(); ++i)
+            {
+                ReleaseDescriptorSet(m_ringDescriptorSets[r][i]);
+            }
         }
+        delete m_pRingBuffer;
+
+        ReleaseRetired(true);
     }
 
     void RenderGraphResourceAllocator::Reset()
     {
+        RenderGraphScopedLock lock(m_lock);
+
         for (auto iter = m_allocatedHeaps.begin(); iter != m_allocatedHeaps.end();)
         {
             Heap& heap = *iter;
@@ -50,8 +73,12 @@ namespace ncore
         {
             if (current_frame - iter->lastUsedFrame > 30)
             {
+                IGfxHeap* heap = iter->texture->GetDesc().heap;
+
                 DeleteDescriptor(iter->texture);
+                ReleaseDescriptorSet(iter->descriptorSet);
                 delete iter->texture;
+                delete heap;
                 iter = m_freeOverlappingTextures.erase(iter);
             }
             else
@@ -59,6 +86,233 @@ namespace ncore
                 ++iter;
             }
         }
+
+        for (auto iter = m_historyTextures.begin(); iter != m_historyTextures.end();)
+        {
+            if (current_frame - iter->lastUsedFrame > 30)
+            {
+                DeleteHistoryTexture(*iter);
+                iter = m_historyTextures.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+
+        ReleaseRetired(false);
+
+        // the usage table counts recorded frames, see UpdateStableUsage
+        for (auto iter = m_stableUsages.begin(); iter != m_stableUsages.end();)
+        {
+            if (m_lifetimeFrame - iter->lastUsedFrame > 30)
+            {
+                iter = m_stableUsages.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+
+    u64 RenderGraphResourceAllocator::GetResourceSize(IGfxResource* resource) const
+    {
+        if (resource->IsTexture())
+        {
+            return m_pDevice->GetAllocationSize(((IGfxTexture*)resource)->GetDesc());
+        }
+        return ((IGfxBuffer*)resource)->GetDesc().size;
+    }
+
+    float RenderGraphResourceAllocator::GetFragmentation(u64 last_frame) const
+    {
+        u64 heap_size = 0;
+
+        vector_t<u32> first_pass;
+        vector_t<u32> last_pass;
+        vector_t<u64> size;
+        for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+        {
+            const Heap& heap = m_allocatedHeaps[i];
+            heap_size += heap.heap->GetDesc().size;
+
+            for (size_t j = 0; j < heap.resources.size(); ++j)
+            {
+                const AliasedResource& placed = heap.resources[j];
+                if (placed.lastUsedFrame == last_frame)
+                {
+                    first_pass.push_back(placed.lastLifetime.firstPass);
+                    last_pass.push_back(placed.lastLifetime.lastPass);
+                    size.push_back(GetResourceSize(placed.resource));
+                }
+            }
+        }
+
+        const u64 peak_size = GetPeakLiveSize(first_pass.data(), last_pass.data(), size.data(), (u32)size.size());
+        return heap_size > 0 ? 1.0f - (float)peak_size / (float)heap_size : 0.0f;
+    }
+
+    // the live bytes only change at the start of a lifetime, so those are the points to sample
+    u64 RenderGraphResourceAllocator::GetPeakLiveSize(const u32* first_pass, const u32* last_pass, const u64* size, u32 count)
+    {
+        u64 peak_size = 0;
+        for (u32 i = 0; i < count; ++i)
+        {
+            u64 live_size = 0;
+            for (u32 j = 0; j < count; ++j)
+            {
+                if (first_pass[j] <= first_pass[i] && last_pass[j] >= first_pass[i])
+                {
+                    live_size += size[j];
+                }
+            }
+            peak_size = math::max(peak_size, live_size);
+        }
+        return peak_size;
+    }
+
+    RenderGraphResourceAllocator::CompactionStats RenderGraphResourceAllocator::Compact()
+    {
+        RenderGraphScopedLock lock(m_lock);
+
+        // lifetimes of different frames can not be compared, placements that were idle in the last frame fit anywhere
+        u64 last_frame = 0;
+        for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+        {
+            for (size_t j = 0; j < m_allocatedHeaps[i].resources.size(); ++j)
+            {
+                last_frame = math::max(last_frame, m_allocatedHeaps[i].resources[j].lastUsedFrame);
+            }
+        }
+
+        CompactionStats stats;
+        stats.heapsBefore         = (u32)m_allocatedHeaps.size();
+        stats.memoryBefore        = 0;
+        stats.fragmentationBefore = GetFragmentation(last_frame);
+        for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+        {
+            stats.memoryBefore += m_allocatedHeaps[i].heap->GetDesc().size;
+        }
+
+        // merge the smallest heaps first, into the largest heap that can take all of their placements
+        eastl::sort(m_allocatedHeaps.begin(), m_allocatedHeaps.end(), [](const Heap& a, const Heap& b) { return a.heap->GetDesc().size > b.heap->GetDesc().size; });
+
+        for (s32 src = (s32)m_allocatedHeaps.size() - 1; src >= 0; --src)
+        {
+            Heap& source = m_allocatedHeaps[src];
+
+            // a frame that is recorded but not executed yet still references its placements, those can't move
+            bool in_use      = false;
+            u64  source_size = 0;
+            for (size_t j = 0; j < source.resources.size(); ++j)
+            {
+                in_use      = in_use || source.resources[j].lifetime.IsUsed();
+                source_size = math::max(source_size, GetResourceSize(source.resources[j].resource));
+            }
+            if (in_use)
+            {
+                continue;
+            }
+
+            s32 dst_index = -1;
+            for (s32 dst = 0; dst < (s32)m_allocatedHeaps.size(); ++dst)
+            {
+                const Heap& target = m_allocatedHeaps[dst];
+                if (dst == src || target.memoryType != source.memoryType || target.heap->GetDesc().size < source_size)
+                {
+                    continue;
+                }
+                if (dst_index >= 0 && m_allocatedHeaps[dst_index].heap->GetDesc().size >= target.heap->GetDesc().size)
+                {
+                    continue;
+                }
+
+                bool overlapping = false;
+                for (size_t j = 0; j < source.resources.size() && !overlapping; ++j)
+                {
+                    const AliasedResource& moved = source.resources[j];
+                    for (size_t k = 0; k < target.resources.size() && !overlapping; ++k)
+                    {
+                        const AliasedResource& resident = target.resources[k];
+                        overlapping = moved.lastUsedFrame == last_frame && resident.lastUsedFrame == last_frame && moved.lastLifetime.IsOverlapping(resident.lastLifetime);
+                    }
+                }
+
+                if (!overlapping)
+                {
+                    dst_index = dst;
+                }
+            }
+
+            if (dst_index < 0)
+            {
+                continue;
+            }
+
+            Heap& target = m_allocatedHeaps[dst_index];
+            for (size_t j = 0; j < source.resources.size(); ++j)
+            {
+                // transient contents die every frame, so moving is recreating the placed resource, the descriptor slot is kept
+                AliasedResource moved = source.resources[j];
+                DeleteDescriptor(moved.resource);
+                ResetDescriptorSet(moved.descriptorSet);
+
+                if (moved.resource->IsTexture())
+                {
+                    ngfx::GfxTextureDesc desc = ((IGfxTexture*)moved.resource)->GetDesc();
+                    desc.heap                 = target.heap;
+                    moved.lastUsedState       = ngfx::GfxAccess::Discard;
+
+                    IGfxResource* resource = m_pDevice->CreateTexture(desc, moved.resource->GetName());
+                    Retire(nullptr, moved.resource);
+                    moved.resource = resource;
+                }
+                else
+                {
+                    ngfx::GfxBufferDesc desc = ((IGfxBuffer*)moved.resource)->GetDesc();
+                    desc.heap                = target.heap;
+                    moved.lastUsedState      = ngfx::GfxAccess::Discard;
+
+                    IGfxResource* resource = m_pDevice->CreateBuffer(desc, moved.resource->GetName());
+                    Retire(nullptr, moved.resource);
+                    moved.resource = resource;
+                }
+
+                ASSERT(moved.resource != nullptr);
+                target.resources.push_back(moved);
+            }
+
+            Retire(source.heap, nullptr);
+            m_allocatedHeaps.erase(m_allocatedHeaps.begin() + src);
+        }
+
+        stats.heapsAfter         = (u32)m_allocatedHeaps.size();
+        stats.memoryAfter        = 0;
+        stats.fragmentationAfter = GetFragmentation(last_frame);
+        for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+        {
+            stats.memoryAfter += m_allocatedHeaps[i].heap->GetDesc().size;
+        }
+
+        return stats;
+    }
+
+    u64 RenderGraphResourceAllocator::GetAllocatedMemorySize() const
+    {
+        u64 size = m_historyMemorySize;
+
+        for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+        {
+            size += m_allocatedHeaps[i].heap->GetDesc().size;
+        }
+
+        for (size_t i = 0; i < m_freeOverlappingTextures.size(); ++i)
+        {
+            size += m_freeOverlappingTextures[i].texture->GetDesc().heap->GetDesc().size;
+        }
+
+        return size;
     }
 
     void RenderGraphResourceAllocator::CheckHeapUsage(Heap& heap)
@@ -72,6 +326,7 @@ namespace ncore
             if (current_frame - aliasedResource.lastUsedFrame > 30)
             {
                 DeleteDescriptor(aliasedResource.resource);
+                ReleaseDescriptorSet(aliasedResource.descriptorSet);
 
                 delete aliasedResource.resource;
                 iter = heap.resources.erase(iter);
@@ -83,39 +338,266 @@ namespace ncore
         }
     }
 
-    IGfxTexture* RenderGraphResourceAllocator::AllocateTexture(u32 firstPass, u32 lastPass, ngfx::GfxAccess::Flags lastState, const ngfx::GfxTextureDesc& desc, cpstr_t name, ngfx::GfxAccess::Flags& initial_state)
+    u32 RenderGraphResourceAllocator::GetHeapLayout(HeapLayout* layout, u32 max_count) const
+    {
+        const u32 count = (u32)m_allocatedHeaps.size();
+        for (u32 i = 0; i < count && i < max_count; ++i)
+        {
+            layout[i].size       = m_allocatedHeaps[i].heap->GetDesc().size;
+            layout[i].memoryType = (u32)m_allocatedHeaps[i].memoryType;
+            layout[i].heap       = m_allocatedHeaps[i].id;
+        }
+        return count;
+    }
+
+    void RenderGraphResourceAllocator::ReserveHeaps(const HeapLayout* layout, u32 count)
+    {
+        RenderGraphScopedLock lock(m_lock);
+
+        vector_t<u8> claimed;
+        for (u32 i = 0; i < count; ++i)
+        {
+            ClaimHeap(layout[i], claimed);
+        }
+    }
+
+    // an unclaimed heap that fits the layout, a new heap when there is none. 'claimed' grows along with the pool.
+    u32 RenderGraphResourceAllocator::ClaimHeap(const HeapLayout& layout, vector_t<u8>& claimed)
+    {
+        const ngfx::GfxMemoryType memory_type = (ngfx::GfxMemoryType)layout.memoryType;
+
+        while (claimed.size() < m_allocatedHeaps.size())
+        {
+            claimed.push_back(0);
+        }
+
+        for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+        {
+            const Heap& heap = m_allocatedHeaps[i];
+            if (!claimed[i] && heap.memoryType == memory_type && heap.heap->GetDesc().size >= layout.size)
+            {
+                claimed[i] = 1;
+                return (u32)i;
+            }
+        }
+
+        AllocateHeap((u32)layout.size, memory_type);
+        claimed.push_back(1);
+        return (u32)m_allocatedHeaps.size() - 1;
+    }
+
+    void RenderGraphResourceAllocator::CaptureProfile(AllocationProfile& profile) const
     {
-        LifetimeRange lifetime     = {firstPass, lastPass};
-        u32           texture_size = m_pDevice->GetAllocationSize(desc);
+        RenderGraphScopedLock lock(m_lock);
 
         for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
         {
+            const Heap& heap = m_allocatedHeaps[i];
+
+            HeapLayout layout;
+            layout.size       = heap.heap->GetDesc().size;
+            layout.memoryType = (u32)heap.memoryType;
+            layout.heap       = heap.id;
+
+            const u32 index = AddProfileHeap(profile, layout);
+
+            for (size_t j = 0; j < heap.resources.size(); ++j)
+            {
+                const IGfxResource* resource = heap.resources[j].resource;
+
+                PlacedResourceProfile placed = {};
+                placed.heap                  = index;
+                placed.texture               = resource->IsTexture() ? 1 : 0;
+                if (placed.texture)
+                {
+                    placed.textureDesc      = ((const IGfxTexture*)resource)->GetDesc();
+                    placed.textureDesc.heap = nullptr;
+                }
+                else
+                {
+                    placed.bufferDesc      = ((const IGfxBuffer*)resource)->GetDesc();
+                    placed.bufferDesc.heap = nullptr;
+                }
+
+                AddProfileResource(profile, placed);
+            }
+        }
+    }
+
+    u32 RenderGraphResourceAllocator::AddProfileHeap(AllocationProfile& profile, const HeapLayout& layout)
+    {
+        u32 index = 0;
+        while (index < (u32)profile.heaps.size() && profile.heaps[index].heap != layout.heap)
+        {
+            index++;
+        }
+        if (index == (u32)profile.heaps.size())
+        {
+            HeapLayout entry = layout;
+            entry.size       = 0;
+            profile.heaps.push_back(entry);
+        }
+
+        HeapLayout& entry = profile.heaps[index];
+        entry.size        = math::max(entry.size, layout.size);
+        return index;
+    }
+
+    void RenderGraphResourceAllocator::AddProfileResource(AllocationProfile& profile, const PlacedResourceProfile& placed)
+    {
+        for (size_t k = 0; k < profile.resources.size(); ++k)
+        {
+            const PlacedResourceProfile& other = profile.resources[k];
+            if (other.heap == placed.heap && other.texture == placed.texture && (placed.texture ? other.textureDesc == placed.textureDesc : other.bufferDesc == placed.bufferDesc))
+            {
+                return;
+            }
+        }
+
+        profile.resources.push_back(placed);
+    }
+
+    void RenderGraphResourceAllocator::Prewarm(const AllocationProfile& profile)
+    {
+        RenderGraphScopedLock lock(m_lock);
+
+        const u64 current_frame = m_pDevice->GetFrameID();
+
+        vector_t<u8>  claimed;
+        vector_t<u32> heaps;
+        for (size_t i = 0; i < profile.heaps.size(); ++i)
+        {
+            heaps.push_back(ClaimHeap(profile.heaps[i], claimed));
+        }
+
+        for (size_t i = 0; i < profile.resources.size(); ++i)
+        {
+            const PlacedResourceProfile& placed = profile.resources[i];
+            Heap&                        heap   = m_allocatedHeaps[heaps[placed.heap]];
+
+            bool exists = false;
+            for (size_t j = 0; j < heap.resources.size() && !exists; ++j)
+            {
+                const IGfxResource* resource = heap.resources[j].resource;
+                if (placed.texture)
+                {
+                    exists = resource->IsTexture() && ((const IGfxTexture*)resource)->GetDesc() == placed.textureDesc;
+                }
+                else
+                {
+                    exists = resource->IsBuffer() && ((const IGfxBuffer*)resource)->GetDesc() == placed.bufferDesc;
+                }
+            }
+            if (exists)
+            {
+                continue;
+            }
+
+            AliasedResource* aliasedResource = AddAliasedResource(heap);
+            aliasedResource->lastUsedFrame   = current_frame;
+
+            if (placed.texture)
+            {
+                ngfx::GfxTextureDesc desc = placed.textureDesc;
+                desc.heap                 = heap.heap;
+
+                IGfxTexture* texture      = m_pDevice->CreateTexture(desc, "RGTexture prewarm");
+                aliasedResource->resource = texture;
+
+                // the same state a texture gets when AllocateTexture creates it
+                if (IsDepthFormat(desc.format))
+                {
+                    aliasedResource->lastUsedState = ngfx::GfxAccess::DSV;
+                }
+                else if (desc.usage & ngfx::GfxTextureUsage::RenderTarget)
+                {
+                    aliasedResource->lastUsedState = ngfx::GfxAccess::RTV;
+                }
+                else if (desc.usage & ngfx::GfxTextureUsage::UnorderedAccess)
+                {
+                    aliasedResource->lastUsedState = ngfx::GfxAccess::MaskUAV;
+                }
+
+                // the default views, as RGTexture::GetSRV and GetUAV ask for them
+                DescriptorSet& set = m_descriptorSets[aliasedResource->descriptorSet];
+
+                ngfx::GfxShaderResourceViewDesc srv_desc;
+                srv_desc.format = desc.format;
+                set.srv         = m_pDevice->CreateShaderResourceView(texture, srv_desc, texture->GetName());
+
+                if (desc.usage & ngfx::GfxTextureUsage::UnorderedAccess)
+                {
+                    ngfx::GfxUnorderedAccessViewDesc uav_desc;
+                    uav_desc.format = desc.format;
+                    set.uav         = m_pDevice->CreateUnorderedAccessView(texture, uav_desc, texture->GetName());
+                }
+            }
+            else
+            {
+                ngfx::GfxBufferDesc desc = placed.bufferDesc;
+                desc.heap                = heap.heap;
+
+                aliasedResource->resource      = m_pDevice->CreateBuffer(desc, "RGBuffer prewarm");
+                aliasedResource->lastUsedState = ngfx::GfxAccess::Discard;
+            }
+
+            ASSERT(aliasedResource->resource != nullptr);
+        }
+    }
+
+    u32 RenderGraphResourceAllocator::GetAllocationSize(const ngfx::GfxTextureDesc& desc) const { return m_pDevice->GetAllocationSize(desc); }
+
+    IGfxTexture* RenderGraphResourceAllocator::AllocateTexture(u32 firstPass, u32 lastPass, ngfx::GfxAccess::Flags lastState, const ngfx::GfxTextureDesc& desc, u32 texture_size, cpstr_t name, ngfx::GfxAccess::Flags& initial_state, u32& descriptor_set)
+    {
+        RenderGraphScopedLock lock(m_lock);
+
+        LifetimeRange lifetime = {firstPass, lastPass, m_lifetimeFrame};
+
+        // when no heap fits, a new one is added and picked up as the last iteration
+        for (size_t i = 0; i <= m_allocatedHeaps.size(); ++i)
+        {
+            if (i == m_allocatedHeaps.size())
+            {
+                AllocateHeap(texture_size, ngfx::GfxMemoryType::GpuOnly);
+            }
+
             Heap& heap = m_allocatedHeaps[i];
-            if (heap.heap->GetDesc().size < texture_size || heap.IsOverlapping(lifetime))
+            if (heap.memoryType != ngfx::GfxMemoryType::GpuOnly || heap.heap->GetDesc().size < texture_size || heap.IsOverlapping(lifetime))
             {
                 continue;
             }
 
+            AliasedResource* recycle = nullptr;
+
             for (size_t j = 0; j < heap.resources.size(); ++j)
             {
                 AliasedResource& aliasedResource = heap.resources[j];
-                if (aliasedResource.resource->IsTexture() && !aliasedResource.lifetime.IsUsed() && ((IGfxTexture*)aliasedResource.resource)->GetDesc() == desc)
+                if (aliasedResource.lifetime.IsUsed())
+                {
+                    continue;
+                }
+
+                if (aliasedResource.resource->IsTexture() && ((IGfxTexture*)aliasedResource.resource)->GetDesc() == desc)
                 {
                     aliasedResource.lifetime      = lifetime;
                     initial_state                 = aliasedResource.lastUsedState;
                     aliasedResource.lastUsedState = lastState;
+                    descriptor_set                = aliasedResource.descriptorSet;
                     return (IGfxTexture*)aliasedResource.resource;
                 }
+
+                recycle = SelectRecyclable(recycle, aliasedResource);
             }
 
             ngfx::GfxTextureDesc newDesc = desc;
             newDesc.heap                 = heap.heap;
 
-            AliasedResource aliasedTexture;
-            aliasedTexture.resource      = m_pDevice->CreateTexture(newDesc, "RGTexture " + name);
-            aliasedTexture.lifetime      = lifetime;
-            aliasedTexture.lastUsedState = lastState;
-            heap.resources.push_back(aliasedTexture);
+            AliasedResource* aliasedTexture = recycle != nullptr ? Recycle(*recycle) : AddAliasedResource(heap);
+            aliasedTexture->resource        = m_pDevice->CreateTexture(newDesc, "RGTexture " + name);
+            aliasedTexture->lifetime        = lifetime;
+            aliasedTexture->lastUsedState   = lastState;
+
+            descriptor_set = aliasedTexture->descriptorSet;
 
             if (IsDepthFormat(desc.format))
             {
@@ -130,72 +612,154 @@ namespace ncore
                 initial_state = ngfx::GfxAccess::MaskUAV;
             }
 
-            ASSERT(aliasedTexture.resource != nullptr);
-            return (IGfxTexture*)aliasedTexture.resource;
+            ASSERT(aliasedTexture->resource != nullptr);
+            return (IGfxTexture*)aliasedTexture->resource;
         }
 
-        AllocateHeap(texture_size);
-        return AllocateTexture(firstPass, lastPass, lastState, desc, name, initial_state);
+        ASSERT(false);
+        return nullptr;
     }
 
-    IGfxBuffer* RenderGraphResourceAllocator::AllocateBuffer(u32 firstPass, u32 lastPass, ngfx::GfxAccess::Flags lastState, const ngfx::GfxBufferDesc& desc, const nstring::str_t const* name, ngfx::GfxAccess::Flags& initial_state)
+    IGfxBuffer* RenderGraphResourceAllocator::AllocateBuffer(u32 firstPass, u32 lastPass, ngfx::GfxAccess::Flags lastState, const ngfx::GfxBufferDesc& desc, const nstring::str_t const* name, ngfx::GfxAccess::Flags& initial_state, u32& descriptor_set)
     {
-        LifetimeRange lifetime    = {firstPass, lastPass};
+        RenderGraphScopedLock lock(m_lock);
+
+        LifetimeRange lifetime    = {firstPass, lastPass, m_lifetimeFrame};
         u32           buffer_size = desc.size;
 
-        for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+        for (size_t i = 0; i <= m_allocatedHeaps.size(); ++i)
         {
+            if (i == m_allocatedHeaps.size())
+            {
+                AllocateHeap(buffer_size, desc.memory_type);
+            }
+
             Heap& heap = m_allocatedHeaps[i];
-            if (heap.heap->GetDesc().size < buffer_size || heap.IsOverlapping(lifetime))
+            if (heap.memoryType != desc.memory_type || heap.heap->GetDesc().size < buffer_size || heap.IsOverlapping(lifetime))
             {
                 continue;
             }
 
+            AliasedResource* recycle = nullptr;
+
             for (size_t j = 0; j < heap.resources.size(); ++j)
             {
                 AliasedResource& aliasedResource = heap.resources[j];
-                if (aliasedResource.resource->IsBuffer() && !aliasedResource.lifetime.IsUsed() && ((IGfxBuffer*)aliasedResource.resource)->GetDesc() == desc)
+                if (aliasedResource.lifetime.IsUsed())
+                {
+                    continue;
+                }
+
+                if (aliasedResource.resource->IsBuffer() && ((IGfxBuffer*)aliasedResource.resource)->GetDesc() == desc)
                 {
                     aliasedResource.lifetime      = lifetime;
                     initial_state                 = aliasedResource.lastUsedState;
                     aliasedResource.lastUsedState = lastState;
+                    descriptor_set                = aliasedResource.descriptorSet;
                     return (IGfxBuffer*)aliasedResource.resource;
                 }
+
+                recycle = SelectRecyclable(recycle, aliasedResource);
             }
 
             ngfx::GfxBufferDesc newDesc = desc;
-            newDesc.heap          = heap.heap;
+            newDesc.heap                = heap.heap;
+
+            AliasedResource* aliasedBuffer = recycle != nullptr ? Recycle(*recycle) : AddAliasedResource(heap);
+            aliasedBuffer->resource        = m_pDevice->CreateBuffer(newDesc, "RGBuffer " + name);
+            aliasedBuffer->lifetime        = lifetime;
+            aliasedBuffer->lastUsedState   = lastState;
 
-            AliasedResource aliasedBuffer;
-            aliasedBuffer.resource      = m_pDevice->CreateBuffer(newDesc, "RGBuffer " + name);
-            aliasedBuffer.lifetime      = lifetime;
-            aliasedBuffer.lastUsedState = lastState;
-            heap.resources.push_back(aliasedBuffer);
+            initial_state  = ngfx::GfxAccess::Discard;
+            descriptor_set = aliasedBuffer->descriptorSet;
+
+            ASSERT(aliasedBuffer->resource != nullptr);
+            return (IGfxBuffer*)aliasedBuffer->resource;
+        }
 
-            initial_state = ngfx::GfxAccess::Discard;
+        ASSERT(false);
+        return nullptr;
+    }
 
-            ASSERT(aliasedBuffer.resource != nullptr);
-            return (IGfxBuffer*)aliasedBuffer.resource;
+    // a placed resource that was idle for several frames is likely stale (eg. a dynamic resolution step), the oldest
+    // one is replaced so resources that alternate between frames keep their placed resource. A frame still in flight
+    // may reference it, so it has to be idle for longer than that.
+    RenderGraphResourceAllocator::AliasedResource* RenderGraphResourceAllocator::SelectRecyclable(AliasedResource* current, AliasedResource& candidate) const
+    {
+        if (!CanRecycle(candidate.lastUsedFrame, m_pDevice->GetFrameID()))
+        {
+            return current;
+        }
+        if (current == nullptr || candidate.lastUsedFrame < current->lastUsedFrame)
+        {
+            return &candidate;
         }
+        return current;
+    }
+
+    // the heap memory already fits, only the placed resource object over it is recreated
+    RenderGraphResourceAllocator::AliasedResource* RenderGraphResourceAllocator::Recycle(AliasedResource& aliasedResource)
+    {
+        DeleteDescriptor(aliasedResource.resource);
+        ResetDescriptorSet(aliasedResource.descriptorSet);
+        delete aliasedResource.resource;
 
-        AllocateHeap(buffer_size);
-        return AllocateBuffer(firstPass, lastPass, lastState, desc, name, initial_state);
+        aliasedResource.resource = nullptr;
+        return &aliasedResource;
     }
 
-    void RenderGraphResourceAllocator::AllocateHeap(u32 size)
+    RenderGraphResourceAllocator::AliasedResource* RenderGraphResourceAllocator::AddAliasedResource(Heap& heap)
+    {
+        AliasedResource aliasedResource;
+        aliasedResource.descriptorSet = AllocateDescriptorSet();
+        heap.resources.push_back(aliasedResource);
+
+        return &heap.resources.back();
+    }
+
+    void RenderGraphResourceAllocator::AllocateHeap(u32 size, ngfx::GfxMemoryType memory_type)
     {
         ngfx::GfxHeapDesc heapDesc;
-        heapDesc.size = RoundUpPow2(size, 64u * 1024);
+        heapDesc.size        = RoundUpPow2(size, 64u * 1024);
+        heapDesc.memory_type = memory_type;
 
         eastl::string heapName = fmt::format("RG Heap {:.1f} MB", heapDesc.size / (1024.0f * 1024.0f)).c_str();
 
         Heap heap;
-        heap.heap = m_pDevice->CreateHeap(heapDesc, heapName);
+        heap.heap       = m_pDevice->CreateHeap(heapDesc, heapName);
+        heap.memoryType = memory_type;
+        heap.id         = m_nextHeapId++;
         m_allocatedHeaps.push_back(heap);
     }
 
+    void RenderGraphResourceAllocator::Retire(IGfxHeap* heap, IGfxResource* resource) { m_retiredObjects.push_back({heap, resource, nullptr, m_pDevice->GetFrameID()}); }
+    void RenderGraphResourceAllocator::Retire(IGfxDescriptor* descriptor) { m_retiredObjects.push_back({nullptr, nullptr, descriptor, m_pDevice->GetFrameID()}); }
+
+    // the placed resources go before their heap, they were retired first
+    void RenderGraphResourceAllocator::ReleaseRetired(bool all)
+    {
+        if (m_retiredObjects.empty())
+        {
+            return;
+        }
+
+        u64 current_frame = m_pDevice->GetFrameID();
+
+        size_t count = 0;
+        while (count < m_retiredObjects.size() && (all || current_frame - m_retiredObjects[count].frame >= RetireFrames))
+        {
+            delete m_retiredObjects[count].descriptor;
+            delete m_retiredObjects[count].resource;
+            delete m_retiredObjects[count].heap;
+            count++;
+        }
+        m_retiredObjects.erase(m_retiredObjects.begin(), m_retiredObjects.begin() + count);
+    }
+
     void RenderGraphResourceAllocator::Free(IGfxResource* resource, ngfx::GfxAccess::Flags state, bool set_state)
     {
+        RenderGraphScopedLock lock(m_lock);
+
         if (resource != nullptr)
         {
             for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
@@ -207,6 +771,7 @@ namespace ncore
                     AliasedResource& aliasedResource = heap.resources[j];
                     if (aliasedResource.resource == resource)
                     {
+                        aliasedResource.lastLifetime = aliasedResource.lifetime;
                         aliasedResource.lifetime.Reset();
                         aliasedResource.lastUsedFrame = m_pDevice->GetFrameID();
                         if (set_state)
@@ -223,8 +788,77 @@ namespace ncore
         }
     }
 
+    IGfxBuffer* RenderGraphResourceAllocator::AllocateSubBuffer(const ngfx::GfxBufferDesc& desc, u32& offset, u32& descriptor_set)
+    {
+        if (desc.size > m_subAllocationThreshold || desc.memory_type != ngfx::GfxMemoryType::GpuOnly)
+        {
+            return nullptr;
+        }
+
+        RenderGraphScopedLock lock(m_lock);
+
+        if (m_pRingBuffer == nullptr)
+        {
+            ngfx::GfxBufferDesc ringDesc;
+            ringDesc.size  = m_ringBufferSize * GFX_MAX_INFLIGHT_FRAMES;
+            ringDesc.usage = ngfx::GfxBufferUsage::StructuredBuffer | ngfx::GfxBufferUsage::TypedBuffer | ngfx::GfxBufferUsage::RawBuffer | ngfx::GfxBufferUsage::UnorderedAccess;
+
+            m_pRingBuffer = m_pDevice->CreateBuffer(ringDesc, "RG Ring Buffer");
+            ASSERT(m_pRingBuffer != nullptr);
+        }
+
+        // the region belongs to the recorded frame, the device may already be a frame ahead while it is compiled
+        const u64 current_frame = m_lifetimeFrame;
+        if (m_ringFrame != current_frame)
+        {
+            m_ringFrame  = current_frame;
+            m_ringOffset = 0;
+            m_ringCursor = 0;
+        }
+
+        // structured buffer views are addressed in elements, everything else is aligned for constant buffer use. The region
+        // size needn't be a multiple of the stride, so the offset into the whole buffer is what gets aligned.
+        const bool structured = (desc.usage & ngfx::GfxBufferUsage::StructuredBuffer) != 0;
+        ASSERT(!structured || desc.stride != 0);
+
+        const u32 alignment = structured ? desc.stride : 256;
+        const u32 region    = (u32)(current_frame % GFX_MAX_INFLIGHT_FRAMES) * m_ringBufferSize;
+
+        if (!SubAllocateRegion(region, m_ringBufferSize, m_ringOffset, (u32)desc.size, alignment, offset))
+        {
+            return nullptr;
+        }
+
+        // the frame that used the region before was executed, its views are replaced through the retire list
+        vector_t<u32>& sets = m_ringDescriptorSets[current_frame % GFX_MAX_INFLIGHT_FRAMES];
+        if (m_ringCursor == sets.size())
+        {
+            sets.push_back(AllocateDescriptorSet());
+        }
+        descriptor_set = sets[m_ringCursor++];
+
+        return m_pRingBuffer;
+    }
+
+    bool RenderGraphResourceAllocator::SubAllocateRegion(u32 region, u32 region_size, u32& region_offset, u32 size, u32 alignment, u32& offset)
+    {
+        const u32 aligned = ((region + region_offset + alignment - 1) / alignment) * alignment;
+        if (aligned + size > region + region_size)
+        {
+            return false;
+        }
+
+        region_offset = aligned + size - region;
+        offset        = aligned;
+        return true;
+    }
+
+    // called once per resource after all resources of the frame are realized, it marks the previous user as discarded,
+    // so the calls are serial and in resource order to get the same result every frame
     IGfxResource* RenderGraphResourceAllocator::GetAliasedPrevResource(IGfxResource* resource, u32 firstPass, ngfx::GfxAccess::Flags& lastUsedState)
     {
+        RenderGraphScopedLock lock(m_lock);
+
         for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
         {
             Heap& heap = m_allocatedHeaps[i];
@@ -235,19 +869,29 @@ namespace ncore
 
             AliasedResource* aliased_resource       = nullptr;
             IGfxResource*    prev_resource          = nullptr;
+            u64              prev_resource_frame    = 0;
             u32              prev_resource_lastpass = 0;
 
+            // the previous user is the latest lifetime ending before this one, earlier frames come first
             for (size_t j = 0; j < heap.resources.size(); ++j)
             {
-                AliasedResource& aliasedResource = heap.resources[j];
+                AliasedResource&     aliasedResource = heap.resources[j];
+                const LifetimeRange& lifetime        = aliasedResource.lifetime;
+                if (aliasedResource.resource == resource || !lifetime.IsUsed())
+                {
+                    continue;
+                }
 
-                if (aliasedResource.resource != resource && aliasedResource.lifetime.lastPass < firstPass && aliasedResource.lifetime.lastPass > prev_resource_lastpass)
+                const bool before = lifetime.frame < m_lifetimeFrame || (lifetime.frame == m_lifetimeFrame && lifetime.lastPass < firstPass);
+                const bool later  = aliased_resource == nullptr || lifetime.frame > prev_resource_frame || (lifetime.frame == prev_resource_frame && lifetime.lastPass > prev_resource_lastpass);
+                if (before && later)
                 {
                     aliased_resource = &aliasedResource;
                     prev_resource    = aliasedResource.resource;
                     lastUsedState    = aliasedResource.lastUsedState;
 
-                    prev_resource_lastpass = aliasedResource.lifetime.lastPass;
+                    prev_resource_frame    = lifetime.frame;
+                    prev_resource_lastpass = lifetime.lastPass;
                 }
             }
 
@@ -263,18 +907,86 @@ namespace ncore
         return nullptr;
     }
 
-    IGfxTexture* RenderGraphResourceAllocator::AllocateNonOverlappingTexture(const ngfx::GfxTextureDesc& desc, cpstr_t name, ngfx::GfxAccess::Flags& initial_state)
+    u32 RenderGraphResourceAllocator::GetStableUsage(cpstr_t name, bool texture) const
+    {
+        for (size_t i = 0; i < m_stableUsages.size(); ++i)
+        {
+            if (m_stableUsages[i].name == name && m_stableUsages[i].texture == texture)
+            {
+                return m_stableUsages[i].usage;
+            }
+        }
+        return 0;
+    }
+
+    void RenderGraphResourceAllocator::UpdateStableUsage(cpstr_t name, bool texture, u32 usage)
+    {
+        RenderGraphScopedLock lock(m_lock);
+
+        // realization runs for the frame being compiled, so the entries are stamped with the recorded frame
+        for (size_t i = 0; i < m_stableUsages.size(); ++i)
+        {
+            StableUsage& stable = m_stableUsages[i];
+            if (stable.name == name && stable.texture == texture)
+            {
+                stable.usage        |= usage;
+                stable.lastUsedFrame = m_lifetimeFrame;
+                return;
+            }
+        }
+
+        m_stableUsages.push_back({name, texture, usage, m_lifetimeFrame});
+    }
+
+    IGfxTexture* RenderGraphResourceAllocator::AllocateNonOverlappingTexture(const ngfx::GfxTextureDesc& desc, cpstr_t name, ngfx::GfxAccess::Flags& initial_state, u32& descriptor_set)
     {
+        RenderGraphScopedLock lock(m_lock);
+
         for (auto iter = m_freeOverlappingTextures.begin(); iter != m_freeOverlappingTextures.end(); ++iter)
         {
             IGfxTexture* texture = iter->texture;
             if (texture->GetDesc() == desc)
             {
-                initial_state = iter->lastUsedState;
+                initial_state  = iter->lastUsedState;
+                descriptor_set = iter->descriptorSet;
                 m_freeOverlappingTextures.erase(iter);
                 return texture;
             }
         }
+
+        // every non-overlapping texture has a heap of its own, the smallest free one that is big enough is reused
+        u32  texture_size = m_pDevice->GetAllocationSize(desc);
+        auto best         = m_freeOverlappingTextures.end();
+        for (auto iter = m_freeOverlappingTextures.begin(); iter != m_freeOverlappingTextures.end(); ++iter)
+        {
+            u64 heap_size = iter->texture->GetDesc().heap->GetDesc().size;
+            if (heap_size >= texture_size && (best == m_freeOverlappingTextures.end() || heap_size < best->texture->GetDesc().heap->GetDesc().size))
+            {
+                best = iter;
+            }
+        }
+
+        IGfxHeap* heap;
+        if (best != m_freeOverlappingTextures.end())
+        {
+            heap           = best->texture->GetDesc().heap;
+            descriptor_set = best->descriptorSet;
+
+            DeleteDescriptor(best->texture);
+            ResetDescriptorSet(best->descriptorSet);
+            delete best->texture;
+            m_freeOverlappingTextures.erase(best);
+        }
+        else
+        {
+            ngfx::GfxHeapDesc heapDesc;
+            heapDesc.size        = RoundUpPow2(texture_size, 64u * 1024);
+            heapDesc.memory_type = ngfx::GfxMemoryType::GpuOnly;
+
+            heap           = m_pDevice->CreateHeap(heapDesc, "RG Non-overlapping Heap");
+            descriptor_set = AllocateDescriptorSet();
+        }
+
         if (IsDepthFormat(desc.format))
         {
             initial_state = ngfx::GfxAccess::DSV;
@@ -288,19 +1000,153 @@ namespace ncore
             initial_state = ngfx::GfxAccess::MaskUAV;
         }
 
-        return m_pDevice->CreateTexture(desc, "RGTexture " + name);
+        ngfx::GfxTextureDesc newDesc = desc;
+        newDesc.heap                 = heap;
+
+        return m_pDevice->CreateTexture(newDesc, "RGTexture " + name);
     }
 
-    void RenderGraphResourceAllocator::FreeNonOverlappingTexture(IGfxTexture* texture, ngfx::GfxAccess::Flags state)
+    void RenderGraphResourceAllocator::FreeNonOverlappingTexture(IGfxTexture* texture, ngfx::GfxAccess::Flags state, u32 descriptor_set)
     {
         if (texture != nullptr)
         {
-            m_freeOverlappingTextures.push_back({texture, state, m_pDevice->GetFrameID()});
+            RenderGraphScopedLock lock(m_lock);
+            m_freeOverlappingTextures.push_back({texture, state, m_pDevice->GetFrameID(), descriptor_set});
+        }
+    }
+
+    IGfxTexture* RenderGraphResourceAllocator::AllocateHistoryTexture(const ngfx::GfxTextureDesc& desc, cpstr_t name, u32 history_length, u32 frames_ago, ngfx::GfxAccess::Flags& initial_state, bool& valid, u32& descriptor_set)
+    {
+        ASSERT(history_length > 0 && history_length <= MaxHistoryLength);
+        ASSERT(frames_ago < history_length);
+
+        RenderGraphScopedLock lock(m_lock);
+
+        HistoryTexture* history = nullptr;
+        for (size_t i = 0; i < m_historyTextures.size(); ++i)
+        {
+            if (m_historyTextures[i].name == name)
+            {
+                history = &m_historyTextures[i];
+                break;
+            }
+        }
+
+        if (history != nullptr && (history->length != history_length || !(history->desc == desc)))
+        {
+            // eg. a resolution change, the old content can not be used anymore
+            DeleteHistoryTexture(*history);
+            history->desc   = desc;
+            history->length = history_length;
+        }
+        else if (history == nullptr)
+        {
+            HistoryTexture newHistory = {};
+            newHistory.name           = name;
+            newHistory.desc           = desc;
+            newHistory.length         = history_length;
+            m_historyTextures.push_back(newHistory);
+
+            history = &m_historyTextures.back();
+        }
+
+        // the slots advance with the recorded frame, so each recorded frame writes its own slot whatever the device frame is
+        u64 current_frame      = m_lifetimeFrame;
+        u32 slot               = GetHistorySlot(current_frame, history_length, frames_ago);
+        history->lastUsedFrame = m_pDevice->GetFrameID(); // the release in Reset counts device frames
+
+        if (history->textures[slot] == nullptr)
+        {
+            history->textures[slot]       = m_pDevice->CreateTexture(desc, "RGHistory " + name);
+            history->descriptorSets[slot] = AllocateDescriptorSet();
+            history->writtenFrames[slot]  = UINT64_MAX;
+            m_historyMemorySize += m_pDevice->GetAllocationSize(desc);
+
+            if (IsDepthFormat(desc.format))
+            {
+                history->states[slot] = ngfx::GfxAccess::DSV;
+            }
+            else if (desc.usage & ngfx::GfxTextureUsage::RenderTarget)
+            {
+                history->states[slot] = ngfx::GfxAccess::RTV;
+            }
+            else if (desc.usage & ngfx::GfxTextureUsage::UnorderedAccess)
+            {
+                history->states[slot] = ngfx::GfxAccess::MaskUAV;
+            }
+            else
+            {
+                history->states[slot] = ngfx::GfxAccess::Discard;
+            }
+        }
+
+        if (frames_ago == 0)
+        {
+            history->writtenFrames[slot] = current_frame;
+            valid                        = true;
+        }
+        else
+        {
+            valid = IsHistorySlotValid(history->writtenFrames[slot], current_frame, frames_ago);
+        }
+
+        // the final state of the previous user is the initial state, so no barrier is needed when it is used the same way
+        initial_state  = history->states[slot];
+        descriptor_set = history->descriptorSets[slot];
+
+        ASSERT(history->textures[slot] != nullptr);
+        return history->textures[slot];
+    }
+
+    u32 RenderGraphResourceAllocator::GetHistorySlot(u64 frame, u32 history_length, u32 frames_ago) { return (u32)((frame + history_length - frames_ago) % history_length); }
+
+    // the first frames have no content from before the first frame, 'frame - frames_ago' would wrap to the never written mark
+    bool RenderGraphResourceAllocator::IsHistorySlotValid(u64 written_frame, u64 frame, u32 frames_ago) { return frames_ago <= frame && written_frame == frame - frames_ago; }
+
+    void RenderGraphResourceAllocator::FreeHistoryTexture(IGfxTexture* texture, ngfx::GfxAccess::Flags state)
+    {
+        if (texture != nullptr)
+        {
+            RenderGraphScopedLock lock(m_lock);
+
+            for (size_t i = 0; i < m_historyTextures.size(); ++i)
+            {
+                HistoryTexture& history = m_historyTextures[i];
+
+                for (u32 j = 0; j < history.length; ++j)
+                {
+                    if (history.textures[j] == texture)
+                    {
+                        history.states[j] = state;
+                        return;
+                    }
+                }
+            }
+
+            ASSERT(false);
+        }
+    }
+
+    void RenderGraphResourceAllocator::DeleteHistoryTexture(HistoryTexture& history)
+    {
+        for (u32 i = 0; i < MaxHistoryLength; ++i)
+        {
+            if (history.textures[i] != nullptr)
+            {
+                m_historyMemorySize -= m_pDevice->GetAllocationSize(history.textures[i]->GetDesc());
+
+                DeleteDescriptor(history.textures[i]);
+                ReleaseDescriptorSet(history.descriptorSets[i]);
+                delete history.textures[i];
+                history.textures[i] = nullptr;
+            }
         }
     }
 
     IGfxDescriptor* RenderGraphResourceAllocator::GetDescriptor(IGfxResource* resource, const ngfx::GfxShaderResourceViewDesc& desc)
     {
+        RenderGraphScopedLock lock(m_lock);
+
         for (size_t i = 0; i < m_allocatedSRVs.size(); ++i)
         {
             if (m_allocatedSRVs[i].resource == resource && m_allocatedSRVs[i].desc == desc)
@@ -317,6 +1163,8 @@ namespace ncore
 
     IGfxDescriptor* RenderGraphResourceAllocator::GetDescriptor(IGfxResource* resource, const ngfx::GfxUnorderedAccessViewDesc& desc)
     {
+        RenderGraphScopedLock lock(m_lock);
+
         for (size_t i = 0; i < m_allocatedUAVs.size(); ++i)
         {
             if (m_allocatedUAVs[i].resource == resource && m_allocatedUAVs[i].desc == desc)
@@ -331,6 +1179,84 @@ namespace ncore
         return srv;
     }
 
+    u32 RenderGraphResourceAllocator::AllocateDescriptorSet()
+    {
+        if (m_firstFreeDescriptorSet != InvalidDescriptorSet)
+        {
+            u32 index                = m_firstFreeDescriptorSet;
+            m_firstFreeDescriptorSet = m_descriptorSets[index].nextFree;
+            return index;
+        }
+
+        m_descriptorSets.push_back({nullptr, nullptr, {}, {}, InvalidDescriptorSet});
+        return (u32)m_descriptorSets.size() - 1;
+    }
+
+    void RenderGraphResourceAllocator::ReleaseDescriptorSet(u32 descriptor_set)
+    {
+        if (descriptor_set == InvalidDescriptorSet)
+        {
+            return;
+        }
+
+        // the descriptor heap slots are released by the device once the GPU is done with them
+        DescriptorSet& set = m_descriptorSets[descriptor_set];
+        delete set.srv;
+        delete set.uav;
+
+        set.srv                  = nullptr;
+        set.uav                  = nullptr;
+        set.nextFree             = m_firstFreeDescriptorSet;
+        m_firstFreeDescriptorSet = descriptor_set;
+    }
+
+    // keeps the slot, a new resource behind it gets new views
+    void RenderGraphResourceAllocator::ResetDescriptorSet(u32 descriptor_set)
+    {
+        DescriptorSet& set = m_descriptorSets[descriptor_set];
+        delete set.srv;
+        delete set.uav;
+
+        set.srv = nullptr;
+        set.uav = nullptr;
+    }
+
+    IGfxDescriptor* RenderGraphResourceAllocator::GetBindlessSRV(u32 descriptor_set, IGfxResource* resource, const ngfx::GfxShaderResourceViewDesc& desc)
+    {
+        RenderGraphScopedLock lock(m_lock);
+
+        DescriptorSet& set = m_descriptorSets[descriptor_set];
+        if (set.srv != nullptr && !(set.srvDesc == desc))
+        {
+            Retire(set.srv);
+            set.srv = nullptr;
+        }
+        if (set.srv == nullptr)
+        {
+            set.srv     = m_pDevice->CreateShaderResourceView(resource, desc, resource->GetName());
+            set.srvDesc = desc;
+        }
+        return set.srv;
+    }
+
+    IGfxDescriptor* RenderGraphResourceAllocator::GetBindlessUAV(u32 descriptor_set, IGfxResource* resource, const ngfx::GfxUnorderedAccessViewDesc& desc)
+    {
+        RenderGraphScopedLock lock(m_lock);
+
+        DescriptorSet& set = m_descriptorSets[descriptor_set];
+        if (set.uav != nullptr && !(set.uavDesc == desc))
+        {
+            Retire(set.uav);
+            set.uav = nullptr;
+        }
+        if (set.uav == nullptr)
+        {
+            set.uav     = m_pDevice->CreateUnorderedAccessView(resource, desc, resource->GetName());
+            set.uavDesc = desc;
+        }
+        return set.uav;
+    }
+
     void RenderGraphResourceAllocator::DeleteDescriptor(IGfxResource* resource)
     {
         for (auto iter = m_allocatedSRVs.begin(); iter != m_allocatedSRVs.end();)
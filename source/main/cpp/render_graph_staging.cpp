@@ -0,0 +1,85 @@
+#include "crendergraph/render_graph_staging.h"
+
+namespace ncore
+{
+    RenderGraphStagingAllocator::RenderGraphStagingAllocator(u32 size)
+        : m_size(size)
+    {
+    }
+
+    bool RenderGraphStagingAllocator::Allocate(u32 size, u32 alignment, u32& offset)
+    {
+        u32 aligned = ((m_head + alignment - 1) / alignment) * alignment;
+        u32 padding = aligned - m_head;
+
+        if (aligned + size > m_size)
+        {
+            // skip the end of the buffer and continue at the start
+            aligned = 0;
+            padding = m_size - m_head;
+        }
+
+        // free space is contiguous starting at the head, so this also guarantees we don't run into in-flight data
+        if (m_used + padding + size > m_size)
+        {
+            return false;
+        }
+
+        m_head = aligned + size;
+        m_used += padding + size;
+        m_pending += padding + size;
+
+        offset = aligned;
+        return true;
+    }
+
+    u32 RenderGraphStagingAllocator::TakePending()
+    {
+        u32 pending = m_pending;
+        m_pending   = 0;
+        return pending;
+    }
+
+    void RenderGraphStagingAllocator::Submit(u64 fence_value, u32 size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+
+        ASSERT(m_numFrames < MaxFrames);
+
+        Frame& frame = m_frames[(m_firstFrame + m_numFrames) % MaxFrames];
+        frame.fence  = fence_value;
+        frame.size   = size;
+
+        m_numFrames++;
+    }
+
+    void RenderGraphStagingAllocator::Retire(u64 completed_fence_value)
+    {
+        while (m_numFrames > 0 && m_frames[m_firstFrame].fence <= completed_fence_value)
+        {
+            m_used -= m_frames[m_firstFrame].size;
+
+            m_firstFrame = (m_firstFrame + 1) % MaxFrames;
+            m_numFrames--;
+        }
+    }
+
+    RenderGraphStagingRing::RenderGraphStagingRing(IGfxDevice* pDevice, ngfx::GfxMemoryType memory_type, u32 size, cpstr_t name)
+        : RenderGraphStagingAllocator(size)
+    {
+        ngfx::GfxBufferDesc desc;
+        desc.size        = size;
+        desc.memory_type = memory_type;
+
+        m_pBuffer = pDevice->CreateBuffer(desc, name);
+        ASSERT(m_pBuffer != nullptr);
+
+        // upload and readback memory stays mapped for the lifetime of the buffer
+        m_pCpuAddress = (u8*)m_pBuffer->GetCpuAddress();
+    }
+
+    RenderGraphStagingRing::~RenderGraphStagingRing() { delete m_pBuffer; }
+} // namespace ncore
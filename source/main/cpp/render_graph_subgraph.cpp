@@ -0,0 +1,327 @@
+#include "crendergraph/render_graph_subgraph.h"
+#include "crendergraph/render_graph.h"
+
+namespace ncore
+{
+    RenderGraphSubgraph::~RenderGraphSubgraph()
+    {
+        for (size_t i = 0; i < m_passes.size(); ++i)
+        {
+            delete m_passes[i].proto;
+        }
+    }
+
+    RGHandle RenderGraphSubgraph::Input(u32 slot)
+    {
+        ASSERT(!m_bCompiled);
+
+        Resource resource = {};
+        resource.input    = (s32)slot;
+        m_resources.push_back(resource);
+
+        m_nInputs = math::max(m_nInputs, slot + 1);
+
+        RGHandle handle                = AddNode((u16)(m_resources.size() - 1));
+        m_resources[handle.index].node = handle.node;
+        return handle;
+    }
+
+    RGHandle RenderGraphSubgraph::AddResource(const RGTexture::Desc& desc, cpstr_t name)
+    {
+        ASSERT(!m_bCompiled);
+
+        Resource resource     = {};
+        resource.input        = -1;
+        resource.texture      = true;
+        resource.texture_desc = desc;
+        resource.name         = name;
+        m_resources.push_back(resource);
+
+        RGHandle handle                = AddNode((u16)(m_resources.size() - 1));
+        m_resources[handle.index].node = handle.node;
+        return handle;
+    }
+
+    RGHandle RenderGraphSubgraph::AddResource(const RGBuffer::Desc& desc, cpstr_t name)
+    {
+        ASSERT(!m_bCompiled);
+
+        Resource resource    = {};
+        resource.input       = -1;
+        resource.texture     = false;
+        resource.buffer_desc = desc;
+        resource.name        = name;
+        m_resources.push_back(resource);
+
+        RGHandle handle                = AddNode((u16)(m_resources.size() - 1));
+        m_resources[handle.index].node = handle.node;
+        return handle;
+    }
+
+    RGHandle RenderGraphSubgraph::AddNode(u16 resource)
+    {
+        RGHandle handle;
+        handle.index = resource;
+        handle.node  = (u16)m_nodeResources.size();
+
+        m_nodeResources.push_back(resource);
+
+        return handle;
+    }
+
+    RGHandle RenderGraphSubgraph::PushOp(const Op& op, bool write)
+    {
+        Op record          = op;
+        record.output_node = InvalidIndex;
+        record.prev_pass   = InvalidIndex;
+        record.uav_barrier = false;
+
+        RGHandle output;
+        output.index = op.resource;
+        output.node  = op.input_node;
+
+        if (write)
+        {
+            output             = AddNode(op.resource);
+            record.output_node = output.node;
+        }
+
+        m_ops.push_back(record);
+        m_passes[op.pass].num_ops++;
+
+        return output;
+    }
+
+    RGHandle RenderGraphSubgraph::Read(u32 pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, RGShaderStage stages)
+    {
+        ASSERT(input.IsValid());
+
+        Op op          = {};
+        op.type        = OpType::Read;
+        op.pass        = (u16)pass;
+        op.resource    = input.index;
+        op.input_node  = input.node;
+        op.usage       = usage;
+        op.stages      = stages != RGShaderStage::None ? stages : RGGetStages(usage);
+        op.subresource = subresource;
+        return PushOp(op, false);
+    }
+
+    RGHandle RenderGraphSubgraph::Write(u32 pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, bool non_overlapping, RGShaderStage stages, bool full_coverage)
+    {
+        ASSERT(input.IsValid());
+
+        Op op              = {};
+        op.type            = OpType::Write;
+        op.pass            = (u16)pass;
+        op.resource        = input.index;
+        op.input_node      = input.node;
+        op.usage           = usage;
+        op.stages          = stages != RGShaderStage::None ? stages : RGGetStages(usage);
+        op.subresource     = subresource;
+        op.non_overlapping = non_overlapping;
+        op.full_coverage   = full_coverage;
+        return PushOp(op, true);
+    }
+
+    RGHandle RenderGraphSubgraph::WriteColor(u32 pass, u32 color_index, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, const float4& clear_color, bool full_coverage)
+    {
+        ASSERT(input.IsValid());
+
+        Op op             = {};
+        op.type           = OpType::WriteColor;
+        op.pass           = (u16)pass;
+        op.resource       = input.index;
+        op.input_node     = input.node;
+        op.usage          = ngfx::GfxAccess::RTV;
+        op.subresource    = subresource;
+        op.color_index    = color_index;
+        op.load_op        = load_op;
+        op.clear_color[0] = clear_color[0];
+        op.clear_color[1] = clear_color[1];
+        op.clear_color[2] = clear_color[2];
+        op.clear_color[3] = clear_color[3];
+        op.full_coverage  = full_coverage;
+        return PushOp(op, true);
+    }
+
+    RGHandle RenderGraphSubgraph::WriteDepth(u32 pass, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth, u32 clear_stencil, bool full_coverage)
+    {
+        ASSERT(input.IsValid());
+
+        Op op              = {};
+        op.type            = OpType::WriteDepth;
+        op.pass            = (u16)pass;
+        op.resource        = input.index;
+        op.input_node      = input.node;
+        op.usage           = ngfx::GfxAccess::DSV;
+        op.subresource     = subresource;
+        op.load_op         = depth_load_op;
+        op.stencil_load_op = stencil_load_op;
+        op.clear_depth     = clear_depth;
+        op.clear_stencil   = clear_stencil;
+        op.full_coverage   = full_coverage;
+        return PushOp(op, true);
+    }
+
+    RGHandle RenderGraphSubgraph::ReadDepth(u32 pass, const RGHandle& input, u32 subresource)
+    {
+        ASSERT(input.IsValid());
+
+        Op op          = {};
+        op.type        = OpType::ReadDepth;
+        op.pass        = (u16)pass;
+        op.resource    = input.index;
+        op.input_node  = input.node;
+        op.usage       = ngfx::GfxAccess::DSVReadOnly;
+        op.subresource = subresource;
+        return PushOp(op, true);
+    }
+
+    void RenderGraphSubgraph::Compile()
+    {
+        ASSERT(!m_bCompiled);
+
+        for (size_t i = 0; i < m_resources.size(); ++i)
+        {
+            Resource& resource    = m_resources[i];
+            resource.pre_resolved = resource.input < 0;
+            resource.first_pass   = InvalidIndex;
+            resource.last_pass    = InvalidIndex;
+            resource.last_state   = GfxAccessDiscard;
+        }
+
+        // the render graph merges consecutive reads of a node into one state, the same is done here for internal resources.
+        // Every read of a run gets the whole union, so the state doesn't change when some of them are culled.
+        for (size_t i = 0; i < m_ops.size(); ++i)
+        {
+            const Op& op = m_ops[i];
+            if (op.type != OpType::Read || m_resources[op.resource].input >= 0 || !RenderGraphEdge::IsMergeableRead(op.usage))
+            {
+                continue;
+            }
+
+            const bool async = m_passes[op.pass].proto->GetType() == RenderPassType::AsyncCompute;
+
+            ngfx::GfxAccessFlags state  = 0;
+            RGShaderStage        stages = RGShaderStage::None;
+            size_t               end    = i;
+            for (; end < m_ops.size(); ++end)
+            {
+                const Op& next = m_ops[end];
+                if (next.resource != op.resource || next.subresource != op.subresource)
+                {
+                    continue;
+                }
+                if (next.type != OpType::Read || next.input_node != op.input_node || !RenderGraphEdge::IsMergeableRead(next.usage) ||
+                    (m_passes[next.pass].proto->GetType() == RenderPassType::AsyncCompute) != async)
+                {
+                    break;
+                }
+                state |= next.usage;
+                stages = stages | next.stages;
+            }
+
+            for (size_t j = i; j < end; ++j)
+            {
+                Op& next = m_ops[j];
+                if (next.resource == op.resource && next.subresource == op.subresource)
+                {
+                    next.usage  = state;
+                    next.stages = stages;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < m_ops.size(); ++i)
+        {
+            Op&       op       = m_ops[i];
+            Resource& resource = m_resources[op.resource];
+
+            // the state of an input is only known once it is bound, so those edges are resolved per instance
+            if (resource.input >= 0)
+            {
+                continue;
+            }
+
+            // the first access is left to the render graph as well, it has to place the aliasing barrier
+            for (s32 j = (s32)i - 1; j >= 0; --j)
+            {
+                const Op& prev = m_ops[j];
+                if (prev.resource == op.resource && prev.subresource == op.subresource)
+                {
+                    if (prev.pass != op.pass)
+                    {
+                        op.prev_pass   = prev.pass;
+                        op.old_state   = prev.usage;
+                        op.old_stages  = prev.stages;
+                        op.uav_barrier = prev.usage == op.usage && (op.usage & GfxAccessMaskUAV) && !(prev.non_overlapping && op.non_overlapping);
+                    }
+                    break;
+                }
+            }
+
+            if (resource.first_pass == InvalidIndex)
+            {
+                resource.first_pass = op.pass;
+            }
+            resource.last_pass  = op.pass;
+            resource.last_state = op.usage;
+
+            // async compute extends lifetimes to the graphics passes it syncs with, that is only known per frame
+            if (m_passes[op.pass].proto->GetType() == RenderPassType::AsyncCompute)
+            {
+                resource.pre_resolved = false;
+            }
+
+            if (resource.texture)
+            {
+                if (op.usage & GfxAccessRTV)
+                {
+                    resource.texture_desc.usage |= GfxTextureUsageRenderTarget;
+                }
+
+                if (op.usage & GfxAccessMaskUAV)
+                {
+                    resource.texture_desc.usage |= GfxTextureUsageUnorderedAccess;
+                }
+
+                if (op.usage & (GfxAccessDSV | GfxAccessDSVReadOnly))
+                {
+                    resource.texture_desc.usage |= GfxTextureUsageDepthStencil;
+                }
+            }
+            else if (op.usage & GfxAccessMaskUAV)
+            {
+                resource.buffer_desc.usage |= GfxBufferUsageUnorderedAccess;
+            }
+        }
+
+        for (size_t i = 0; i < m_resources.size(); ++i)
+        {
+            Resource& resource = m_resources[i];
+            if (resource.first_pass == InvalidIndex)
+            {
+                resource.pre_resolved = false;
+            }
+        }
+
+        m_bCompiled = true;
+    }
+
+    bool RenderGraphSubgraph::GetResolvedLifetime(const RGHandle& handle, u32& first_pass, u32& last_pass, ngfx::GfxAccessFlags& last_state) const
+    {
+        ASSERT(m_bCompiled && handle.IsValid());
+
+        const Resource& resource = m_resources[handle.index];
+        if (!resource.pre_resolved)
+        {
+            return false;
+        }
+
+        first_pass = resource.first_pass;
+        last_pass  = resource.last_pass;
+        last_state = resource.last_state;
+        return true;
+    }
+} // namespace ncore
@@ -0,0 +1,153 @@
+#include "crendergraph/render_graph_timing.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace ncore
+{
+#if RENDER_GRAPH_PASS_TIMINGS
+    namespace
+    {
+        const u32 MaxTimedPasses = 512; // power of two
+
+        struct PassTimer
+        {
+            std::atomic<u32> cursor;
+            std::atomic<u32> samples[RenderGraphPassTimings::WindowSize]; // nanoseconds, saturated
+        };
+
+        struct PassTiming
+        {
+            std::atomic<const void*> name;
+            PassTimer                timers[(u32)RGPassTimer::Count];
+        };
+
+        PassTiming               s_passTimings[MaxTimedPasses];
+        std::atomic<bool>        s_bTimingsEnabled{false};
+        std::atomic<RGClockFunc> s_clock{nullptr};
+
+        u32 HashName(const void* name)
+        {
+            u64 key = (u64)(uintptr_t)name;
+            key     = (key ^ (key >> 33)) * 0xff51afd7ed558ccdull;
+            return (u32)(key ^ (key >> 33));
+        }
+
+        u64 SteadyClock() { return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+    } // namespace
+
+    void RenderGraphPassTimings::SetEnabled(bool enabled) { s_bTimingsEnabled.store(enabled, std::memory_order_relaxed); }
+    bool RenderGraphPassTimings::IsEnabled() { return s_bTimingsEnabled.load(std::memory_order_relaxed); }
+    void RenderGraphPassTimings::SetClock(RGClockFunc clock) { s_clock.store(clock, std::memory_order_relaxed); }
+
+    u64 RenderGraphPassTimings::Now()
+    {
+        RGClockFunc clock = s_clock.load(std::memory_order_relaxed);
+        return clock != nullptr ? clock() : SteadyClock();
+    }
+
+    // open addressing on the name pointer, a slot is claimed with a compare-exchange so passes executed on
+    // different threads can register without a lock
+    u32 RenderGraphPassTimings::Register(cpstr_t name)
+    {
+        const void* key  = (const void*)name;
+        const u32   hash = HashName(key);
+
+        for (u32 i = 0; i < MaxTimedPasses; ++i)
+        {
+            const u32   slot  = (hash + i) & (MaxTimedPasses - 1);
+            PassTiming& entry = s_passTimings[slot];
+
+            const void* entry_name = entry.name.load(std::memory_order_acquire);
+            if (entry_name == key)
+            {
+                return slot;
+            }
+            if (entry_name == nullptr)
+            {
+                if (entry.name.compare_exchange_strong(entry_name, key, std::memory_order_acq_rel) || entry_name == key)
+                {
+                    return slot;
+                }
+            }
+        }
+        return InvalidSlot; // increase MaxTimedPasses
+    }
+
+    void RenderGraphPassTimings::AddSample(u32 slot, RGPassTimer timer, u64 ns)
+    {
+        if (slot == InvalidSlot)
+        {
+            return;
+        }
+
+        PassTimer& entry = s_passTimings[slot].timers[(u32)timer];
+        const u32  index = entry.cursor.fetch_add(1, std::memory_order_relaxed);
+        entry.samples[index & (WindowSize - 1)].store(ns < 0xFFFFFFFF ? (u32)ns : 0xFFFFFFFF, std::memory_order_relaxed);
+    }
+
+    u32     RenderGraphPassTimings::GetNumSlots() { return MaxTimedPasses; }
+    cpstr_t RenderGraphPassTimings::GetName(u32 slot) { return (cpstr_t)s_passTimings[slot].name.load(std::memory_order_acquire); }
+
+    bool RenderGraphPassTimings::GetHistogram(u32 slot, RGPassTimer timer, RGPassTimingHistogram& histogram)
+    {
+        histogram = {};
+
+        const PassTimer& entry = s_passTimings[slot].timers[(u32)timer];
+
+        const u32 count      = entry.cursor.load(std::memory_order_relaxed);
+        histogram.numSamples = count < WindowSize ? count : WindowSize;
+        if (histogram.numSamples == 0)
+        {
+            return false;
+        }
+
+        u64 total = 0;
+        for (u32 i = 0; i < histogram.numSamples; ++i)
+        {
+            const u64 ns = entry.samples[i].load(std::memory_order_relaxed);
+            total += ns;
+            histogram.maxNs = ns > histogram.maxNs ? ns : histogram.maxNs;
+
+            u32 bucket = 0;
+            for (u64 us = ns / 1000; us > 1 && bucket < RGPassTimingHistogram::NumBuckets - 1; us >>= 1)
+            {
+                bucket++;
+            }
+            histogram.counts[bucket]++;
+        }
+        histogram.averageNs = total / histogram.numSamples;
+        return true;
+    }
+
+    u64 RenderGraphPassTimings::GetCost(cpstr_t name)
+    {
+        const void* key  = (const void*)name;
+        const u32   hash = HashName(key);
+
+        for (u32 i = 0; i < MaxTimedPasses; ++i)
+        {
+            const u32   slot       = (hash + i) & (MaxTimedPasses - 1);
+            const void* entry_name = s_passTimings[slot].name.load(std::memory_order_acquire);
+            if (entry_name == key)
+            {
+                u64 cost = 0;
+                for (u32 t = 0; t < (u32)RGPassTimer::Count; ++t)
+                {
+                    RGPassTimingHistogram histogram;
+                    if (GetHistogram(slot, (RGPassTimer)t, histogram))
+                    {
+                        cost += histogram.averageNs;
+                    }
+                }
+                return cost;
+            }
+            if (entry_name == nullptr)
+            {
+                break;
+            }
+        }
+        return 0;
+    }
+#endif
+} // namespace ncore
@@ -7,11 +7,20 @@
 
 #include "cdag/c_dag.h"
 #include "cgfx/gfx_defines.h"
+#include "crendergraph/render_graph_arena.h"
+#include "crendergraph/render_graph_barrier_stats.h"
+#include "crendergraph/render_graph_cache.h"
+#include "crendergraph/render_graph_compile.h"
+#include "crendergraph/render_graph_event.h"
 #include "crendergraph/render_graph_pass.h"
 #include "crendergraph/render_graph_handle.h"
+#include "crendergraph/render_graph_import.h"
+#include "crendergraph/render_graph_job.h"
+#include "crendergraph/render_graph_recorder.h"
 #include "crendergraph/render_graph_resource.h"
 #include "crendergraph/render_graph_resource_allocator.h"
-#include "callocator/c_allocator_linear.h"
+#include "crendergraph/render_graph_staging.h"
+#include "crendergraph/render_graph_subgraph.h"
 
 namespace ncore
 {
@@ -29,20 +38,170 @@ namespace ncore
         T& operator[](s32 index) { return *(T*)nullptr; }
     };
 
+    // expected gain of the async compute promotion of a frame, in the unit of the pass costs
+    struct RGAsyncPromotionReport
+    {
+        u32 numCandidates;   // live Compute passes with a cost
+        u32 numPromoted;
+        u64 promotedCost;    // moved to the async compute queue
+        u64 expectedOverlap; // part of it that runs next to graphics work that doesn't depend on it
+    };
+
+    struct RGClearEliminationReport
+    {
+        u32 numDroppedClears; // clear load ops of full coverage writes turned into DontCare
+        u32 numDroppedLoads;  // load ops of full coverage writes turned into DontCare
+        u32 numFoldedPasses;  // clear passes folded into the load op of the pass after them
+    };
+
+    // cost of a pass without a cost hint, eg. its measured GPU time
+    typedef u64 (*RGPassCostFunc)(const RenderGraphPassBase* pass, void* user_data);
+
+    // everything recorded for one frame, it lives until its slot in the ring is recorded again. The steps of Compile
+    // that only read and rewrite the recorded graph are members, they need neither a renderer nor a device.
+    struct RenderGraphFrame
+    {
+        struct ObjFinalizer
+        {
+            void* obj;
+            void (*finalizer)(void*);
+        };
+
+        struct PresentTarget
+        {
+            RenderGraphResource* resource;
+            ngfx::GfxAccessFlags state;
+        };
+
+        RenderGraphArena*    allocator = nullptr; // created with the render graph, reset when the slot is recorded again
+        DirectedAcyclicGraph graph;
+
+        vector_t<RenderGraphPassBase*>     passes;
+        vector_t<RenderGraphPassBase*>     livePasses; // passes that survived culling in execution order, built by Compile
+        vector_t<RenderGraphResource*>     resources;
+        vector_t<RenderGraphResourceNode*> resourceNodes;
+        vector_t<ObjFinalizer>             objFinalizer;
+        vector_t<PresentTarget>            outputResources;
+        vector_t<u32>                      imports; // registered imports used by the frame
+
+        vector_t<RenderGraphPassBase*> levelPasses;  // live passes grouped by dependency level, in execution order per level
+        vector_t<u32>                  levelFirst;   // first entry of every level in 'levelPasses', plus the end
+        vector_t<RenderGraphPassBase*> criticalPath; // one pass per level, each depends on the one before
+        vector_t<u32>                  dependencies; // pairs of live pass indices, dependency then pass, in pass order
+        RGAsyncPromotionReport         promotion = {};
+        RGClearEliminationReport       clears    = {};
+
+        vector_t<RenderGraphRecorder*> recorders; // pooled, the first 'numRecorders' are in use
+        u32                            numRecorders       = 0;
+        u32                            numMergedRecorders = 0;
+
+#if RENDER_GRAPH_EVENTS
+        vector_t<u32> eventStream;       // ids of all begun events of the frame, passes refer to a range of it
+        vector_t<u32> liveEventStream;   // the events that enclose live passes, live passes refer to it after Compile
+        u32           pendingEvents = 0; // begun events at the end of the stream that wait for their first pass
+#endif
+
+        u64  id                       = 0;
+        bool compiled                 = false;
+        bool cached                   = false; // sync plan and lifetimes were taken from the compiled graph cache
+        bool graphicsConstantsPending = false;
+        u32  uploadSize               = 0; // staging bytes recorded for this frame, released with its fence
+        u32  readbackSize             = 0;
+        u64  stagingFence             = 0; // set by Execute
+
+        void BuildLivePasses();
+        void EliminateRedundantClears();
+        void BuildDependencyLevels();
+
+        // see RenderGraph::EnableAsyncComputePromotion, 'cost' is only asked for passes without a cost hint
+        void PromoteAsyncCompute(RGPassCostFunc cost, void* user_data, u64 min_cost, bool cached);
+
+        // the nodes of every resource in recording order, resource i owns [first[i], first[i + 1]) of 'nodes'
+        void BucketResourceNodes(RenderGraphResourceNode**& nodes, u32*& first);
+        void MergeReadStates(RenderGraphResourceNode* node, vector_t<DAGEdge*>& edges, vector_t<RGReadAccess>& reads) const;
+
+    private:
+        bool FoldClearPass(RenderGraphPassBase* pass, vector_t<DAGEdge*>& edges);
+    };
+
     class RenderGraph
     {
         friend class RGBuilder;
+        template <class T> friend class RenderGraphSubgraphPassProto;
+        template <class T> friend class RenderGraphRecordedPass;
 
     public:
         RenderGraph(Renderer* pRenderer);
+        ~RenderGraph();
 
         template <typename Data, typename Setup, typename Exec> RenderGraphPass<Data>& AddPass(cpstr_t name, RenderPassType type, const Setup& setup, const Exec& execute);
 
-        void BeginEvent(cpstr_t name);
+        // standalone clear of a render target or depth buffer, returns the cleared version. Compile folds the pass into the
+        // load op of the next pass when that pass is the only one that uses the cleared version and renders to it, then
+        // only the barriers of the clear pass are left.
+        RGHandle AddClearPass(cpstr_t name, const RGHandle& target, u32 subresource, const float4& clear_color);
+        RGHandle AddClearDepthPass(cpstr_t name, const RGHandle& target, u32 subresource, float clear_depth, u32 clear_stencil = 0);
+
+        // records a new instance of a compiled subgraph, 'inputs' are bound to the subgraph input slots in order
+        const RGSubgraphInstance& Instantiate(const RenderGraphSubgraph& subgraph, const RGHandle* inputs, u32 num_inputs, u32 index = 0);
+
+        // per thread pass recording, recorders are created on the recording thread and handed to workers, the recorder
+        // is owned by the frame. MergeRecorders appends the passes of all recorders not merged yet at the point it is
+        // called, Compile merges whatever is left.
+        RenderGraphRecorder* CreateRecorder(u32 sort_key);
+        void                 MergeRecorders();
+
+#if RENDER_GRAPH_EVENTS
+        void BeginEvent(u32 id); // id from RGEventHash, registered with RenderGraphEventTable
         void EndEvent();
 
-        void Clear();
+        const u32* GetEventStream() const { return GetFrame().liveEventStream.data(); } // events of the live passes, valid after Compile
+#else
+        void BeginEvent(u32 id) {}
+        void EndEvent() {}
+#endif
+
+        // Compile spreads its loops over the job system in chunks of 'chunk_size' elements, nullptr runs them on the calling thread
+        void SetJobSystem(IRenderGraphJobSystem* job_system, u32 chunk_size = 64)
+        {
+            m_pJobSystem    = job_system;
+            m_nJobChunkSize = chunk_size;
+        }
+
+        // frames are kept in a ring, so the next frame can be recorded and compiled (eg. on a worker thread) while the
+        // last one executes. Clear starts recording a frame and Execute runs the oldest compiled one, every compiled
+        // frame has to be executed before its slot comes around again. Clear returns false when every slot still holds a
+        // frame that wasn't executed, nothing may be recorded until a later Clear (after an Execute) succeeded.
+        static const u32 MaxFrames = 2;
+
+        // block size of the per-frame arena that holds the passes, resources and compile scratch of a frame, a frame
+        // that needs more grows the arena by another block
+        static const u32 FrameArenaSize = 4 * 1024 * 1024;
+
+        bool Clear();
         void Compile();
+
+        // diagnostics, Compile classifies every barrier it resolves and attributes it to the passes involved
+        void                           SetBarrierAnalysis(bool enable) { m_bAnalyzeBarriers = enable; }
+        const RenderGraphBarrierStats& GetBarrierStats() const { return m_barrierStats; }
+
+        // compiled graph cache, see RGCompiledGraphHeader. The structural hash covers the recorded passes, resources and
+        // edges (merge the recorders first), it keys the cache file. SaveCompiled writes the frame compiled last, before it
+        // is executed, and returns the size of the blob, it writes nothing when 'capacity' is too small. A loaded blob is
+        // used by every Compile of a graph with the same hash until the next LoadCompiled, its memory has to stay valid.
+        u64  GetStructuralHash() const;
+        u32  SaveCompiled(void* data, u32 capacity) const;
+        bool LoadCompiled(const void* data, u32 size);
+
+        // opt-in heap compaction, call after Clear and before recording the next frame, with no other frame compiled
+        RenderGraphResourceAllocator::CompactionStats CompactHeaps() { return m_resourceAllocator.Compact(); }
+
+        // per scenario allocation profiles, capture at the end of frames while the scenario runs and prewarm from a loading
+        // thread before its first frame so that frame finds its heaps, placed resources and default views already created
+        void CaptureAllocationProfile(RenderGraphResourceAllocator::AllocationProfile& profile) const { m_resourceAllocator.CaptureProfile(profile); }
+        void PrewarmAllocations(const RenderGraphResourceAllocator::AllocationProfile& profile) { m_resourceAllocator.Prewarm(profile); }
+
+        // binds the calling thread to the executed frame until it calls Clear, its GetTexture, GetBuffer and GetReadback refer to that frame
         void Execute(Renderer* pRenderer, IGfxCommandList* pCommandList, IGfxCommandList* pComputeCommandList);
 
         void Present(const RGHandle& handle, ngfx::GfxAccessFlags filnal_state);
@@ -50,10 +209,49 @@ namespace ncore
         RGHandle Import(IGfxTexture* texture, ngfx::GfxAccessFlags state);
         RGHandle Import(IGfxBuffer* buffer, ngfx::GfxAccessFlags state);
 
+        // persistent imports, the graph tracks their state across frames. The state a compiled frame leaves a registered
+        // resource in, or its Present state, is the initial state of the next frame that imports it, so no barrier is
+        // emitted for a resource that already is in the state its first pass needs. Imports of the same id in one frame
+        // return the same handle.
+        u32                  RegisterImport(IGfxTexture* texture, ngfx::GfxAccessFlags state);
+        u32                  RegisterImport(IGfxBuffer* buffer, ngfx::GfxAccessFlags state);
+        void                 UnregisterImport(u32 id);
+        RGHandle             Import(u32 id);
+        ngfx::GfxAccessFlags GetImportState(u32 id) const { return m_imports.Get(id).state; }
+
+        // graph owned texture that persists for 'history_length' frames, 'frames_ago' = 0 is the slot written this frame
+        RGHandle CreateHistory(const RGTexture::Desc& desc, cpstr_t name, u32 frames_ago, u32 history_length = 2);
+
+        // staging buffers live in persistently mapped rings, an invalid handle is returned when the ring is full
+        RGHandle CreateUploadBuffer(u32 size, cpstr_t name, void*& cpu_address);
+        RGHandle CreateReadbackBuffer(u32 size, cpstr_t name);
+
+        // after Execute, the readback can be mapped once the GPU has passed its fence, the data stays valid
+        // for GFX_MAX_INFLIGHT_FRAMES frames after that, MapReadback returns nullptr while it is not ready yet.
+        RGReadback  GetReadback(const RGHandle& handle) const;
+        const void* MapReadback(const RGReadback& readback) const;
+
         RGTexture* GetTexture(const RGHandle& handle);
         RGBuffer*  GetBuffer(const RGHandle& handle);
 
-        const DirectedAcyclicGraph& GetDAG() const { return m_graph; }
+        // opt-in, Compile moves live Compute passes to the async compute queue when their dependency slack holds enough
+        // independent graphics work to hide at least half of their cost, the fences are planned like for AsyncCompute
+        // passes. Passes cheaper than 'min_cost' stay, a cross queue sync costs more than they'd gain.
+        void                          EnableAsyncComputePromotion(RGPassCostFunc cost, void* user_data, u64 min_cost);
+        void                          DisableAsyncComputePromotion() { m_pPromotionCost = nullptr; }
+        const RGAsyncPromotionReport& GetAsyncPromotionReport() const { return GetFrame().promotion; }
+
+        // clears and loads Compile found redundant, see RGBuilderFlag::FullCoverageWrite and AddClearPass
+        const RGClearEliminationReport& GetClearEliminationReport() const { return GetFrame().clears; }
+
+        const DirectedAcyclicGraph& GetDAG() const { return GetFrame().graph; }
+
+        // dependency levels of the compiled frame, the passes of a level are independent of each other: none reads or
+        // writes what another one writes. The number of levels is the length of the critical path in passes, few passes
+        // per level point at a serialized frame. See RenderGraphPassBase::GetDependencyLevel for the level of a pass.
+        u32                                   GetNumDependencyLevels() const { return (u32)GetFrame().criticalPath.size(); }
+        RenderGraphPassBase* const*           GetDependencyLevel(u32 level, u32& count) const;
+        const vector_t<RenderGraphPassBase*>& GetCriticalPath() const { return GetFrame().criticalPath; }
         cpstr_t                     Export(nstring::storage_t* strs);
 
     private:
@@ -62,19 +260,62 @@ namespace ncore
 
         template <typename Resource> RGHandle Create(const typename Resource::Desc& desc, cpstr_t name);
 
-        RGHandle Read(RenderGraphPassBase* pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource);
-        RGHandle Write(RenderGraphPassBase* pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource);
+        RGHandle Read(RenderGraphPassBase* pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, RGShaderStage stages = RGShaderStage::None);
+        RGHandle Write(RenderGraphPassBase* pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, bool non_overlapping = false, RGShaderStage stages = RGShaderStage::None, bool full_coverage = false);
 
-        RGHandle WriteColor(RenderGraphPassBase* pass, u32 color_index, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, const float4& clear_color);
-        RGHandle WriteDepth(RenderGraphPassBase* pass, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth, u32 clear_stencil);
+        RGHandle WriteColor(RenderGraphPassBase* pass, u32 color_index, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, const float4& clear_color, bool full_coverage = false);
+        RGHandle WriteDepth(RenderGraphPassBase* pass, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth, u32 clear_stencil, bool full_coverage = false);
         RGHandle ReadDepth(RenderGraphPassBase* pass, const RGHandle& input, u32 subresource);
 
+#if RENDER_GRAPH_EVENTS
+        void AttachPendingEvents(RenderGraphPassBase* pass);
+#endif
+
+        RGHandle Resolve(const RGHandle& handle) const;
+        void     Merge(RenderGraphRecorder* recorder);
+
+        void        ParallelFor(u32 count, void (*job)(u32 begin, u32 end, void* context));
+        static void ResolveResourcesJob(u32 begin, u32 end, void* context);
+        static void PrepareRealizeJob(u32 begin, u32 end, void* context);
+        static void ResolveBarriersJob(u32 begin, u32 end, void* context);
+
+    private:
+        typedef RenderGraphFrame              Frame;
+        typedef RenderGraphFrame::ObjFinalizer  ObjFinalizer;
+        typedef RenderGraphFrame::PresentTarget PresentTarget;
+
+        // the calling thread sees the frame it executes, see Execute, any other thread the frame being recorded
+        Frame&       GetFrame();
+        const Frame& GetFrame() const;
+        Frame&       GetRecordFrame() { return m_frames[m_nRecordFrame % MaxFrames]; }
+        const Frame& GetRecordFrame() const { return m_frames[m_nRecordFrame % MaxFrames]; }
+
+        u64  HashStructure(const Frame& frame) const;
+        bool ApplyCompiled(Frame& frame, const RGCompiledGraphHeader* header);
+
     private:
-        linear_alloc_t*              m_allocator;
+        Frame            m_frames[MaxFrames];
+        std::atomic<u64> m_nRecordFrame{0};
+        std::atomic<u64> m_nExecuteFrame{0};
+
         RenderGraphResourceAllocator m_resourceAllocator;
-        DirectedAcyclicGraph         m_graph;
 
-        vector_t<cpstr_t> m_eventNames;
+        RenderGraphImportRegistry m_imports;
+
+        RGPassCostFunc m_pPromotionCost     = nullptr; // async compute promotion is off without a cost function
+        void*          m_pPromotionUserData = nullptr;
+        u64            m_nPromotionMinCost  = 0;
+
+        bool                    m_bAnalyzeBarriers = false;
+        RenderGraphBarrierStats m_barrierStats;
+
+        const RGCompiledGraphHeader* m_pCompiledGraph         = nullptr; // see LoadCompiled
+        bool                         m_bCompiledHeapsReserved = false;
+
+        IRenderGraphJobSystem*    m_pJobSystem    = nullptr;
+        u32                       m_nJobChunkSize = 64;
+        RenderGraphResourceNode** m_pResolveNodes = nullptr; // nodes grouped per resource, only valid during Compile
+        u32*                      m_pResolveFirst = nullptr;
 
         IGfxFence* m_pComputeQueueFence;
         u64        m_nComputeQueueFenceValue = 0;
@@ -82,32 +323,21 @@ namespace ncore
         IGfxFence* m_pGraphicsQueueFence;
         u64        m_nGraphicsQueueFenceValue = 0;
 
-        vector_t<RenderGraphPassBase*>     m_passes;
-        vector_t<RenderGraphResource*>     m_resources;
-        vector_t<RenderGraphResourceNode*> m_resourceNodes;
-
-        struct ObjFinalizer
-        {
-            void* obj;
-            void (*finalizer)(void*);
-        };
-        vector_t<ObjFinalizer> m_objFinalizer;
-
-        struct PresentTarget
-        {
-            RenderGraphResource* resource;
-            ngfx::GfxAccessFlags state;
-        };
-        vector_t<PresentTarget> m_outputResources;
+        // recording and Execute may run on different threads, both touch the staging rings
+        IGfxFence*             m_pStagingFence;
+        u64                    m_nStagingFenceValue = 0;
+        RenderGraphSpinLock    m_stagingLock;
+        RenderGraphStagingRing m_uploadRing;
+        RenderGraphStagingRing m_readbackRing;
     };
 
     class RenderGraphEvent
     {
     public:
-        RenderGraphEvent(RenderGraph* graph, cpstr_t name)
+        RenderGraphEvent(RenderGraph* graph, u32 id)
             : m_pRenderGraph(graph)
         {
-            m_pRenderGraph->BeginEvent(name);
+            m_pRenderGraph->BeginEvent(id);
         }
 
         ~RenderGraphEvent() { m_pRenderGraph->EndEvent(); }
@@ -116,7 +346,14 @@ namespace ncore
         RenderGraph* m_pRenderGraph;
     };
 
-#define RENDER_GRAPH_EVENT(graph, event_name) RenderGraphEvent __graph_event__(graph, event_name)
+#if RENDER_GRAPH_EVENTS
+#    define RENDER_GRAPH_EVENT(graph, event_name)                                                                                \
+        constexpr u32    __graph_event_hash__ = RGEventHash(event_name);                                                    \
+        static const u32 __graph_event_id__   = RenderGraphEventTable::Register(__graph_event_hash__, event_name);          \
+        RenderGraphEvent __graph_event__(graph, __graph_event_id__)
+#else
+#    define RENDER_GRAPH_EVENT(graph, event_name) (void)0
+#endif
 } // namespace ncore
 
 #include "crendergraph/render_graph.inl"
@@ -14,15 +14,38 @@ namespace ncore
         //: DAGEdge(graph, from, to)
         {
             m_usage       = usage;
+            m_state       = usage;
+            m_stages      = RGGetStages(usage);
             m_subresource = subresource;
         }
 
         ngfx::GfxAccessFlags GetUsage() const { return m_usage; }
         u32                  GetSubresource() const { return m_subresource; }
 
+        // state the resource is in during the pass, a read may be merged with the reads next to it
+        ngfx::GfxAccessFlags GetState() const { return m_state; }
+        void                 SetState(ngfx::GfxAccessFlags state) { m_state = state; }
+
+        // stages the pass accesses the resource in, by default the widest ones its usage implies
+        RGShaderStage GetStages() const { return m_stages; }
+        void          SetStages(RGShaderStage stages) { m_stages = stages; }
+
+        static bool IsMergeableRead(ngfx::GfxAccessFlags usage) { return (usage & ~(GfxAccessMaskSRV | GfxAccessIndirectArgs | GfxAccessCopySrc)) == 0; }
+
+        bool IsNonOverlappingWrite() const { return m_bNonOverlappingWrite; }
+        void SetNonOverlappingWrite() { m_bNonOverlappingWrite = true; }
+
+        // the pass writes every texel of the subresource, what it held before is never read
+        bool IsFullCoverageWrite() const { return m_bFullCoverageWrite; }
+        void SetFullCoverageWrite() { m_bFullCoverageWrite = true; }
+
     private:
         ngfx::GfxAccessFlags m_usage;
+        ngfx::GfxAccessFlags m_state;
+        RGShaderStage        m_stages;
         u32                  m_subresource;
+        bool                 m_bNonOverlappingWrite = false;
+        bool                 m_bFullCoverageWrite   = false;
     };
 
     // ====> DAGNode
@@ -84,6 +107,16 @@ namespace ncore
         ngfx::GfxRenderPass::LoadOp GetLoadOp() const { return m_loadOp; }
         const float*                GetClearColor() const { return m_clearColor; }
 
+        // Compile rewrites redundant clears, see RenderGraph::EliminateRedundantClears
+        void SetLoadOp(ngfx::GfxRenderPass::LoadOp load_op) { m_loadOp = load_op; }
+        void SetClearColor(const float* clear_color)
+        {
+            m_clearColor[0] = clear_color[0];
+            m_clearColor[1] = clear_color[1];
+            m_clearColor[2] = clear_color[2];
+            m_clearColor[3] = clear_color[3];
+        }
+
     private:
         u32                         m_colorIndex;
         ngfx::GfxRenderPass::LoadOp m_loadOp;
@@ -110,6 +143,17 @@ namespace ncore
         u32                         GetClearStencil() const { return m_clearStencil; };
         bool                        IsReadOnly() const { return m_bReadOnly; }
 
+        void SetDepthLoadOp(ngfx::GfxRenderPass::LoadOp load_op, float clear_depth)
+        {
+            m_depthLoadOp = load_op;
+            m_clearDepth  = clear_depth;
+        }
+        void SetStencilLoadOp(ngfx::GfxRenderPass::LoadOp load_op, u32 clear_stencil)
+        {
+            m_stencilLoadOp = load_op;
+            m_clearStencil  = clear_stencil;
+        }
+
     private:
         ngfx::GfxRenderPass::LoadOp m_depthLoadOp;
         ngfx::GfxRenderPass::LoadOp m_stencilLoadOp;
@@ -122,20 +166,22 @@ namespace ncore
 
     template <typename T, typename... ArgsT> inline T* RenderGraph::Allocate(ArgsT&&... arguments)
     {
-        T* p = (T*)m_allocator.Alloc(sizeof(T));
+        Frame& frame = GetRecordFrame();
+
+        T* p = (T*)frame.allocator->Alloc(sizeof(T));
         new (p) T(arguments...);
 
         ObjFinalizer finalizer;
         finalizer.obj       = p;
         finalizer.finalizer = &ClassFinalizer<T>;
-        m_objFinalizer.push_back(finalizer);
+        frame.objFinalizer.push_back(finalizer);
 
         return p;
     }
 
     template <typename T, typename... ArgsT> inline T* RenderGraph::AllocatePOD(ArgsT&&... arguments)
     {
-        T* p = (T*)m_allocator.Alloc(sizeof(T));
+        T* p = (T*)GetRecordFrame().allocator->Alloc(sizeof(T));
         new (p) T(arguments...);
 
         return p;
@@ -143,33 +189,104 @@ namespace ncore
 
     template <typename Data, typename Setup, typename Exec> inline RenderGraphPass<Data>& RenderGraph::AddPass(cpstr_t name, RenderPassType type, const Setup& setup, const Exec& execute)
     {
-        auto pass = Allocate<RenderGraphPass<Data>>(name, type, m_graph, execute);
+        Frame& frame = GetRecordFrame();
 
-        for (size_t i = 0; i < m_eventNames.size(); ++i)
-        {
-            pass->BeginEvent(m_eventNames[i]);
-        }
-        m_eventNames.clear();
+        auto pass = Allocate<RenderGraphPass<Data>>(name, type, frame.graph, execute);
+
+#if RENDER_GRAPH_EVENTS
+        AttachPendingEvents(pass);
+#endif
 
         RGBuilder builder(this, pass);
         setup(pass->GetData(), builder);
 
-        m_passes.push_back(pass);
+        pass->SetIndex((u32)frame.passes.size());
+
+        frame.passes.push_back(pass);
 
         return *pass;
     }
 
+    template <class T> inline RenderGraphPassBase* RenderGraphSubgraphPassProto<T>::Instantiate(RenderGraph& graph, const RGSubgraphInstance* instance)
+    {
+        return graph.Allocate<RenderGraphSubgraphPass<T>>(m_name, m_type, graph.GetRecordFrame().graph, m_parameters, m_execute, instance);
+    }
+
+    template <typename Data, typename Setup, typename Exec> inline RenderGraphSubgraphPassProto<Data>& RenderGraphSubgraph::AddPass(cpstr_t name, RenderPassType type, const Setup& setup, const Exec& execute)
+    {
+        ASSERT(!m_bCompiled);
+
+        // the subgraph outlives the frame allocator of the render graph
+        auto proto = new RenderGraphSubgraphPassProto<Data>(name, type, execute);
+
+        Pass pass;
+        pass.proto        = proto;
+        pass.first_op     = (u32)m_ops.size();
+        pass.num_ops      = 0;
+        pass.skip_culling = false;
+        m_passes.push_back(pass);
+
+        RGBuilder builder(this, (u32)(m_passes.size() - 1), type);
+        setup(proto->GetData(), builder);
+
+        return *proto;
+    }
+
+    template <class T> inline RenderGraphPassBase* RenderGraphRecordedPass<T>::Instantiate(RenderGraph& graph)
+    {
+        auto pass       = graph.Allocate<RenderGraphPass<T>>(m_name, m_type, graph.GetRecordFrame().graph, m_execute);
+        pass->GetData() = m_parameters;
+        return pass;
+    }
+
+    template <typename T, typename... ArgsT> inline T* RenderGraphRecorder::Allocate(ArgsT&&... arguments)
+    {
+        T* p = (T*)m_allocator->Alloc(sizeof(T));
+        new (p) T(arguments...);
+
+        ObjFinalizer finalizer;
+        finalizer.obj       = p;
+        finalizer.finalizer = &ClassFinalizer<T>;
+        m_objFinalizer.push_back(finalizer);
+
+        return p;
+    }
+
+    template <typename Data, typename Setup, typename Exec> inline RenderGraphRecordedPass<Data>& RenderGraphRecorder::AddPass(cpstr_t name, RenderPassType type, const Setup& setup, const Exec& execute)
+    {
+        ASSERT(!m_bMerged);
+
+        // the render graph pass is created at the merge, the data is copied into it
+        auto proto = Allocate<RenderGraphRecordedPass<Data>>(name, type, execute);
+
+        Pass pass;
+        pass.proto        = proto;
+        pass.first_op     = (u32)m_ops.size();
+        pass.num_ops      = 0;
+        pass.skip_culling = false;
+        m_passes.push_back(pass);
+
+        RGBuilder builder(this, (u32)(m_passes.size() - 1), type);
+        setup(proto->GetData(), builder);
+
+        return *proto;
+    }
+
     template <typename Resource> inline RGHandle RenderGraph::Create(const typename Resource::Desc& desc, cpstr_t name)
     {
+        Frame& frame = GetRecordFrame();
+
         auto resource = Allocate<Resource>(m_resourceAllocator, name, desc);
-        auto node     = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, 0);
+        auto node     = AllocatePOD<RenderGraphResourceNode>(frame.graph, resource, 0);
 
         RGHandle handle;
-        handle.index = (u16)m_resources.size();
-        handle.node  = (u16)m_resourceNodes.size();
+        handle.index = (u16)frame.resources.size();
+        handle.node  = (u16)frame.resourceNodes.size();
+
+        resource->SetIndex(handle.index);
 
-        m_resources.push_back(resource);
-        m_resourceNodes.push_back(node);
+        frame.resources.push_back(resource);
+        frame.resourceNodes.push_back(node);
 
         return handle;
     }
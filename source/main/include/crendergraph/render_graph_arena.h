@@ -0,0 +1,42 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_ARENA_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_ARENA_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+namespace ncore
+{
+    // bump allocator over a chain of blocks from the system allocator, a block is added when the chain is full.
+    // Reset rewinds to the first block and keeps the chain, so a frame that fit once doesn't allocate again.
+    class RenderGraphArena
+    {
+    public:
+        RenderGraphArena(u32 block_size);
+        ~RenderGraphArena();
+
+        void* Alloc(u32 size, u32 alignment = 16);
+        void  Reset();
+
+        u32 GetNumBlocks() const { return m_numBlocks; }
+
+    private:
+        struct Block
+        {
+            Block* next;
+            u32    size;
+            u32    used;
+        };
+
+        static u8* GetData(Block* block);
+        Block*     AddBlock(u32 min_size);
+
+        Block* m_pFirst    = nullptr;
+        Block* m_pCurrent  = nullptr;
+        Block* m_pLast     = nullptr;
+        u32    m_blockSize = 0;
+        u32    m_numBlocks = 0;
+    };
+} // namespace ncore
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_BARRIER_STATS_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_BARRIER_STATS_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "cdag/c_dag.h"
+#include "cgfx/gfx_defines.h"
+#include "crendergraph/render_graph_stage.h"
+
+namespace ncore
+{
+    class IGfxResource;
+    class RenderGraphResource;
+
+    enum class RGBarrierClass : u8
+    {
+        Required,
+        ReadToRead,       // both states are read-only, merging the read states would have avoided it
+        Undone,           // reverts the previous transition of the same subresource
+        RedundantDiscard, // the aliased memory held nothing, it was never used or already discarded this frame
+        Count,
+    };
+
+    // the builder call that asked for the new state
+    enum class RGBarrierSource : u8
+    {
+        Read,
+        Write,
+        WriteColor,
+        WriteDepth,
+        ReadDepth,
+    };
+
+    struct RGBarrierRecord
+    {
+        DAGNode*             pass;      // pass that emits the barrier
+        DAGNode*             prev_pass; // pass whose access left the old state, nullptr for the initial state of the resource
+        RenderGraphResource* resource;
+        IGfxResource*        aliased; // only set for a discard barrier, the resource that used the memory before
+        u32                  subresource;
+        ngfx::GfxAccessFlags old_state;
+        ngfx::GfxAccessFlags new_state;
+        RGShaderStage        old_stages; // stages that have to finish before the barrier
+        RGShaderStage        new_stages; // stages that wait for it
+        RGBarrierSource      source;
+        RGBarrierClass       type; // filled in by RenderGraphBarrierStats::Add
+        bool                 discard;
+    };
+
+    // per frame aggregation of the barriers ResolveBarriers emitted, filled in pass order after Compile
+    class RenderGraphBarrierStats
+    {
+    public:
+        void Reset();
+        void Add(const RGBarrierRecord* records, u32 count);
+
+        u32 GetCount(RGBarrierClass type) const { return m_counts[(u32)type]; }
+        u32 GetNumResourceBarriers() const { return m_nResourceBarriers; }
+        u32 GetNumDiscardBarriers() const { return m_nDiscardBarriers; }
+
+        // every classified barrier of the frame, in execution order
+        const vector_t<RGBarrierRecord>& GetRecords() const { return m_records; }
+
+        static RGBarrierSource GetSource(ngfx::GfxAccessFlags new_state);
+        static bool            IsReadOnly(ngfx::GfxAccessFlags state);
+
+    private:
+        static const u32 InvalidRecord = 0xFFFFFFFF;
+
+        // open addressing on (key, subresource), the table is grown to keep it at most half full
+        struct IndexSlot
+        {
+            const void* key; // nullptr for a free slot
+            u32         subresource;
+            u32         record;
+        };
+
+        struct Index
+        {
+            vector_t<IndexSlot> slots;
+            u32                 count = 0;
+
+            void       Clear();
+            u32        Find(const void* key, u32 subresource) const; // InvalidRecord when the key is absent
+            void       Set(const void* key, u32 subresource, u32 record);
+            IndexSlot& Probe(const void* key, u32 subresource); // the slot of the key, or the free slot it goes to
+        };
+
+        const RGBarrierRecord* FindPrevTransition(const RGBarrierRecord& record) const;
+        bool                   IsDiscarded(IGfxResource* aliased) const;
+
+        vector_t<RGBarrierRecord> m_records;
+        Index                     m_transitions; // (resource, subresource) -> latest transition record
+        Index                     m_discards;    // aliased resource -> first discard of it
+        u32                       m_counts[(u32)RGBarrierClass::Count] = {};
+        u32                       m_nResourceBarriers                  = 0;
+        u32                       m_nDiscardBarriers                   = 0;
+    };
+} // namespace ncore
+#endif
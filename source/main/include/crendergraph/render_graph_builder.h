@@ -6,13 +6,18 @@
 namespace ncore
 {
 
-    enum class RGBuilderFlag
+    enum class RGBuilderFlag : u32
     {
-        None,
-        ShaderStagePS,
-        ShaderStageNonPS,
+        None                 = 0,
+        ShaderStagePS        = 1 << 0, // coarse stage selection of the default Read and Write, see the RGShaderStage overloads
+        ShaderStageNonPS     = 1 << 1,
+        NonOverlappingWrites = 1 << 2, // the pass writes a region no other pass writes, consecutive writes of the same state skip the UAV barrier
+        FullCoverageWrite    = 1 << 3, // the pass writes every texel of the subresource, Compile drops the clears and loads before it
     };
 
+    inline RGBuilderFlag operator|(RGBuilderFlag a, RGBuilderFlag b) { return (RGBuilderFlag)((u32)a | (u32)b); }
+    inline bool          HasFlag(RGBuilderFlag flags, RGBuilderFlag flag) { return ((u32)flags & (u32)flag) != 0; }
+
     class RGBuilder
     {
     public:
@@ -20,35 +25,122 @@ namespace ncore
         {
             m_pGraph = graph;
             m_pPass  = pass;
+            m_type   = pass->GetType();
         }
 
-        void SkipCulling() { m_pPass->MakeTarget(); }
+        // records into a subgraph, handles are local to the subgraph
+        RGBuilder(RenderGraphSubgraph* subgraph, u32 pass, RenderPassType type)
+        {
+            m_pSubgraph    = subgraph;
+            m_subgraphPass = pass;
+            m_type         = type;
+        }
+
+        // records into a recorder on its own thread, see RenderGraphRecorder
+        RGBuilder(RenderGraphRecorder* recorder, u32 pass, RenderPassType type)
+        {
+            m_pRecorder    = recorder;
+            m_recorderPass = pass;
+            m_type         = type;
+        }
 
-        template <typename Resource> RGHandle Create(const typename Resource::Desc& desc, const nstring::str_t const* name) { return m_pGraph->Create<Resource>(desc, name); }
+        void SkipCulling()
+        {
+            if (m_pSubgraph)
+            {
+                m_pSubgraph->SkipCulling(m_subgraphPass);
+            }
+            else if (m_pRecorder)
+            {
+                m_pRecorder->SkipCulling(m_recorderPass);
+            }
+            else
+            {
+                m_pPass->MakeTarget();
+            }
+        }
 
-        RGHandle Import(IGfxTexture* texture, ngfx::GfxAccess::Flags state) { return m_pGraph->Import(texture, state); }
+        template <typename Resource> RGHandle Create(const typename Resource::Desc& desc, const nstring::str_t const* name)
+        {
+            if (m_pSubgraph)
+            {
+                return m_pSubgraph->Create<Resource>(desc, name);
+            }
+            if (m_pRecorder)
+            {
+                return m_pRecorder->Create<Resource>(desc, name);
+            }
+            return m_pGraph->Create<Resource>(desc, name);
+        }
 
-        RGHandle Read(const RGHandle& input, ngfx::GfxAccess::Flags usage, u32 subresource)
+        // the following resources only exist in the render graph and are created on its recording thread,
+        // a subgraph receives them through its inputs and a recorder through handles created before it
+        RGHandle Import(IGfxTexture* texture, ngfx::GfxAccess::Flags state)
+        {
+            ASSERT(m_pSubgraph == nullptr && m_pRecorder == nullptr);
+            return m_pGraph->Import(texture, state);
+        }
+
+        RGHandle Import(u32 id)
+        {
+            ASSERT(m_pSubgraph == nullptr && m_pRecorder == nullptr);
+            return m_pGraph->Import(id);
+        }
+
+        RGHandle CreateHistory(const RGTexture::Desc& desc, cpstr_t name, u32 frames_ago, u32 history_length = 2)
+        {
+            ASSERT(m_pSubgraph == nullptr && m_pRecorder == nullptr);
+            return m_pGraph->CreateHistory(desc, name, frames_ago, history_length);
+        }
+
+        RGHandle CreateUploadBuffer(u32 size, cpstr_t name, void*& cpu_address)
+        {
+            ASSERT(m_pSubgraph == nullptr && m_pRecorder == nullptr);
+            return m_pGraph->CreateUploadBuffer(size, name, cpu_address);
+        }
+
+        RGHandle CreateReadbackBuffer(u32 size, cpstr_t name)
+        {
+            ASSERT(m_pSubgraph == nullptr && m_pRecorder == nullptr);
+            return m_pGraph->CreateReadbackBuffer(size, name);
+        }
+
+        RGHandle Read(const RGHandle& input, ngfx::GfxAccess::Flags usage, u32 subresource, RGShaderStage stages = RGShaderStage::None)
         {
             ASSERT(usage & (GfxAccessMaskSRV | GfxAccessIndirectArgs | GfxAccessCopySrc));
 
             ASSERT(GFX_ALL_SUB_RESOURCE != subresource); // RG doesn't support GFX_ALL_SUB_RESOURCE currently
 
-            return m_pGraph->Read(m_pPass, input, usage, subresource);
+            if (m_pSubgraph)
+            {
+                return m_pSubgraph->Read(m_subgraphPass, input, usage, subresource, stages);
+            }
+            if (m_pRecorder)
+            {
+                return m_pRecorder->Read(m_recorderPass, input, usage, subresource, stages);
+            }
+            return m_pGraph->Read(m_pPass, input, usage, subresource, stages);
+        }
+
+        // reads in exactly 'stages', eg. RGShaderStage::Mesh | RGShaderStage::Pixel, so barriers only wait for those stages
+        RGHandle Read(const RGHandle& input, RGShaderStage stages, u32 subresource = 0)
+        {
+            ASSERT(IsValidStages(stages, false));
+            return Read(input, RGGetReadState(stages), subresource, stages);
         }
 
         RGHandle Read(const RGHandle& input, u32 subresource = 0, RGBuilderFlag flag = RGBuilderFlag::None)
         {
             ngfx::GfxAccess::Flags state;
 
-            switch (m_pPass->GetType())
+            switch (m_type)
             {
                 case RenderPassType::Graphics:
-                    if (flag == RGBuilderFlag::ShaderStagePS)
+                    if (HasFlag(flag, RGBuilderFlag::ShaderStagePS))
                     {
                         state = ngfx::GfxAccess::PixelShaderSRV;
                     }
-                    else if (flag == RGBuilderFlag::ShaderStageNonPS)
+                    else if (HasFlag(flag, RGBuilderFlag::ShaderStageNonPS))
                     {
                         state = ngfx::GfxAccess::VertexShaderSRV;
                     }
@@ -67,27 +159,44 @@ namespace ncore
 
         RGHandle ReadIndirectArg(const RGHandle& input, u32 subresource = 0) { return Read(input, ngfx::GfxAccess::IndirectArgs, subresource); }
 
-        RGHandle Write(const RGHandle& input, ngfx::GfxAccess::Flags usage, u32 subresource)
+        RGHandle Write(const RGHandle& input, ngfx::GfxAccess::Flags usage, u32 subresource, RGBuilderFlag flag = RGBuilderFlag::None, RGShaderStage stages = RGShaderStage::None)
         {
             ASSERT(usage & (GfxAccessMaskUAV | GfxAccessCopyDst));
 
             ASSERT(GFX_ALL_SUB_RESOURCE != subresource); // RG doesn't support GFX_ALL_SUB_RESOURCE currently
 
-            return m_pGraph->Write(m_pPass, input, usage, subresource);
+            bool non_overlapping = HasFlag(flag, RGBuilderFlag::NonOverlappingWrites);
+            bool full_coverage   = HasFlag(flag, RGBuilderFlag::FullCoverageWrite);
+
+            if (m_pSubgraph)
+            {
+                return m_pSubgraph->Write(m_subgraphPass, input, usage, subresource, non_overlapping, stages, full_coverage);
+            }
+            if (m_pRecorder)
+            {
+                return m_pRecorder->Write(m_recorderPass, input, usage, subresource, non_overlapping, stages, full_coverage);
+            }
+            return m_pGraph->Write(m_pPass, input, usage, subresource, non_overlapping, stages, full_coverage);
+        }
+
+        RGHandle Write(const RGHandle& input, RGShaderStage stages, u32 subresource = 0, RGBuilderFlag flag = RGBuilderFlag::None)
+        {
+            ASSERT(IsValidStages(stages, true));
+            return Write(input, RGGetWriteState(stages), subresource, flag, stages);
         }
 
         RGHandle Write(const RGHandle& input, u32 subresource = 0, RGBuilderFlag flag = RGBuilderFlag::None)
         {
             ngfx::GfxAccess::Flags state;
 
-            switch (m_pPass->GetType())
+            switch (m_type)
             {
                 case RenderPassType::Graphics:
-                    if (flag == RGBuilderFlag::ShaderStagePS)
+                    if (HasFlag(flag, RGBuilderFlag::ShaderStagePS))
                     {
                         state = ngfx::GfxAccess::PixelShaderUAV;
                     }
-                    else if (flag == RGBuilderFlag::ShaderStageNonPS)
+                    else if (HasFlag(flag, RGBuilderFlag::ShaderStageNonPS))
                     {
                         state = ngfx::GfxAccess::VertexShaderUAV;
                     }
@@ -101,40 +210,102 @@ namespace ncore
                 case RenderPassType::Copy: state = ngfx::GfxAccess::CopyDst; break;
                 default: ASSERT(false); break;
             }
-            return Write(input, state, subresource);
+            return Write(input, state, subresource, flag);
         }
 
-        RGHandle WriteColor(u32 color_index, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, float4 clear_color = float4(0.0f, 0.0f, 0.0f, 1.0f))
+        // with RGBuilderFlag::FullCoverageWrite the load op is a hint, Compile turns it into DontCare
+        RGHandle WriteColor(u32 color_index, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, float4 clear_color = float4(0.0f, 0.0f, 0.0f, 1.0f), RGBuilderFlag flag = RGBuilderFlag::None)
         {
-            ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
-            return m_pGraph->WriteColor(m_pPass, color_index, input, subresource, load_op, clear_color);
+            ASSERT(m_type == RenderPassType::Graphics);
+
+            bool full_coverage = HasFlag(flag, RGBuilderFlag::FullCoverageWrite);
+
+            if (m_pSubgraph)
+            {
+                return m_pSubgraph->WriteColor(m_subgraphPass, color_index, input, subresource, load_op, clear_color, full_coverage);
+            }
+            if (m_pRecorder)
+            {
+                return m_pRecorder->WriteColor(m_recorderPass, color_index, input, subresource, load_op, clear_color, full_coverage);
+            }
+            return m_pGraph->WriteColor(m_pPass, color_index, input, subresource, load_op, clear_color, full_coverage);
         }
 
         RGHandle WriteDepth(const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, float clear_depth = 0.0f)
         {
-            ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
-            return m_pGraph->WriteDepth(m_pPass, input, subresource, depth_load_op, ngfx::GfxRenderPass::LoadDontCare, clear_depth, 0);
+            return WriteDepth(input, subresource, depth_load_op, ngfx::GfxRenderPass::LoadDontCare, clear_depth, 0);
         }
 
-        RGHandle WriteDepth(const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth = 0.0f, u32 clear_stencil = 0)
+        // full coverage only covers the depth, the stencil load op is kept as the pass may test stencil it doesn't write
+        RGHandle WriteDepth(const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth = 0.0f, u32 clear_stencil = 0,
+                            RGBuilderFlag flag = RGBuilderFlag::None)
         {
-            ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
-            return m_pGraph->WriteDepth(m_pPass, input, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
+            ASSERT(m_type == RenderPassType::Graphics);
+
+            bool full_coverage = HasFlag(flag, RGBuilderFlag::FullCoverageWrite);
+
+            if (m_pSubgraph)
+            {
+                return m_pSubgraph->WriteDepth(m_subgraphPass, input, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil, full_coverage);
+            }
+            if (m_pRecorder)
+            {
+                return m_pRecorder->WriteDepth(m_recorderPass, input, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil, full_coverage);
+            }
+            return m_pGraph->WriteDepth(m_pPass, input, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil, full_coverage);
         }
 
         RGHandle ReadDepth(const RGHandle& input, u32 subresource)
         {
-            ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
+            ASSERT(m_type == RenderPassType::Graphics);
+            if (m_pSubgraph)
+            {
+                return m_pSubgraph->ReadDepth(m_subgraphPass, input, subresource);
+            }
+            if (m_pRecorder)
+            {
+                return m_pRecorder->ReadDepth(m_recorderPass, input, subresource);
+            }
             return m_pGraph->ReadDepth(m_pPass, input, subresource);
         }
 
+        // see RenderGraph::EnableAsyncComputePromotion, only for passes added to the render graph directly
+        void SetCostHint(u64 cost)
+        {
+            ASSERT(m_pSubgraph == nullptr && m_pRecorder == nullptr);
+            m_pPass->SetCostHint(cost);
+        }
+
     private:
+        // the stages a pass of this type can access a resource in, indirect arguments are only read
+        bool IsValidStages(RGShaderStage stages, bool write) const
+        {
+            if (write && HasStage(stages, RGShaderStage::Indirect))
+            {
+                return false;
+            }
+
+            switch (m_type)
+            {
+                case RenderPassType::Graphics: return stages != RGShaderStage::None && (stages & (RGShaderStage::Graphics | RGShaderStage::Indirect)) == stages;
+                case RenderPassType::Compute:
+                case RenderPassType::AsyncCompute: return stages != RGShaderStage::None && (stages & (RGShaderStage::Compute | RGShaderStage::Indirect)) == stages;
+                case RenderPassType::Copy: return stages == RGShaderStage::Copy;
+                default: return false;
+            }
+        }
+
         RGBuilder(RGBuilder const&)            = delete;
         RGBuilder& operator=(RGBuilder const&) = delete;
 
     private:
-        RenderGraph*         m_pGraph = nullptr;
-        RenderGraphPassBase* m_pPass  = nullptr;
+        RenderGraph*         m_pGraph       = nullptr;
+        RenderGraphPassBase* m_pPass        = nullptr;
+        RenderGraphSubgraph* m_pSubgraph    = nullptr;
+        u32                  m_subgraphPass = 0;
+        RenderGraphRecorder* m_pRecorder    = nullptr;
+        u32                  m_recorderPass = 0;
+        RenderPassType       m_type;
     };
 } // namespace ncore
 #endif
@@ -0,0 +1,88 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_CACHE_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_CACHE_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "crendergraph/render_graph_resource_allocator.h"
+
+namespace ncore
+{
+    // fnv-1a, the structural hash of a graph is built from the raw values of its passes, resources and edges
+    inline u64 RGHashBytes(const void* data, u32 size, u64 hash = 14695981039346656037ull)
+    {
+        const u8* bytes = (const u8*)data;
+        for (u32 i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+    // scalars only, the padding of a struct is undefined and would make equal structures hash differently
+    template <typename T> inline u64 RGHashValue(const T& value, u64 hash) { return RGHashBytes(&value, sizeof(T), hash); }
+
+    // the result of Compile that only depends on the structure of the graph. Everything is plain data addressed by
+    // offsets from the start of the blob, so a cache file can be used straight from a mapped file.
+    struct RGCompiledGraphHeader
+    {
+        static const u32 Magic   = 0x47435247; // "RGCG"
+        static const u32 Version = 4;
+
+        u32 magic;
+        u32 version;
+        u64 hash; // structural hash of the graph it was saved from
+        u32 size; // of the whole blob
+        u32 numPasses;
+        u32 numResources;
+        u32 numHeaps;
+        u32 passOffset;
+        u32 resourceOffset;
+        u32 heapOffset;
+        u8  graphicsConstantsPending;
+        u8  pad[3];
+    };
+
+    struct RGCompiledPass
+    {
+        static const u32 InvalidIndex = 0xFFFFFFFF;
+
+        u64 signalValue;
+        u64 waitValue;
+        u32 waitGraphicsPass; // pass indices of the async compute sync points
+        u32 signalGraphicsPass;
+        u8  culled;
+        u8  submitBeforeWait;
+        u8  setupGlobalConstants;
+        u8  asyncPromoted; // a Compute pass the promotion moved to the async compute queue
+    };
+
+    struct RGCompiledResource
+    {
+        u32 firstPass; // pass indices, RGCompiledPass::InvalidIndex when the resource is not used
+        u32 lastPass;
+        u32 lastState;
+        u32 pad;
+    };
+
+    class RenderGraphCompiledGraph
+    {
+    public:
+        static u32 GetSize(u32 num_passes, u32 num_resources, u32 num_heaps);
+
+        // lays out the header and the offsets of the arrays, 'data' holds at least GetSize bytes
+        static RGCompiledGraphHeader* Init(void* data, u64 hash, u32 num_passes, u32 num_resources, u32 num_heaps);
+
+        // checks the format and that every array lies inside the blob, nullptr when it can't be used
+        static const RGCompiledGraphHeader* Validate(const void* data, u32 size);
+
+        static RGCompiledPass*     GetPasses(RGCompiledGraphHeader* header) { return (RGCompiledPass*)((u8*)header + header->passOffset); }
+        static RGCompiledResource* GetResources(RGCompiledGraphHeader* header) { return (RGCompiledResource*)((u8*)header + header->resourceOffset); }
+        static RenderGraphResourceAllocator::HeapLayout* GetHeaps(RGCompiledGraphHeader* header) { return (RenderGraphResourceAllocator::HeapLayout*)((u8*)header + header->heapOffset); }
+
+        static const RGCompiledPass*     GetPasses(const RGCompiledGraphHeader* header) { return (const RGCompiledPass*)((const u8*)header + header->passOffset); }
+        static const RGCompiledResource* GetResources(const RGCompiledGraphHeader* header) { return (const RGCompiledResource*)((const u8*)header + header->resourceOffset); }
+        static const RenderGraphResourceAllocator::HeapLayout* GetHeaps(const RGCompiledGraphHeader* header) { return (const RenderGraphResourceAllocator::HeapLayout*)((const u8*)header + header->heapOffset); }
+    };
+} // namespace ncore
+#endif
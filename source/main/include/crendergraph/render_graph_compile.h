@@ -0,0 +1,82 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_COMPILE_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_COMPILE_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "cgfx/gfx_defines.h"
+#include "crendergraph/render_graph_stage.h"
+
+namespace ncore
+{
+    // the steps of RenderGraph::Compile that only need plain data. They work on arrays the caller owns,
+    // so they run without a device or a graph and the render graph keeps its traversal.
+
+    static const u32 RGNoDependency = 0xFFFFFFFF;
+
+    // 'dependencies' are 'num_dependencies' pairs of pass indices (earlier, later), in the order of the later pass.
+    // Writes the earliest 'level' of every pass, the 'latest' level it could move to and the 'critical' dependency
+    // that sets its level (RGNoDependency when there is none). Returns the number of levels.
+    // Passes marked in 'skipped' (optional) take no level, eg. folded clear passes. They may not appear in 'dependencies',
+    // their level and latest level are 0 and they don't count towards the number of levels.
+    u32 RGComputeDependencyLevels(u32 num_passes, const u32* dependencies, u32 num_dependencies, u32* level, u32* latest, u32* critical, const u8* skipped = nullptr);
+
+    // the chain of critical dependencies back from the last pass of the deepest level, written to 'path' in execution
+    // order. 'path' has room for 'num_levels' passes, returns the length of the path. A skipped pass is never the tail.
+    u32 RGGetCriticalPath(u32 num_passes, const u32* level, const u32* critical, u32 num_levels, u32* path, const u8* skipped = nullptr);
+
+    // a reader of a resource node, the reads of a node are in pass order
+    struct RGReadAccess
+    {
+        ngfx::GfxAccessFlags usage;
+        RGShaderStage        stages;
+        u32                  subresource;
+        u8                   queue;     // 0 = graphics, 1 = async compute
+        u8                   mergeable; // a read that can share its state with other reads
+        u8                   culled;    // the reading pass is culled, it neither joins nor breaks a run
+        u8                   merged;    // set for the reads of a run, 'state' and 'mergedStages' are only valid then
+        ngfx::GfxAccessFlags state;
+        RGShaderStage        mergedStages;
+    };
+
+    // consecutive mergeable reads of the same subresource on the same queue form a run, every read of a run gets the
+    // union of the states and stages of the run. A compute queue can't use graphics states, so runs don't cross queues.
+    void RGMergeReadStates(RGReadAccess* reads, u32 count);
+
+    // the events of a pass, its begin events are a range of the event stream
+    struct RGPassEvents
+    {
+        u32 firstEvent;
+        u16 numBeginEvents;
+        u16 numEndEvents;
+        u8  culled;
+    };
+
+    // culled passes are dropped from execution, the events they begin move to the next live pass and the events they end
+    // close after the previous live pass. An event that only encloses culled passes is dropped like an empty one.
+    // The begin ranges of live passes are rewritten to index 'live_stream', 'live_stream' and 'deferred' (scratch) need
+    // room for every event of 'stream'. Returns the number of events in the live stream.
+    u32 RGRebalanceEvents(RGPassEvents* passes, u32 num_passes, const u32* stream, u32* live_stream, u32* deferred);
+
+    inline bool RGIsLoad(ngfx::GfxRenderPass::LoadOp load_op) { return load_op != ngfx::GfxRenderPass::LoadClear && load_op != ngfx::GfxRenderPass::LoadDontCare; }
+
+    // what the write after a clear pass takes over from the clear, 'folded' is false when the clear pass has to stay
+    struct RGClearFold
+    {
+        bool folded;
+        bool loadOp;        // the color or depth load op and clear value
+        bool stencilLoadOp; // the stencil load op and clear value
+    };
+
+    // the clear and the write access the same subresource, the load ops are those of the write (color or depth, stencil).
+    // The same kind of attachment or a full coverage write can take a clear over, a full coverage depth write only covers
+    // the depth, so its stencil still takes over the stencil clear.
+    RGClearFold RGFoldClear(ngfx::GfxAccessFlags clear_usage, ngfx::GfxAccessFlags write_usage, bool full_coverage, ngfx::GfxRenderPass::LoadOp load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op);
+
+    // the order the recorders of a frame are merged in, 'order' gets the indices of 'sort_keys' sorted by key. Equal keys
+    // keep the order the recorders were created in.
+    void RGSortMergeOrder(const u32* sort_keys, u32 count, u32* order);
+} // namespace ncore
+
+#endif
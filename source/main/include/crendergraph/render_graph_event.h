@@ -0,0 +1,33 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_EVENT_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_EVENT_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+// event markers only exist in debug builds unless the build config asks for them
+#ifndef RENDER_GRAPH_EVENTS
+#    ifdef TARGET_DEBUG
+#        define RENDER_GRAPH_EVENTS 1
+#    else
+#        define RENDER_GRAPH_EVENTS 0
+#    endif
+#endif
+
+namespace ncore
+{
+    // fnv-1a, bind the result to a constexpr variable (see RENDER_GRAPH_EVENT) so it is evaluated by the compiler
+    constexpr u32 RGEventHash(const char* str, u32 hash = 2166136261u) { return *str ? RGEventHash(str + 1, (hash ^ (u32)(u8)*str) * 16777619u) : hash; }
+
+#if RENDER_GRAPH_EVENTS
+    // side table that resolves event ids to their names, a name is registered once per call site. Debug builds assert
+    // when two different names hash to the same id.
+    class RenderGraphEventTable
+    {
+    public:
+        static u32         Register(u32 id, const char* name);
+        static const char* GetName(u32 id);
+    };
+#endif
+} // namespace ncore
+#endif
@@ -11,6 +11,7 @@ namespace ncore
     {
         u16 index = u16(-1);
         u16 node  = u16(-1);
+        u16 scope = 0; // 0 for the render graph, otherwise the recorder that returned the handle, see RenderGraphRecorder
         bool IsValid() const { return index != u16(-1) && node != u16(-1); }
     };
 } // namespace ncore
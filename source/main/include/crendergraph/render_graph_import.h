@@ -0,0 +1,50 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_IMPORT_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_IMPORT_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "cdag/c_dag.h"
+#include "cgfx/gfx_defines.h"
+#include "crendergraph/render_graph_handle.h"
+
+namespace ncore
+{
+    class IGfxResource;
+    struct RenderGraphFrame;
+
+    // external textures and buffers registered with the render graph, see RenderGraph::RegisterImport. An entry keeps
+    // the state the last compiled frame left its resource in, the ids of unregistered entries are handed out again.
+    class RenderGraphImportRegistry
+    {
+    public:
+        struct Entry
+        {
+            IGfxResource*        resource; // nullptr for a free entry
+            ngfx::GfxAccessFlags state;    // where the last compiled frame left it
+            u64                  frame;    // the frame 'handle' belongs to
+            RGHandle             handle;
+            u32                  nextFree;
+            bool                 texture;
+        };
+
+        u32  Register(IGfxResource* resource, ngfx::GfxAccessFlags state, bool texture);
+        void Unregister(u32 id);
+
+        Entry&       Get(u32 id) { return m_entries[id]; }
+        const Entry& Get(u32 id) const { return m_entries[id]; }
+        bool         IsRegistered(u32 id) const { return id < (u32)m_entries.size() && m_entries[id].resource != nullptr; }
+
+        // called by Compile, the final or Present state of every registered import of 'frame' is the initial state of the
+        // next frame that imports it. Entries unregistered since the frame imported them are left alone.
+        void UpdateStates(const RenderGraphFrame& frame);
+
+    private:
+        static const u32 InvalidId = 0xFFFFFFFF;
+
+        vector_t<Entry> m_entries;
+        u32             m_firstFree = InvalidId;
+    };
+} // namespace ncore
+#endif
@@ -0,0 +1,52 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_JOB_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_JOB_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include <atomic>
+
+namespace ncore
+{
+    // hook into the job system of the application, the render graph uses it to spread the loops in Compile over worker threads
+    class IRenderGraphJobSystem
+    {
+    public:
+        virtual ~IRenderGraphJobSystem() {}
+
+        // calls 'job' for every chunk of [0, count), the calling thread may take part, returns once all chunks are done
+        virtual void ParallelFor(u32 count, u32 chunk_size, void (*job)(u32 begin, u32 end, void* context), void* context) = 0;
+    };
+
+    // the render graph only holds a lock for short bookkeeping, so spinning is cheaper than going to the OS
+    class RenderGraphSpinLock
+    {
+    public:
+        void Lock()
+        {
+            while (m_flag.test_and_set(std::memory_order_acquire))
+            {
+            }
+        }
+        void Unlock() { m_flag.clear(std::memory_order_release); }
+
+    private:
+        std::atomic_flag m_flag = ATOMIC_FLAG_INIT;
+    };
+
+    class RenderGraphScopedLock
+    {
+    public:
+        RenderGraphScopedLock(RenderGraphSpinLock& lock)
+            : m_lock(lock)
+        {
+            m_lock.Lock();
+        }
+        ~RenderGraphScopedLock() { m_lock.Unlock(); }
+
+    private:
+        RenderGraphSpinLock& m_lock;
+    };
+} // namespace ncore
+#endif
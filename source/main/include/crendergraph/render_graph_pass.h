@@ -8,6 +8,11 @@
 #include "cdag/c_dag.h"
 #include "callocator/c_allocator_string.h"
 #include "cgfx/gfx_defines.h"
+#include "crendergraph/render_graph_barrier_stats.h"
+#include "crendergraph/render_graph_cache.h"
+#include "crendergraph/render_graph_event.h"
+#include "crendergraph/render_graph_stage.h"
+#include "crendergraph/render_graph_timing.h"
 
 namespace ncore
 {
@@ -16,6 +21,7 @@ namespace ncore
     class RenderGraphResource;
     class RenderGraphEdgeColorAttchment;
     class RenderGraphEdgeDepthAttchment;
+    class RGSubgraphInstance;
 
     class IGfxCommandList;
     class IGfxCommandList;
@@ -39,6 +45,13 @@ namespace ncore
         u64                graphicsFence = 0;
     };
 
+    // per queue (0 = graphics, 1 = async compute), simulates the command lists to plan the submits of a frame
+    struct RenderGraphSubmitPlanContext
+    {
+        bool dirty[2]            = {true, true}; // the caller may have recorded into both lists before Execute
+        bool constantsPending[2] = {false, false};
+    };
+
     struct RenderGraphPassExecuteContext
     {
         Renderer*        renderer;
@@ -59,34 +72,120 @@ namespace ncore
     public:
         RenderGraphPassBase(cpstr_t name, RenderPassType type, DirectedAcyclicGraph& graph);
 
-        void ResolveBarriers(const DirectedAcyclicGraph& graph);
+        void ResolveBarriers(const DirectedAcyclicGraph& graph, bool analyze = false);
         void ResolveAsyncCompute(const DirectedAcyclicGraph& graph, RenderGraphAsyncResolveContext& context);
+        void PlanSubmit(RenderGraphSubmitPlanContext& context);
+
+        // the queue sync and submit plan in pass indices, LoadCompiled replaces ResolveAsyncCompute and PlanSubmit
+        void SaveCompiled(const DirectedAcyclicGraph& graph, RGCompiledPass& record) const;
+        void LoadCompiled(const RGCompiledPass& record, RenderGraphPassBase* const* passes);
         void Execute(const RenderGraph& graph, RenderGraphPassExecuteContext& context);
 
         // virtual cpstr_t GetGraphvizName() const override { return m_name.c_str(); }
         // virtual const char*   GetGraphvizColor() const override { return !IsCulled() ? "darkgoldenrod1" : "darkgoldenrod4"; }
 
-        void BeginEvent(const nstring::str_t const* name) { m_eventNames.push_back(name); }
-        void EndEvent() { m_nEndEventNum++; }
+#if RENDER_GRAPH_EVENTS
+        void SetBeginEvents(u32 first, u32 count)
+        {
+            m_firstEvent   = first;
+            m_nBeginEvents = (u16)count;
+        }
+        void EndEvent() { m_nEndEvents++; }
+        u32  GetFirstEvent() const { return m_firstEvent; }
+        u32  GetNumBeginEvents() const { return m_nBeginEvents; }
+        u32  GetNumEndEvents() const { return m_nEndEvents; }
+        void SetEndEvents(u32 count) { m_nEndEvents = (u16)count; }
+#endif
 
         RenderPassType GetType() const { return m_type; }
+        bool           IsAsyncPromoted() const { return m_bAsyncPromoted; }
+        void           PromoteToAsyncCompute()
+        {
+            ASSERT(m_type == RenderPassType::Compute);
+            m_type           = RenderPassType::AsyncCompute;
+            m_bAsyncPromoted = true;
+        }
+        bool HasPrecompiledStates() const { return !m_precompiledStates.empty(); }
+
+        // standalone clear, see RenderGraph::AddClearPass. A folded clear pass only emits its barriers, the next pass clears.
+        bool IsClearPass() const { return m_bClearPass; }
+        void SetClearPass() { m_bClearPass = true; }
+        bool IsFolded() const { return m_bFolded; }
+        void Fold()
+        {
+            ASSERT(m_bClearPass);
+            m_bFolded = true;
+        }
+
+        // expected GPU cost of the pass for the async compute promotion, 0 leaves it to the cost function of the graph
+        u64  GetCostHint() const { return m_costHint; }
+        void SetCostHint(u64 cost) { m_costHint = cost; }
+        u32            GetIndex() const { return m_index; }
+        void           SetIndex(u32 index) { m_index = index; }
         DAGNode*       GetWaitGraphicsPassID() const { return m_waitGraphicsPass; }
+
+        // earliest dependency level of a live pass and how many levels later it could run without delaying the frame,
+        // a slack of 0 puts it on the critical path. Set by Compile.
+        u32  GetDependencyLevel() const { return m_dependencyLevel; }
+        u32  GetDependencySlack() const { return m_dependencySlack; }
+        void SetDependencyLevel(u32 level, u32 slack)
+        {
+            m_dependencyLevel = level;
+            m_dependencySlack = slack;
+        }
         DAGNode*       GetSignalGraphicsPassID() const { return m_signalGraphicsPass; }
 
+        // the barriers of the last ResolveBarriers, only recorded when it was asked to analyze them
+        const vector_t<RGBarrierRecord>& GetBarrierRecords() const { return m_barrierRecords; }
+
+        // state transition resolved up-front by a subgraph, only valid when 'prev_pass' survives culling
+        void AddPrecompiledState(RenderGraphResource* resource, u32 subresource, DAGNode* prev_pass, ngfx::GfxAccess::Flags old_state, RGShaderStage old_stages, bool uav_barrier)
+        {
+            m_precompiledStates.push_back({resource, subresource, prev_pass, old_state, old_stages, uav_barrier});
+        }
+
     private:
         void Begin(const RenderGraph& graph, IGfxCommandList* pCommandList);
         void End(IGfxCommandList* pCommandList);
 
         bool HasGfxRenderPass() const;
 
+        struct PrecompiledState
+        {
+            RenderGraphResource*   resource;
+            u32                    sub_resource;
+            DAGNode*               prev_pass;
+            ngfx::GfxAccess::Flags old_state;
+            RGShaderStage          old_stages;
+            bool                   uav_barrier;
+        };
+        const PrecompiledState* FindPrecompiledState(RenderGraphResource* resource, u32 subresource) const;
+
+        void AddBarrierRecord(DAGNode* prev_pass, RenderGraphResource* resource, IGfxResource* aliased, u32 subresource, ngfx::GfxAccess::Flags old_state, ngfx::GfxAccess::Flags new_state, RGShaderStage old_stages,
+                              RGShaderStage new_stages);
+
         virtual void ExecuteImpl(IGfxCommandList* pCommandList) = 0;
 
     protected:
         cpstr_t        m_name;
         RenderPassType m_type;
+        u32            m_index           = 0; // position in the pass list of the render graph
+        u32            m_dependencyLevel = 0;
+        u32            m_dependencySlack = 0;
+        u64            m_costHint        = 0;
+        bool           m_bAsyncPromoted  = false;
+        bool           m_bClearPass      = false;
+        bool           m_bFolded         = false;
 
-        vector_t<cpstr_t> m_eventNames;
-        u32               m_nEndEventNum = 0;
+#if RENDER_GRAPH_EVENTS
+        u32 m_firstEvent   = 0; // begin events are a range of the event stream of the render graph
+        u16 m_nBeginEvents = 0;
+        u16 m_nEndEvents   = 0;
+#endif
+
+#if RENDER_GRAPH_PASS_TIMINGS
+        u32 m_timingSlot = RenderGraphPassTimings::InvalidSlot; // looked up the first time the pass is timed
+#endif
 
         struct ResourceBarrier
         {
@@ -94,6 +193,8 @@ namespace ncore
             u32                    sub_resource;
             ngfx::GfxAccess::Flags old_state;
             ngfx::GfxAccess::Flags new_state;
+            RGShaderStage          old_stages;
+            RGShaderStage          new_stages;
         };
         vector_t<ResourceBarrier> m_resourceBarriers;
 
@@ -102,9 +203,14 @@ namespace ncore
             IGfxResource*          resource;
             ngfx::GfxAccess::Flags acess_before;
             ngfx::GfxAccess::Flags acess_after;
+            RGShaderStage          stages_before;
+            RGShaderStage          stages_after;
         };
         vector_t<AliasDiscardBarrier> m_discardBarriers;
 
+        vector_t<PrecompiledState> m_precompiledStates;
+        vector_t<RGBarrierRecord>  m_barrierRecords;
+
         RenderGraphEdgeColorAttchment* m_pColorRT[8] = {};
         RenderGraphEdgeDepthAttchment* m_pDepthRT    = nullptr;
 
@@ -114,6 +220,10 @@ namespace ncore
 
         u64 m_signalValue = -1;
         u64 m_waitValue   = -1;
+
+        // planned at compile time, a wait only needs its own submit when something was recorded since the last one
+        bool m_bSubmitBeforeWait     = false;
+        bool m_bSetupGlobalConstants = false;
     };
 
     template <class T> class RenderGraphPass : public RenderGraphPassBase
@@ -135,5 +245,25 @@ namespace ncore
         T                                                 m_parameters;
         eastl::function<void(const T&, IGfxCommandList*)> m_execute;
     };
+
+    template <class T> class RenderGraphSubgraphPass : public RenderGraphPassBase
+    {
+    public:
+        RenderGraphSubgraphPass(const nstring::str_t const* name, RenderPassType type, DirectedAcyclicGraph& graph, const T& parameters, const eastl::function<void(const T&, IGfxCommandList*, const RGSubgraphInstance&)>& execute, const RGSubgraphInstance* instance)
+            : RenderGraphPassBase(name, type, graph)
+        {
+            m_parameters = parameters;
+            m_execute    = execute;
+            m_pInstance  = instance;
+        }
+
+    private:
+        void ExecuteImpl(IGfxCommandList* pCommandList) override { m_execute(m_parameters, pCommandList, *m_pInstance); }
+
+    protected:
+        T                                                                            m_parameters;
+        eastl::function<void(const T&, IGfxCommandList*, const RGSubgraphInstance&)> m_execute;
+        const RGSubgraphInstance*                                                    m_pInstance;
+    };
 } // namespace ncore
 #endif
@@ -0,0 +1,173 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_RECORDER_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_RECORDER_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "cgfx/gfx_defines.h"
+#include "crendergraph/render_graph_pass.h"
+#include "crendergraph/render_graph_handle.h"
+#include "crendergraph/render_graph_resource.h"
+#include "crendergraph/render_graph_arena.h"
+
+namespace ncore
+{
+    class RenderGraph;
+    class RGBuilder;
+    struct float4;
+
+    class RenderGraphRecordedPassBase
+    {
+    public:
+        RenderGraphRecordedPassBase(cpstr_t name, RenderPassType type)
+            : m_name(name)
+            , m_type(type)
+        {
+        }
+        virtual ~RenderGraphRecordedPassBase() {}
+
+        RenderPassType GetType() const { return m_type; }
+
+        virtual RenderGraphPassBase* Instantiate(RenderGraph& graph) = 0;
+
+    protected:
+        cpstr_t        m_name;
+        RenderPassType m_type;
+    };
+
+    template <class T> class RenderGraphRecordedPass : public RenderGraphRecordedPassBase
+    {
+    public:
+        RenderGraphRecordedPass(cpstr_t name, RenderPassType type, const eastl::function<void(const T&, IGfxCommandList*)>& execute)
+            : RenderGraphRecordedPassBase(name, type)
+        {
+            m_execute = execute;
+        }
+
+        T& GetData() { return m_parameters; }
+
+        virtual RenderGraphPassBase* Instantiate(RenderGraph& graph) override;
+
+    protected:
+        T                                                 m_parameters;
+        eastl::function<void(const T&, IGfxCommandList*)> m_execute;
+    };
+
+    // records passes on a worker thread, everything goes to the arena of the recorder, nothing is shared with other
+    // threads. The render graph merges the recorders of a frame ordered by their sort key (then by creation), so the
+    // graph is the same whichever thread finished first. Handles returned by a recorder are resolved by the render
+    // graph once it was merged, a recorder may read what a recorder with a lower sort key produced.
+    class RenderGraphRecorder
+    {
+        friend class RGBuilder;
+        friend class RenderGraph;
+
+    public:
+        template <typename Data, typename Setup, typename Exec> RenderGraphRecordedPass<Data>& AddPass(cpstr_t name, RenderPassType type, const Setup& setup, const Exec& execute);
+
+        u32  GetSortKey() const { return m_sortKey; }
+        bool IsMerged() const { return m_bMerged; }
+
+    private:
+        // block size of the arena of a recorder, recorders are pooled per frame slot so it is created once
+        static const u32 ArenaSize = 256 * 1024;
+
+        RenderGraphRecorder();
+        ~RenderGraphRecorder();
+
+        void Reset();
+
+        template <typename T, typename... ArgsT> T* Allocate(ArgsT&&... arguments);
+
+        template <typename Resource> RGHandle Create(const typename Resource::Desc& desc, cpstr_t name) { return AddResource(desc, name); }
+
+        RGHandle AddResource(const RGTexture::Desc& desc, cpstr_t name);
+        RGHandle AddResource(const RGBuffer::Desc& desc, cpstr_t name);
+        RGHandle AddNode();
+
+        RGHandle Read(u32 pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, RGShaderStage stages);
+        RGHandle Write(u32 pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, bool non_overlapping, RGShaderStage stages, bool full_coverage);
+
+        RGHandle WriteColor(u32 pass, u32 color_index, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, const float4& clear_color, bool full_coverage);
+        RGHandle WriteDepth(u32 pass, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth, u32 clear_stencil, bool full_coverage);
+        RGHandle ReadDepth(u32 pass, const RGHandle& input, u32 subresource);
+
+        void SkipCulling(u32 pass) { m_passes[pass].skip_culling = true; }
+
+        // the render graph handle of a local node, only valid after the merge
+        RGHandle Resolve(const RGHandle& handle) const
+        {
+            ASSERT(m_bMerged && handle.scope == m_scope);
+            return m_nodes[handle.node];
+        }
+
+    private:
+        static const u16 InvalidIndex = 0xFFFF;
+
+        enum class OpType : u8
+        {
+            Read,
+            Write,
+            WriteColor,
+            WriteDepth,
+            ReadDepth,
+        };
+
+        struct Op
+        {
+            OpType                      type;
+            RGHandle                    input; // a render graph handle or a local one
+            u16                         output_node;
+            ngfx::GfxAccessFlags        usage;
+            RGShaderStage               stages; // resolved from the usage when the builder passed none
+            u32                         subresource;
+            u32                         color_index;
+            ngfx::GfxRenderPass::LoadOp load_op;
+            ngfx::GfxRenderPass::LoadOp stencil_load_op;
+            float                       clear_color[4];
+            float                       clear_depth;
+            u32                         clear_stencil;
+            bool                        non_overlapping;
+            bool                        full_coverage;
+        };
+
+        struct Resource
+        {
+            u16             node; // local node of version 0
+            bool            texture;
+            RGTexture::Desc texture_desc;
+            RGBuffer::Desc  buffer_desc;
+            cpstr_t         name;
+        };
+
+        struct Pass
+        {
+            RenderGraphRecordedPassBase* proto;
+            u32                          first_op;
+            u32                          num_ops;
+            bool                         skip_culling;
+        };
+
+        struct ObjFinalizer
+        {
+            void* obj;
+            void (*finalizer)(void*);
+        };
+
+        RGHandle PushOp(u32 pass, const Op& op, bool write);
+
+        RenderGraphArena*      m_allocator = nullptr;
+        vector_t<ObjFinalizer> m_objFinalizer;
+
+        vector_t<Resource> m_resources;
+        vector_t<RGHandle> m_nodes; // local node -> render graph handle, filled in by the merge
+        vector_t<Op>       m_ops;
+        vector_t<Pass>     m_passes;
+
+        u16  m_scope   = 0;
+        u32  m_sortKey = 0;
+        bool m_bMerged = false;
+    };
+} // namespace ncore
+#endif
@@ -8,6 +8,7 @@
 #include "cdag/c_dag.h"
 #include "callocator/c_allocator_string.h"
 #include "cgfx/gfx_defines.h"
+#include "crendergraph/render_graph_stage.h"
 
 namespace ncore
 {
@@ -26,16 +27,22 @@ namespace ncore
         virtual ~RenderGraphResource() {}
 
         virtual void                 Resolve(RenderGraphEdge* edge, RenderGraphPassBase* pass);
+        virtual void                 PrepareRealize() {} // work that doesn't touch shared allocator state, may run on a worker thread
         virtual void                 Realize()         = 0;
         virtual IGfxResource*        GetResource()     = 0;
         virtual ngfx::GfxAccessFlags GetInitialState() = 0;
 
         cpstr_t  GetName() const { return m_name; }
+        u32      GetIndex() const { return m_index; }
+        void     SetIndex(u32 index) { m_index = index; }
         DAGNode* GetFirstPassID() const { return m_firstPass; }
         DAGNode* GetLastPassID() const { return m_lastPass; }
 
         bool IsUsed() const { return m_firstPass != UINT32_MAX; }
         bool IsImported() const { return m_bImported; }
+        bool IsHistory() const { return m_bHistory; }
+        bool IsReadback() const { return m_bReadback; }
+        bool IsPersistent() const { return m_bHistory || m_bReadback; }
 
         ngfx::GfxAccessFlags GetFinalState() const { return m_lastState; }
         virtual void         SetFinalState(ngfx::GfxAccessFlags state) { m_lastState = state; }
@@ -43,20 +50,56 @@ namespace ncore
         bool IsOutput() const { return m_bOutput; }
         void SetOutput(bool value) { m_bOutput = value; }
 
-        bool IsOverlapping() const { return !IsImported() && !IsOutput(); }
-
-        virtual IGfxResource* GetAliasedPrevResource(ngfx::GfxAccessFlags& lastUsedState)                                                                  = 0;
-        virtual void          Barrier(IGfxCommandList* pCommandList, u32 subresource, ngfx::GfxAccessFlags acess_before, ngfx::GfxAccessFlags acess_after) = 0;
+        virtual bool IsOverlapping() const { return !IsImported() && !IsOutput() && !IsHistory(); }
+
+        // folds what the resource is created from into the structural hash of the graph
+        virtual u64 HashDesc(u64 hash) const;
+
+        // lifetime already known from a compiled subgraph, Resolve is skipped unless culling invalidates it
+        bool IsPreResolved() const { return m_bPreResolved; }
+        void SetPreResolved(DAGNode* first_pass, DAGNode* last_pass, ngfx::GfxAccessFlags last_state)
+        {
+            m_firstPass    = first_pass;
+            m_lastPass     = last_pass;
+            m_lastState    = last_state;
+            m_bPreResolved = true;
+        }
+        void ResetPreResolved()
+        {
+            m_firstPass    = UINT32_MAX;
+            m_lastPass     = 0;
+            m_lastState    = GfxAccessDiscard;
+            m_bPreResolved = false;
+        }
+
+        // the resource placed in the same heap memory before this one. Compile resolves it for all resources after they
+        // are realized and before the barriers are resolved in parallel, the barrier jobs only read the result.
+        virtual void  ResolveAliasing() = 0;
+        IGfxResource* GetAliasedPrevResource(ngfx::GfxAccessFlags& lastUsedState) const
+        {
+            lastUsedState = m_aliasedPrevState;
+            return m_pAliasedPrev;
+        }
+
+        // the stages go to the backend with the states, a backend without stage aware barriers ignores them
+        virtual void Barrier(IGfxCommandList* pCommandList, u32 subresource, ngfx::GfxAccessFlags acess_before, ngfx::GfxAccessFlags acess_after, RGShaderStage stages_before, RGShaderStage stages_after) = 0;
 
     protected:
         cpstr_t m_name;
+        u32     m_index = 0; // position in the resource list of the render graph
 
         DAGNode*             m_firstPass = UINT32_MAX;
         DAGNode*             m_lastPass  = 0;
         ngfx::GfxAccessFlags m_lastState = GfxAccessDiscard;
 
-        bool m_bImported = false;
-        bool m_bOutput   = false;
+        IGfxResource*        m_pAliasedPrev     = nullptr;
+        ngfx::GfxAccessFlags m_aliasedPrevState = GfxAccessDiscard;
+
+        bool m_bImported    = false;
+        bool m_bOutput      = false;
+        bool m_bHistory     = false;
+        bool m_bReadback    = false;
+        bool m_bPreResolved = false;
     };
 
     class RGTexture : public RenderGraphResource
@@ -66,25 +109,40 @@ namespace ncore
 
         RGTexture(RenderGraphResourceAllocator& allocator, cpstr_t name, const Desc& desc);
         RGTexture(RenderGraphResourceAllocator& allocator, IGfxTexture* texture, ngfx::GfxAccessFlags state);
+        RGTexture(RenderGraphResourceAllocator& allocator, cpstr_t name, const Desc& desc, u32 history_length, u32 frames_ago);
         ~RGTexture();
 
         IGfxTexture*    GetTexture() const { return m_pTexture; }
+        bool            IsHistoryValid() const { return m_bHistoryValid; } // false when a history slot has no content from 'frames_ago' yet
         IGfxDescriptor* GetSRV();
         IGfxDescriptor* GetUAV();
         IGfxDescriptor* GetUAV(u32 mip, u32 slice);
 
+        // bindless heap indices of the default views, stable for as long as the allocator keeps the underlying texture
+        u32 GetSRVIndex() { return GetSRV()->GetHeapIndex(); }
+        u32 GetUAVIndex() { return GetUAV()->GetHeapIndex(); }
+        u32 GetUAVIndex(u32 mip, u32 slice) { return GetUAV(mip, slice)->GetHeapIndex(); }
+
         virtual void                 Resolve(RenderGraphEdge* edge, RenderGraphPassBase* pass) override;
+        virtual void                 PrepareRealize() override;
         virtual void                 Realize() override;
         virtual IGfxResource*        GetResource() override { return m_pTexture; }
         virtual ngfx::GfxAccessFlags GetInitialState() override { return m_initialState; }
-        virtual void                 Barrier(IGfxCommandList* pCommandList, u32 subresource, ngfx::GfxAccessFlags acess_before, ngfx::GfxAccessFlags acess_after) override;
-        virtual IGfxResource*        GetAliasedPrevResource(ngfx::GfxAccessFlags& lastUsedState) override;
+        virtual void                 Barrier(IGfxCommandList* pCommandList, u32 subresource, ngfx::GfxAccessFlags acess_before, ngfx::GfxAccessFlags acess_after, RGShaderStage stages_before, RGShaderStage stages_after) override;
+        virtual void                 ResolveAliasing() override;
+        virtual u64                  HashDesc(u64 hash) const override;
 
     private:
         Desc                          m_desc;
         IGfxTexture*                  m_pTexture     = nullptr;
         ngfx::GfxAccessFlags          m_initialState = GfxAccessDiscard;
         RenderGraphResourceAllocator& m_allocator;
+
+        u32  m_allocationSize   = 0;
+        u32  m_historyLength    = 0;
+        u32  m_historyFramesAgo = 0;
+        bool m_bHistoryValid    = false;
+        u32  m_descriptorSet    = 0xFFFFFFFF;
     };
 
     class RGBuffer : public RenderGraphResource
@@ -94,24 +152,38 @@ namespace ncore
 
         RGBuffer(RenderGraphResourceAllocator& allocator, const nstring::str_t const* name, const Desc& desc);
         RGBuffer(RenderGraphResourceAllocator& allocator, IGfxBuffer* buffer, ngfx::GfxAccessFlags state);
+        RGBuffer(RenderGraphResourceAllocator& allocator, cpstr_t name, IGfxBuffer* staging, u32 offset, u32 size, ngfx::GfxAccessFlags state);
         ~RGBuffer();
 
         IGfxBuffer*     GetBuffer() const { return m_pBuffer; }
+        u32             GetOffset() const { return m_offset; }
+        u32             GetSize() const { return m_desc.size; }
+        bool            IsSubAllocated() const { return m_bSubAllocated; }
         IGfxDescriptor* GetSRV();
         IGfxDescriptor* GetUAV();
 
+        u32 GetSRVIndex() { return GetSRV()->GetHeapIndex(); }
+        u32 GetUAVIndex() { return GetUAV()->GetHeapIndex(); }
+
         virtual void                 Resolve(RenderGraphEdge* edge, RenderGraphPassBase* pass) override;
+        virtual void                 PrepareRealize() override;
         virtual void                 Realize() override;
         virtual IGfxResource*        GetResource() override { return m_pBuffer; }
         virtual ngfx::GfxAccessFlags GetInitialState() override { return m_initialState; }
-        virtual void                 Barrier(IGfxCommandList* pCommandList, u32 subresource, ngfx::GfxAccessFlags acess_before, ngfx::GfxAccessFlags acess_after) override;
-        virtual IGfxResource*        GetAliasedPrevResource(ngfx::GfxAccessFlags& lastUsedState) override;
+        virtual void                 Barrier(IGfxCommandList* pCommandList, u32 subresource, ngfx::GfxAccessFlags acess_before, ngfx::GfxAccessFlags acess_after, RGShaderStage stages_before, RGShaderStage stages_after) override;
+        virtual void                 ResolveAliasing() override;
+        virtual u64                  HashDesc(u64 hash) const override;
+        virtual bool                 IsOverlapping() const override { return RenderGraphResource::IsOverlapping() && !m_bSubAllocated; }
 
     private:
         Desc                          m_desc;
         IGfxBuffer*                   m_pBuffer      = nullptr;
         ngfx::GfxAccessFlags          m_initialState = GfxAccessDiscard;
         RenderGraphResourceAllocator& m_allocator;
+
+        u32  m_offset        = 0;
+        bool m_bSubAllocated = false;
+        u32  m_descriptorSet = 0xFFFFFFFF;
     };
 } // namespace ncore
 #endif
@@ -7,6 +7,7 @@
 
 #include "callocator/c_allocator_string.h"
 #include "cgfx/gfx_defines.h"
+#include "crendergraph/render_graph_job.h"
 
 namespace ncore
 {
@@ -19,10 +20,16 @@ namespace ncore
 
     class RenderGraphResourceAllocator
     {
+    public:
+        static const u32 InvalidDescriptorSet = 0xFFFFFFFF;
+
+    private:
+        // passes are numbered per frame, a frame can be compiled while the one before it still holds its resources
         struct LifetimeRange
         {
             u32 firstPass = UINT32_MAX;
             u32 lastPass  = 0;
+            u64 frame     = 0;
 
             void Reset()
             {
@@ -34,7 +41,7 @@ namespace ncore
             {
                 if (IsUsed())
                 {
-                    return firstPass <= other.lastPass && lastPass >= other.firstPass;
+                    return frame == other.frame && firstPass <= other.lastPass && lastPass >= other.firstPass;
                 }
                 else
                 {
@@ -47,13 +54,17 @@ namespace ncore
         {
             IGfxResource*          resource;
             LifetimeRange          lifetime;
+            LifetimeRange          lastLifetime; // lifetime in the frame it was last used, for compaction
             u64                    lastUsedFrame = 0;
             ngfx::GfxAccess::Flags lastUsedState = ngfx::GfxAccess::Discard;
+            u32                    descriptorSet = InvalidDescriptorSet;
         };
 
         struct Heap
         {
-            IGfxHeap* heap;
+            IGfxHeap*           heap;
+            ngfx::GfxMemoryType memoryType;
+            u32                 id; // unique for the lifetime of the allocator, heaps move around in the pool
             // vector_t<AliasedResource> resources;
             s32              resources_size;
             AliasedResource* resources;
@@ -97,31 +108,187 @@ namespace ncore
             ngfx::GfxUnorderedAccessViewDesc desc;
         };
 
+        // the default views of a pooled resource, they live as long as the resource so their bindless indices are stable across frames.
+        // A set of a ring region is taken by whichever sub-allocation comes at its position, the views are kept while the
+        // view desc stays the same.
+        struct DescriptorSet
+        {
+            IGfxDescriptor*                  srv;
+            IGfxDescriptor*                  uav;
+            ngfx::GfxShaderResourceViewDesc  srvDesc;
+            ngfx::GfxUnorderedAccessViewDesc uavDesc;
+            u32                              nextFree;
+        };
+
     public:
+        struct CompactionStats
+        {
+            u32   heapsBefore;
+            u32   heapsAfter;
+            u64   memoryBefore;
+            u64   memoryAfter;
+            float fragmentationBefore; // 1 - peak live bytes of the last frame / heap bytes
+            float fragmentationAfter;
+        };
+
+        struct HeapLayout
+        {
+            u64 size;
+            u32 memoryType; // ngfx::GfxMemoryType
+            u32 heap;       // id of the heap it was captured from, only meaningful for the allocator that captured it
+        };
+
+        // peak heap layout of a scenario (a level, a menu) and the placed resources that lived in the heaps,
+        // both arrays are plain data so a profile can be stored as is and replayed at the next load.
+        struct PlacedResourceProfile
+        {
+            u32                  heap; // index into AllocationProfile::heaps
+            u32                  texture;
+            ngfx::GfxTextureDesc textureDesc;
+            ngfx::GfxBufferDesc  bufferDesc;
+        };
+
+        struct AllocationProfile
+        {
+            vector_t<HeapLayout>            heaps;
+            vector_t<PlacedResourceProfile> resources;
+        };
+
         RenderGraphResourceAllocator(IGfxDevice* pDevice);
         ~RenderGraphResourceAllocator();
 
+        // end of frame housekeeping, the render graph calls it when a frame has been executed
         void Reset();
 
-        IGfxTexture* AllocateNonOverlappingTexture(const ngfx::GfxTextureDesc& desc, const nstring::str_t* name, ngfx::GfxAccess::Flags& initial_state);
-        void         FreeNonOverlappingTexture(IGfxTexture* texture, ngfx::GfxAccess::Flags state);
+        // the recorded frame the following allocations belong to, lifetimes of different frames never overlap
+        // as the frames execute in order, an earlier frame aliases in front of all passes of a later one.
+        // It also selects the history slots and the ring buffer region of the frame.
+        void SetLifetimeFrame(u64 frame) { m_lifetimeFrame = frame; }
+
+        // opt-in, between frames. Merges heaps whose placements never overlapped in the last frame and releases
+        // the emptied heaps, moved resources are recreated in their new heap. Heaps with a placement used by a
+        // pending frame are left alone. The replaced heaps and resources are deleted by a later Reset, once the
+        // frames in flight can't reference them anymore.
+        CompactionStats Compact();
+
+        // the most bytes live at the same time in a frame, placement i is live from 'first_pass[i]' to 'last_pass[i]'.
+        // The fragmentation Compact reports is 1 - this / heap bytes.
+        static u64 GetPeakLiveSize(const u32* first_pass, const u32* last_pass, const u64* size, u32 count);
+
+        // the heaps that exist right now, returns their count and writes at most 'max_count' of them
+        u32 GetHeapLayout(HeapLayout* layout, u32 max_count) const;
+
+        // creates the heaps of a saved layout up-front, so the first frames don't grow the pool one heap at a time.
+        // Existing heaps of the same memory type and at least the same size count towards the layout.
+        void ReserveHeaps(const HeapLayout* layout, u32 count);
+
+        // merges the current heaps into 'profile', call it at the end of frames of a scenario to keep the peak of each heap.
+        // Heaps are matched by their id, so compaction or a reorder of the pool doesn't mix up their entries.
+        void CaptureProfile(AllocationProfile& profile) const;
+
+        // the steps of CaptureProfile. A heap is matched by its id and keeps the larger size, a heap seen for the first
+        // time is appended, returns its index in 'profile.heaps'. A placed resource is added once per heap and desc.
+        static u32  AddProfileHeap(AllocationProfile& profile, const HeapLayout& layout);
+        static void AddProfileResource(AllocationProfile& profile, const PlacedResourceProfile& placed);
+
+        // creates the heaps, placed resources and their default bindless views of a profile. Meant for a loading thread
+        // ahead of the first frame, resources the pool already has are kept. Prewarmed resources count as used by the
+        // current frame, so they are not recycled before the render graph had a chance to pick them up.
+        void Prewarm(const AllocationProfile& profile);
+
+        // the allocation and free functions are safe to call from several threads, the placement of resources in heaps
+        // depends on the call order, so the render graph still realizes in a fixed order to get the same result every frame.
+        IGfxTexture* AllocateNonOverlappingTexture(const ngfx::GfxTextureDesc& desc, const nstring::str_t* name, ngfx::GfxAccess::Flags& initial_state, u32& descriptor_set);
+        void         FreeNonOverlappingTexture(IGfxTexture* texture, ngfx::GfxAccess::Flags state, u32 descriptor_set);
 
-        IGfxTexture* AllocateTexture(u32 firstPass, u32 lastPass, ngfx::GfxAccess::Flags lastState, const ngfx::GfxTextureDesc& desc, const nstring::str_t* name, ngfx::GfxAccess::Flags& initial_state);
-        IGfxBuffer*  AllocateBuffer(u32 firstPass, u32 lastPass, ngfx::GfxAccess::Flags lastState, const ngfx::GfxBufferDesc& desc, const nstring::str_t* name, ngfx::GfxAccess::Flags& initial_state);
+        // history textures persist across frames and ping-pong between 'history_length' slots, 'frames_ago' selects the slot
+        IGfxTexture* AllocateHistoryTexture(const ngfx::GfxTextureDesc& desc, const nstring::str_t* name, u32 history_length, u32 frames_ago, ngfx::GfxAccess::Flags& initial_state, bool& valid, u32& descriptor_set);
+        void         FreeHistoryTexture(IGfxTexture* texture, ngfx::GfxAccess::Flags state);
+
+        // the slot 'frames_ago' selects in 'frame', and whether a slot last written in 'written_frame' holds that content.
+        // A slot that was never written has 'written_frame' = UINT64_MAX.
+        static u32  GetHistorySlot(u64 frame, u32 history_length, u32 frames_ago);
+        static bool IsHistorySlotValid(u64 written_frame, u64 frame, u32 frames_ago);
+
+        u32          GetAllocationSize(const ngfx::GfxTextureDesc& desc) const;
+        IGfxTexture* AllocateTexture(u32 firstPass, u32 lastPass, ngfx::GfxAccess::Flags lastState, const ngfx::GfxTextureDesc& desc, u32 texture_size, const nstring::str_t* name, ngfx::GfxAccess::Flags& initial_state, u32& descriptor_set);
+        IGfxBuffer*  AllocateBuffer(u32 firstPass, u32 lastPass, ngfx::GfxAccess::Flags lastState, const ngfx::GfxBufferDesc& desc, const nstring::str_t* name, ngfx::GfxAccess::Flags& initial_state, u32& descriptor_set);
         void         Free(IGfxResource* resource, ngfx::GfxAccess::Flags state, bool set_state);
 
+        // small buffers are sub-allocated from a per-frame region of a ring buffer, returns nullptr when it doesn't fit.
+        // The n-th sub-allocation of a region gets the n-th descriptor set of the region, a frame that allocates the
+        // same buffers in the same order as the last frame on that region keeps its views and bindless indices.
+        IGfxBuffer* AllocateSubBuffer(const ngfx::GfxBufferDesc& desc, u32& offset, u32& descriptor_set);
+
+        // the placement in a region, 'offset' is into the whole buffer and 'alignment' is applied to it
+        static bool SubAllocateRegion(u32 region, u32 region_size, u32& region_offset, u32 size, u32 alignment, u32& offset);
+        u32         GetSubAllocationThreshold() const { return m_subAllocationThreshold; }
+        void        SetSubAllocationThreshold(u32 size) { m_subAllocationThreshold = size; }
+
         IGfxResource* GetAliasedPrevResource(IGfxResource* resource, u32 firstPass, ngfx::GfxAccess::Flags& lastUsedState);
 
         IGfxDescriptor* GetDescriptor(IGfxResource* resource, const ngfx::GfxShaderResourceViewDesc& desc);
         IGfxDescriptor* GetDescriptor(IGfxResource* resource, const ngfx::GfxUnorderedAccessViewDesc& desc);
 
+        // a released set is handed out again before a new one is added, so a pool that settles keeps its indices.
+        // Not locked, the allocation functions call them with the lock held.
+        u32  AllocateDescriptorSet();
+        void ReleaseDescriptorSet(u32 descriptor_set);
+
+        IGfxDescriptor* GetBindlessSRV(u32 descriptor_set, IGfxResource* resource, const ngfx::GfxShaderResourceViewDesc& desc);
+        IGfxDescriptor* GetBindlessUAV(u32 descriptor_set, IGfxResource* resource, const ngfx::GfxUnorderedAccessViewDesc& desc);
+
+        // union of the usage flags a named resource was realized with in recent frames. It is only read while
+        // realization is prepared and updated during the serial part, so every resource of a frame sees the same table.
+        u32  GetStableUsage(const nstring::str_t* name, bool texture) const;
+        void UpdateStableUsage(const nstring::str_t* name, bool texture, u32 usage);
+
+        u64 GetHistoryMemorySize() const { return m_historyMemorySize; }
+        u64 GetAllocatedMemorySize() const;
+
+        static const u32 MaxHistoryLength = 4;
+
+        // device frames after its last use before a placed resource may be deleted: the frames the GPU may still have in
+        // flight plus the frame the render graph compiles ahead of execution
+        static const u32 RetireFrames = GFX_MAX_INFLIGHT_FRAMES + 1;
+
+        // a placed resource idle since 'last_used_frame' may be replaced by one with another desc in the same memory
+        static bool CanRecycle(u64 last_used_frame, u64 current_frame) { return current_frame - last_used_frame >= RetireFrames; }
+
     private:
-        void CheckHeapUsage(Heap& heap);
+        struct HistoryTexture;
+
+        void  CheckHeapUsage(Heap& heap);
+        u64   GetResourceSize(IGfxResource* resource) const;
+        float GetFragmentation(u64 last_frame) const;
+        void DeleteHistoryTexture(HistoryTexture& history);
+        void ResetDescriptorSet(u32 descriptor_set);
         void DeleteDescriptor(IGfxResource* resource);
-        void AllocateHeap(u32 size);
+        void AllocateHeap(u32 size, ngfx::GfxMemoryType memory_type);
+        void Retire(IGfxHeap* heap, IGfxResource* resource);
+        void Retire(IGfxDescriptor* descriptor);
+        void ReleaseRetired(bool all);
+        u32  ClaimHeap(const HeapLayout& layout, vector_t<u8>& claimed);
+
+        AliasedResource* SelectRecyclable(AliasedResource* current, AliasedResource& candidate) const;
+        AliasedResource* Recycle(AliasedResource& aliasedResource);
+        AliasedResource* AddAliasedResource(Heap& heap);
 
     private:
-        IGfxDevice* m_pDevice;
+        IGfxDevice*         m_pDevice;
+        mutable RenderGraphSpinLock m_lock;
+        u64                         m_lifetimeFrame = 0;
+        u32                         m_nextHeapId    = 1;
+
+        // heaps and placed resources compaction replaced and replaced views, deleted once no frame in flight can reference them
+        struct RetiredObject
+        {
+            IGfxHeap*       heap;
+            IGfxResource*   resource;
+            IGfxDescriptor* descriptor;
+            u64             frame;
+        };
+        vector_t<RetiredObject> m_retiredObjects;
 
         // vector_t<Heap> m_allocatedHeaps;
         Heap* m_allocatedHeaps;
@@ -133,12 +300,51 @@ namespace ncore
             IGfxTexture*           texture;
             ngfx::GfxAccess::Flags lastUsedState;
             u64                    lastUsedFrame;
+            u32                    descriptorSet;
         };
         // vector_t<NonOverlappingTexture> m_freeOverlappingTextures;
         NonOverlappingTexture* m_freeOverlappingTextures;
         s32                    m_numFreeOverlappingTextures;
         s32                    m_maxFreeOverlappingTextures;
 
+        struct HistoryTexture
+        {
+            const nstring::str_t*  name; // names are interned by the string storage, comparing the pointer is enough
+            ngfx::GfxTextureDesc   desc;
+            u32                    length;
+            u64                    lastUsedFrame;
+            IGfxTexture*           textures[MaxHistoryLength];
+            ngfx::GfxAccess::Flags states[MaxHistoryLength];
+            u64                    writtenFrames[MaxHistoryLength];
+            u32                    descriptorSets[MaxHistoryLength];
+        };
+        // vector_t<HistoryTexture> m_historyTextures;
+        HistoryTexture* m_historyTextures;
+        s32             m_numHistoryTextures;
+        s32             m_maxHistoryTextures;
+        u64             m_historyMemorySize = 0;
+
+        struct StableUsage
+        {
+            const nstring::str_t* name;
+            bool                  texture;
+            u32                   usage;
+            u64                   lastUsedFrame;
+        };
+        // vector_t<StableUsage> m_stableUsages;
+        StableUsage* m_stableUsages;
+        s32          m_numStableUsages;
+        s32          m_maxStableUsages;
+
+        IGfxBuffer* m_pRingBuffer            = nullptr;
+        u32         m_ringBufferSize         = 4 * 1024 * 1024; // per in-flight frame
+        u32         m_ringOffset             = 0;
+        u64         m_ringFrame              = 0;
+        u32         m_ringCursor             = 0; // descriptor sets of the region taken by the frame
+
+        vector_t<u32> m_ringDescriptorSets[GFX_MAX_INFLIGHT_FRAMES];
+        u32         m_subAllocationThreshold = 64 * 1024;
+
         // vector_t<SRVDescriptor> m_allocatedSRVs;
         SRVDescriptor* m_allocatedSRVs;
         s32            m_numAllocatedSRVs;
@@ -147,6 +353,12 @@ namespace ncore
         UAVDescriptor* m_allocatedUAVs;
         s32            m_numAllocatedUAVs;
         s32            m_maxAllocatedUAVs;
+
+        // vector_t<DescriptorSet> m_descriptorSets;
+        DescriptorSet* m_descriptorSets;
+        s32            m_numDescriptorSets;
+        s32            m_maxDescriptorSets;
+        u32            m_firstFreeDescriptorSet = InvalidDescriptorSet;
     };
 
 } // namespace ncore
@@ -0,0 +1,114 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_STAGE_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_STAGE_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "cgfx/gfx_defines.h"
+
+namespace ncore
+{
+    // pipeline stages an access happens in, carried next to the access state from the builder to the barriers
+    // so a backend with stage aware barriers only blocks the stages that depend on each other
+    enum class RGShaderStage : u16
+    {
+        None     = 0, // derived from the access state
+        Vertex   = 1 << 0,
+        Mesh     = 1 << 1,
+        Task     = 1 << 2,
+        Pixel    = 1 << 3,
+        Compute  = 1 << 4,
+        Indirect = 1 << 5,
+        Copy     = 1 << 6,
+
+        NonPixel = Vertex | Mesh | Task,
+        Graphics = Vertex | Mesh | Task | Pixel,
+    };
+
+    inline RGShaderStage operator|(RGShaderStage a, RGShaderStage b) { return (RGShaderStage)((u16)a | (u16)b); }
+    inline RGShaderStage operator&(RGShaderStage a, RGShaderStage b) { return (RGShaderStage)((u16)a & (u16)b); }
+    inline bool          HasStage(RGShaderStage stages, RGShaderStage stage) { return ((u16)stages & (u16)stage) != 0; }
+
+    // the stage mask the backend barriers take, the bits of RGShaderStage as is, 0 lets the backend derive the stages from the state
+    inline u32 RGGetStageMask(RGShaderStage stages) { return (u32)stages; }
+
+    // the widest stages an access state implies, the access flags only tell pixel and non-pixel shaders apart
+    inline RGShaderStage RGGetStages(ngfx::GfxAccessFlags state)
+    {
+        RGShaderStage stages = RGShaderStage::None;
+        if (state & (ngfx::GfxAccess::PixelShaderSRV | ngfx::GfxAccess::PixelShaderUAV))
+        {
+            stages = stages | RGShaderStage::Pixel;
+        }
+        if (state & (ngfx::GfxAccess::VertexShaderSRV | ngfx::GfxAccess::VertexShaderUAV))
+        {
+            stages = stages | RGShaderStage::NonPixel;
+        }
+        if (state & (ngfx::GfxAccess::ComputeSRV | ngfx::GfxAccess::ComputeUAV | ngfx::GfxAccess::ClearUAV))
+        {
+            stages = stages | RGShaderStage::Compute;
+        }
+        if (state & ngfx::GfxAccess::IndirectArgs)
+        {
+            stages = stages | RGShaderStage::Indirect;
+        }
+        if (state & (ngfx::GfxAccess::CopySrc | ngfx::GfxAccess::CopyDst))
+        {
+            stages = stages | RGShaderStage::Copy;
+        }
+        return stages;
+    }
+
+    // access states for a read and a write in 'stages', the stage mask keeps what the access flags can't express
+    inline ngfx::GfxAccessFlags RGGetReadState(RGShaderStage stages)
+    {
+        ngfx::GfxAccessFlags state = 0;
+        if (HasStage(stages, RGShaderStage::Pixel))
+        {
+            state |= ngfx::GfxAccess::PixelShaderSRV;
+        }
+        if (HasStage(stages, RGShaderStage::NonPixel))
+        {
+            state |= ngfx::GfxAccess::VertexShaderSRV;
+        }
+        if (HasStage(stages, RGShaderStage::Compute))
+        {
+            state |= ngfx::GfxAccess::ComputeSRV;
+        }
+        if (HasStage(stages, RGShaderStage::Indirect))
+        {
+            state |= ngfx::GfxAccess::IndirectArgs;
+        }
+        if (HasStage(stages, RGShaderStage::Copy))
+        {
+            state |= ngfx::GfxAccess::CopySrc;
+        }
+        return state;
+    }
+
+    inline ngfx::GfxAccessFlags RGGetWriteState(RGShaderStage stages)
+    {
+        ASSERT(!HasStage(stages, RGShaderStage::Indirect)); // indirect arguments are only read
+
+        ngfx::GfxAccessFlags state = 0;
+        if (HasStage(stages, RGShaderStage::Pixel))
+        {
+            state |= ngfx::GfxAccess::PixelShaderUAV;
+        }
+        if (HasStage(stages, RGShaderStage::NonPixel))
+        {
+            state |= ngfx::GfxAccess::VertexShaderUAV;
+        }
+        if (HasStage(stages, RGShaderStage::Compute))
+        {
+            state |= ngfx::GfxAccess::ComputeUAV | ngfx::GfxAccess::ClearUAV;
+        }
+        if (HasStage(stages, RGShaderStage::Copy))
+        {
+            state |= ngfx::GfxAccess::CopyDst;
+        }
+        return state;
+    }
+} // namespace ncore
+#endif
@@ -0,0 +1,77 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_STAGING_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_STAGING_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "callocator/c_allocator_string.h"
+#include "cgfx/gfx_defines.h"
+
+namespace ncore
+{
+    class IGfxDevice;
+    class IGfxBuffer;
+
+    // a readback becomes readable on the CPU once 'fence' has been reached by the render graph staging fence
+    struct RGReadback
+    {
+        u64  fence  = 0;
+        u32  offset = 0;
+        u32  size   = 0;
+        bool IsValid() const { return size != 0; }
+    };
+
+    // hands out ranges of a ring of 'size' bytes, ranges are released per submitted frame once the GPU has passed the
+    // fence value of that frame. Only the bookkeeping, RenderGraphStagingRing puts a mapped buffer behind it.
+    class RenderGraphStagingAllocator
+    {
+    public:
+        RenderGraphStagingAllocator(u32 size);
+
+        bool Allocate(u32 size, u32 alignment, u32& offset);
+
+        // bytes allocated since the last call, a frame takes them when it is compiled and submits them with its fence
+        u32  TakePending();
+        void Submit(u64 fence_value, u32 size);
+        void Retire(u64 completed_fence_value);
+
+        u32 GetSize() const { return m_size; }
+        u32 GetUsed() const { return m_used; }
+
+    private:
+        struct Frame
+        {
+            u64 fence;
+            u32 size;
+        };
+
+        static const u32 MaxFrames = 16;
+
+        u32 m_size;
+        u32 m_head    = 0;
+        u32 m_used    = 0;
+        u32 m_pending = 0; // allocated since the last TakePending
+
+        Frame m_frames[MaxFrames];
+        u32   m_firstFrame = 0;
+        u32   m_numFrames  = 0;
+    };
+
+    // persistently mapped buffer that hands out ranges in a ring, allocation never waits for the GPU
+    class RenderGraphStagingRing : public RenderGraphStagingAllocator
+    {
+    public:
+        RenderGraphStagingRing(IGfxDevice* pDevice, ngfx::GfxMemoryType memory_type, u32 size, const nstring::str_t* name);
+        ~RenderGraphStagingRing();
+
+        IGfxBuffer* GetBuffer() const { return m_pBuffer; }
+        u8*         GetCpuAddress() const { return m_pCpuAddress; }
+
+    private:
+        IGfxBuffer* m_pBuffer;
+        u8*         m_pCpuAddress;
+    };
+
+} // namespace ncore
+#endif
@@ -0,0 +1,190 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_SUBGRAPH_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_SUBGRAPH_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "cgfx/gfx_defines.h"
+#include "crendergraph/render_graph_pass.h"
+#include "crendergraph/render_graph_handle.h"
+#include "crendergraph/render_graph_resource.h"
+
+namespace ncore
+{
+    class RenderGraph;
+    class RGBuilder;
+    struct float4;
+
+    // maps the local handles of a subgraph to the handles of one of its instances in the render graph
+    class RGSubgraphInstance
+    {
+    public:
+        RGHandle Get(const RGHandle& local) const
+        {
+            ASSERT(local.node < m_numHandles);
+            return m_handles[local.node];
+        }
+        u32 GetIndex() const { return m_index; }
+
+    private:
+        friend class RenderGraph;
+
+        RGHandle* m_handles;
+        u32       m_numHandles;
+        u32       m_index;
+    };
+
+    class RenderGraphSubgraphPassBase
+    {
+    public:
+        RenderGraphSubgraphPassBase(cpstr_t name, RenderPassType type)
+            : m_name(name)
+            , m_type(type)
+        {
+        }
+        virtual ~RenderGraphSubgraphPassBase() {}
+
+        RenderPassType GetType() const { return m_type; }
+
+        virtual RenderGraphPassBase* Instantiate(RenderGraph& graph, const RGSubgraphInstance* instance) = 0;
+
+    protected:
+        cpstr_t        m_name;
+        RenderPassType m_type;
+    };
+
+    template <class T> class RenderGraphSubgraphPassProto : public RenderGraphSubgraphPassBase
+    {
+    public:
+        RenderGraphSubgraphPassProto(cpstr_t name, RenderPassType type, const eastl::function<void(const T&, IGfxCommandList*, const RGSubgraphInstance&)>& execute)
+            : RenderGraphSubgraphPassBase(name, type)
+        {
+            m_execute = execute;
+        }
+
+        T& GetData() { return m_parameters; }
+
+        virtual RenderGraphPassBase* Instantiate(RenderGraph& graph, const RGSubgraphInstance* instance) override;
+
+    protected:
+        T                                                                            m_parameters;
+        eastl::function<void(const T&, IGfxCommandList*, const RGSubgraphInstance&)> m_execute;
+    };
+
+    // a fixed group of passes recorded once against local handles and instantiated many times per frame,
+    // e.g. a shadow cascade or a per-light pass chain. Compile resolves the transitions and lifetimes of
+    // the resources that are internal to the subgraph once, only the edges that touch an input are left
+    // for the render graph to resolve per instance.
+    class RenderGraphSubgraph
+    {
+        friend class RGBuilder;
+        friend class RenderGraph;
+
+    public:
+        RenderGraphSubgraph() {}
+        ~RenderGraphSubgraph();
+
+        // boundary resource, bound to a render graph handle when instantiating
+        RGHandle Input(u32 slot);
+
+        template <typename Data, typename Setup, typename Exec> RenderGraphSubgraphPassProto<Data>& AddPass(cpstr_t name, RenderPassType type, const Setup& setup, const Exec& execute);
+
+        void Compile();
+        bool IsCompiled() const { return m_bCompiled; }
+        u32  GetNumInputs() const { return m_nInputs; }
+
+        // the lifetime Compile resolved for a resource in local pass indices and the state it is left in. False when the
+        // render graph resolves the resource per instance, an input or a resource used by an async compute pass.
+        bool GetResolvedLifetime(const RGHandle& handle, u32& first_pass, u32& last_pass, ngfx::GfxAccessFlags& last_state) const;
+
+    private:
+        template <typename Resource> RGHandle Create(const typename Resource::Desc& desc, cpstr_t name) { return AddResource(desc, name); }
+
+        RGHandle AddResource(const RGTexture::Desc& desc, cpstr_t name);
+        RGHandle AddResource(const RGBuffer::Desc& desc, cpstr_t name);
+        RGHandle AddNode(u16 resource);
+
+        RGHandle Read(u32 pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, RGShaderStage stages);
+        RGHandle Write(u32 pass, const RGHandle& input, ngfx::GfxAccessFlags usage, u32 subresource, bool non_overlapping, RGShaderStage stages, bool full_coverage);
+
+        RGHandle WriteColor(u32 pass, u32 color_index, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp load_op, const float4& clear_color, bool full_coverage);
+        RGHandle WriteDepth(u32 pass, const RGHandle& input, u32 subresource, ngfx::GfxRenderPass::LoadOp depth_load_op, ngfx::GfxRenderPass::LoadOp stencil_load_op, float clear_depth, u32 clear_stencil, bool full_coverage);
+        RGHandle ReadDepth(u32 pass, const RGHandle& input, u32 subresource);
+
+        void SkipCulling(u32 pass) { m_passes[pass].skip_culling = true; }
+
+    private:
+        static const u16 InvalidIndex = 0xFFFF;
+
+        enum class OpType : u8
+        {
+            Read,
+            Write,
+            WriteColor,
+            WriteDepth,
+            ReadDepth,
+        };
+
+        struct Op
+        {
+            OpType                      type;
+            u16                         pass;
+            u16                         resource;
+            u16                         input_node;
+            u16                         output_node;
+            ngfx::GfxAccessFlags        usage;
+            RGShaderStage               stages; // resolved from the usage when the builder passed none
+            u32                         subresource;
+            u32                         color_index;
+            ngfx::GfxRenderPass::LoadOp load_op;
+            ngfx::GfxRenderPass::LoadOp stencil_load_op;
+            float                       clear_color[4];
+            float                       clear_depth;
+            u32                         clear_stencil;
+            bool                        non_overlapping;
+            bool                        full_coverage;
+
+            // filled in by Compile, the previous access to the same subresource inside the subgraph
+            u16                  prev_pass;
+            ngfx::GfxAccessFlags old_state;
+            RGShaderStage        old_stages;
+            bool                 uav_barrier;
+        };
+
+        struct Resource
+        {
+            s32             input; // slot index, -1 for resources owned by the subgraph
+            u16             node;  // local node of version 0
+            bool            texture;
+            RGTexture::Desc texture_desc;
+            RGBuffer::Desc  buffer_desc;
+            cpstr_t         name;
+
+            // filled in by Compile, lifetime within the subgraph in local pass indices
+            bool                 pre_resolved;
+            u16                  first_pass;
+            u16                  last_pass;
+            ngfx::GfxAccessFlags last_state;
+        };
+
+        struct Pass
+        {
+            RenderGraphSubgraphPassBase* proto;
+            u32                          first_op;
+            u32                          num_ops;
+            bool                         skip_culling;
+        };
+
+        RGHandle PushOp(const Op& op, bool write);
+
+        vector_t<Resource> m_resources;
+        vector_t<u16>      m_nodeResources; // local node -> local resource
+        vector_t<Op>       m_ops;
+        vector_t<Pass>     m_passes;
+
+        u32  m_nInputs   = 0;
+        bool m_bCompiled = false;
+    };
+} // namespace ncore
+#endif
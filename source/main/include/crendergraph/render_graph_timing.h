@@ -0,0 +1,70 @@
+#ifndef __CRENDERGRAPH_RENDER_GRAPH_TIMING_H__
+#define __CRENDERGRAPH_RENDER_GRAPH_TIMING_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "callocator/c_allocator_string.h"
+
+// pass timers are compiled in for debug builds unless the build config asks for them, they still have to be enabled at runtime
+#ifndef RENDER_GRAPH_PASS_TIMINGS
+#    ifdef TARGET_DEBUG
+#        define RENDER_GRAPH_PASS_TIMINGS 1
+#    else
+#        define RENDER_GRAPH_PASS_TIMINGS 0
+#    endif
+#endif
+
+namespace ncore
+{
+    // time source of the pass timers in nanoseconds, eg. the clock of the telemetry system
+    typedef u64 (*RGClockFunc)();
+
+    enum class RGPassTimer : u8
+    {
+        Record, // the execute lambda of the pass
+        Setup,  // Begin and End, barriers and render pass setup
+        Count,
+    };
+
+    // the last RenderGraphPassTimings::WindowSize samples of a timer, bucket i counts the samples below 2^(i+1) microseconds
+    struct RGPassTimingHistogram
+    {
+        static const u32 NumBuckets = 16;
+
+        u32 counts[NumBuckets];
+        u32 numSamples;
+        u64 averageNs;
+        u64 maxNs;
+    };
+
+#if RENDER_GRAPH_PASS_TIMINGS
+    // process wide table of pass timers keyed by pass name, Execute writes it and any thread may read it without locking.
+    // A pass name is only known by its pointer, the same name has to be passed for a pass every frame.
+    class RenderGraphPassTimings
+    {
+    public:
+        static const u32 InvalidSlot = 0xFFFFFFFF;
+        static const u32 WindowSize  = 64; // power of two
+
+        static void SetEnabled(bool enabled);
+        static bool IsEnabled();
+        static void SetClock(RGClockFunc clock); // std::chrono::steady_clock when not set
+        static u64  Now();
+
+        static u32  Register(cpstr_t name); // InvalidSlot when the table is full
+        static void AddSample(u32 slot, RGPassTimer timer, u64 ns);
+
+        // telemetry, a sample that is written meanwhile may be missing or counted with its previous value
+        static u32     GetNumSlots();
+        static cpstr_t GetName(u32 slot); // nullptr for a free slot
+        static bool    GetHistogram(u32 slot, RGPassTimer timer, RGPassTimingHistogram& histogram);
+
+        // average cost of recording the pass (both timers), 0 when it wasn't timed yet. Meant as the cost model
+        // to balance passes across recorders, see RenderGraph::CreateRecorder.
+        static u64 GetCost(cpstr_t name);
+    };
+#endif
+} // namespace ncore
+#endif
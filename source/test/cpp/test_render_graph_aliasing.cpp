@@ -0,0 +1,39 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_resource_allocator.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_aliasing)
+{
+    UNITTEST_FIXTURE(recycle)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(frames_in_flight_keep_their_placed_resource)
+        {
+            const u64 frame = 100;
+            for (u64 age = 0; age < RenderGraphResourceAllocator::RetireFrames; ++age)
+            {
+                CHECK_FALSE(RenderGraphResourceAllocator::CanRecycle(frame - age, frame));
+            }
+            CHECK_TRUE(RenderGraphResourceAllocator::CanRecycle(frame - RenderGraphResourceAllocator::RetireFrames, frame));
+        }
+
+        UNITTEST_TEST(alternating_resources_are_not_recycled)
+        {
+            // a desc used every other frame is idle for one frame at a time
+            CHECK_FALSE(RenderGraphResourceAllocator::CanRecycle(99, 100));
+            CHECK_FALSE(RenderGraphResourceAllocator::CanRecycle(98, 100));
+        }
+
+        UNITTEST_TEST(prewarmed_resources_count_as_used_now)
+        {
+            CHECK_FALSE(RenderGraphResourceAllocator::CanRecycle(0, 0));
+            CHECK_TRUE(RenderGraphResourceAllocator::CanRecycle(0, 1000));
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,60 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_arena.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_arena)
+{
+    UNITTEST_FIXTURE(blocks)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(allocations_are_aligned)
+        {
+            RenderGraphArena arena(1024);
+
+            u8* a = (u8*)arena.Alloc(3);
+            u8* b = (u8*)arena.Alloc(8, 64);
+            CHECK_EQUAL(0, (s32)((uintptr_t)a & 15));
+            CHECK_EQUAL(0, (s32)((uintptr_t)b & 63));
+            CHECK_TRUE(b >= a + 3);
+        }
+
+        UNITTEST_TEST(a_full_block_grows_the_chain)
+        {
+            RenderGraphArena arena(1024);
+
+            arena.Alloc(1000);
+            CHECK_EQUAL(1, arena.GetNumBlocks());
+
+            // a fixed arena returned nullptr here
+            void* p = arena.Alloc(100);
+            CHECK_TRUE(p != nullptr);
+            CHECK_EQUAL(2, arena.GetNumBlocks());
+
+            // larger than a block, it gets a block of its own size
+            u8* large = (u8*)arena.Alloc(4096);
+            CHECK_TRUE(large != nullptr);
+            large[4095] = 1;
+            CHECK_EQUAL(3, arena.GetNumBlocks());
+        }
+
+        UNITTEST_TEST(reset_reuses_the_chain)
+        {
+            RenderGraphArena arena(1024);
+
+            void* first = arena.Alloc(1000);
+            arena.Alloc(1000);
+            CHECK_EQUAL(2, arena.GetNumBlocks());
+
+            arena.Reset();
+            CHECK_TRUE(arena.Alloc(1000) == first);
+            arena.Alloc(1000);
+            CHECK_EQUAL(2, arena.GetNumBlocks());
+        }
+    }
+}
+UNITTEST_SUITE_END
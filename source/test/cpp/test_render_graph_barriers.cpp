@@ -0,0 +1,253 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_barrier_stats.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_barriers)
+{
+    // records handed to RenderGraphBarrierStats in execution order, the resources are only used as keys
+    UNITTEST_FIXTURE(classify)
+    {
+        static RGBarrierRecord Transition(RenderGraphResource* resource, u32 subresource, ngfx::GfxAccessFlags old_state, ngfx::GfxAccessFlags new_state)
+        {
+            RGBarrierRecord record = {};
+            record.resource        = resource;
+            record.subresource     = subresource;
+            record.old_state       = old_state;
+            record.new_state       = new_state;
+            return record;
+        }
+
+        static RGBarrierRecord Discard(RenderGraphResource* resource, IGfxResource* aliased, ngfx::GfxAccessFlags old_state)
+        {
+            RGBarrierRecord record = {};
+            record.resource        = resource;
+            record.aliased         = aliased;
+            record.subresource     = GFX_ALL_SUB_RESOURCE;
+            record.old_state       = old_state;
+            record.new_state       = ngfx::GfxAccess::RTV | GfxAccessDiscard;
+            record.discard         = true;
+            return record;
+        }
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(read_to_read)
+        {
+            RGTestFrame          test;
+            RenderGraphResource* texture = test.AddTexture()->GetResource();
+
+            const RGBarrierRecord records[] = {
+              Transition(texture, 0, ngfx::GfxAccess::PixelShaderSRV, ngfx::GfxAccess::ComputeSRV),
+              Transition(texture, 0, ngfx::GfxAccess::ComputeSRV, ngfx::GfxAccess::ComputeUAV),
+            };
+
+            RenderGraphBarrierStats stats;
+            stats.Add(records, 2);
+            CHECK_EQUAL(1, stats.GetCount(RGBarrierClass::ReadToRead));
+            CHECK_EQUAL(1, stats.GetCount(RGBarrierClass::Required));
+            CHECK_EQUAL(2, stats.GetNumResourceBarriers());
+        }
+
+        UNITTEST_TEST(undone_per_subresource)
+        {
+            // mip 1 goes back to the state its first barrier took it from, mip 2 has no earlier transition to undo
+            RGTestFrame          test;
+            RenderGraphResource* texture = test.AddTexture()->GetResource();
+
+            const RGBarrierRecord records[] = {
+              Transition(texture, 1, ngfx::GfxAccess::ComputeSRV, ngfx::GfxAccess::ComputeUAV),
+              Transition(texture, 2, ngfx::GfxAccess::ComputeUAV, ngfx::GfxAccess::ComputeSRV),
+              Transition(texture, 1, ngfx::GfxAccess::ComputeUAV, ngfx::GfxAccess::ComputeSRV),
+            };
+
+            RenderGraphBarrierStats stats;
+            stats.Add(records, 3);
+            CHECK_EQUAL(1, stats.GetCount(RGBarrierClass::Undone));
+            CHECK_TRUE(stats.GetRecords()[1].type == RGBarrierClass::Required);
+            CHECK_TRUE(stats.GetRecords()[2].type == RGBarrierClass::Undone);
+        }
+
+        UNITTEST_TEST(redundant_discards)
+        {
+            // the first owner was never used, the second is discarded twice
+            RGTestFrame          test;
+            RenderGraphResource* gbuffer = test.AddTexture()->GetResource();
+            RenderGraphResource* bloom   = test.AddTexture()->GetResource();
+            RenderGraphResource* ssao    = test.AddTexture()->GetResource();
+
+            static char   s_unused, s_history;
+            IGfxResource* unused  = (IGfxResource*)&s_unused;
+            IGfxResource* history = (IGfxResource*)&s_history;
+
+            const RGBarrierRecord records[] = {
+              Discard(gbuffer, unused, GfxAccessDiscard),
+              Discard(bloom, history, ngfx::GfxAccess::PixelShaderSRV),
+              Discard(ssao, history, ngfx::GfxAccess::PixelShaderSRV),
+            };
+
+            RenderGraphBarrierStats stats;
+            stats.Add(records, 3);
+            CHECK_EQUAL(3, stats.GetNumDiscardBarriers());
+            CHECK_EQUAL(0, stats.GetNumResourceBarriers());
+            CHECK_EQUAL(2, stats.GetCount(RGBarrierClass::RedundantDiscard));
+            CHECK_TRUE(stats.GetRecords()[1].type == RGBarrierClass::Required);
+        }
+
+        UNITTEST_TEST(reset_starts_a_new_frame)
+        {
+            RGTestFrame          test;
+            RenderGraphResource* texture = test.AddTexture()->GetResource();
+
+            const RGBarrierRecord first[]  = {Transition(texture, 0, ngfx::GfxAccess::ComputeSRV, ngfx::GfxAccess::ComputeUAV)};
+            const RGBarrierRecord second[] = {Transition(texture, 0, ngfx::GfxAccess::ComputeUAV, ngfx::GfxAccess::ComputeSRV)};
+
+            RenderGraphBarrierStats stats;
+            stats.Add(first, 1);
+            stats.Reset();
+            stats.Add(second, 1);
+            CHECK_EQUAL(0, stats.GetCount(RGBarrierClass::Undone));
+            CHECK_EQUAL(1, (u32)stats.GetRecords().size());
+        }
+    }
+
+    // 'a' writes the texture, 'b' and 'c' read it in different states, the records come from the pass itself
+    UNITTEST_FIXTURE(resolve_barriers)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(records_are_attributed_to_passes)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* texture = test.AddTexture();
+            RenderGraphPassBase*     a       = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase*     b       = test.AddPass();
+            RenderGraphPassBase*     c       = test.AddPass(RenderPassType::Compute);
+
+            RenderGraphResourceNode* written = test.Write(a, texture, ngfx::GfxAccess::ComputeUAV);
+            test.Read(b, written, ngfx::GfxAccess::PixelShaderSRV);
+            test.Read(c, written, ngfx::GfxAccess::ComputeSRV);
+
+            a->ResolveBarriers(frame.graph, true);
+            b->ResolveBarriers(frame.graph, true);
+            c->ResolveBarriers(frame.graph, true);
+
+            CHECK_EQUAL(1, (u32)a->GetBarrierRecords().size());
+            CHECK_TRUE(a->GetBarrierRecords()[0].prev_pass == nullptr);
+            CHECK_TRUE(a->GetBarrierRecords()[0].source == RGBarrierSource::Write);
+
+            CHECK_EQUAL(1, (u32)b->GetBarrierRecords().size());
+            CHECK_TRUE(b->GetBarrierRecords()[0].pass == b->GetId());
+            CHECK_TRUE(b->GetBarrierRecords()[0].prev_pass == a->GetId());
+            CHECK_TRUE(b->GetBarrierRecords()[0].source == RGBarrierSource::Read);
+
+            CHECK_EQUAL(1, (u32)c->GetBarrierRecords().size());
+            CHECK_TRUE(c->GetBarrierRecords()[0].prev_pass == b->GetId());
+
+            RenderGraphBarrierStats stats;
+            stats.Add(a->GetBarrierRecords().data(), (u32)a->GetBarrierRecords().size());
+            stats.Add(b->GetBarrierRecords().data(), (u32)b->GetBarrierRecords().size());
+            stats.Add(c->GetBarrierRecords().data(), (u32)c->GetBarrierRecords().size());
+            CHECK_EQUAL(1, stats.GetCount(RGBarrierClass::ReadToRead));
+            CHECK_EQUAL(2, stats.GetCount(RGBarrierClass::Required));
+        }
+
+        UNITTEST_TEST(nothing_is_recorded_without_analysis)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* texture = test.AddTexture();
+            RenderGraphPassBase*     a       = test.AddPass(RenderPassType::Compute);
+            test.Write(a, texture, ngfx::GfxAccess::ComputeUAV);
+
+            a->ResolveBarriers(frame.graph);
+            CHECK_EQUAL(0, (u32)a->GetBarrierRecords().size());
+        }
+    }
+
+    // consecutive compute passes writing the texture in the same UAV state
+    UNITTEST_FIXTURE(uav_barriers)
+    {
+        static u32 CountUAVBarriers(const RenderGraphPassBase* pass)
+        {
+            u32 count = 0;
+            for (size_t i = 0; i < pass->GetBarrierRecords().size(); ++i)
+            {
+                const RGBarrierRecord& record = pass->GetBarrierRecords()[i];
+                if (!record.discard && record.old_state == record.new_state)
+                {
+                    count++;
+                }
+            }
+            return count;
+        }
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(dependent_writer_waits_for_the_previous_one)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* texture = test.AddTexture();
+            RenderGraphPassBase*     clear   = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase*     splat   = test.AddPass(RenderPassType::Compute);
+
+            RenderGraphResourceNode* cleared = test.Write(clear, texture, ngfx::GfxAccess::ComputeUAV);
+            test.Write(splat, cleared, ngfx::GfxAccess::ComputeUAV);
+
+            splat->ResolveBarriers(frame.graph, true);
+            CHECK_EQUAL(1, CountUAVBarriers(splat));
+            CHECK_TRUE(splat->GetBarrierRecords()[0].prev_pass == clear->GetId());
+
+            // a UAV barrier keeps the state, the analyzer must not count it as an undone transition
+            RenderGraphBarrierStats stats;
+            stats.Add(splat->GetBarrierRecords().data(), (u32)splat->GetBarrierRecords().size());
+            CHECK_EQUAL(1, stats.GetCount(RGBarrierClass::Required));
+        }
+
+        UNITTEST_TEST(non_overlapping_writers_skip_the_barrier)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* texture = test.AddTexture();
+            RenderGraphPassBase*     left    = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase*     right   = test.AddPass(RenderPassType::Compute);
+
+            RenderGraphResourceNode* half = test.Write(left, texture, ngfx::GfxAccess::ComputeUAV, 0, true);
+            test.Write(right, half, ngfx::GfxAccess::ComputeUAV, 0, true);
+
+            right->ResolveBarriers(frame.graph, true);
+            CHECK_EQUAL(0, CountUAVBarriers(right));
+            CHECK_EQUAL(0, (u32)right->GetBarrierRecords().size());
+        }
+
+        UNITTEST_TEST(both_writers_have_to_opt_out)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* texture = test.AddTexture();
+            RenderGraphPassBase*     tiles   = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase*     resolve = test.AddPass(RenderPassType::Compute);
+
+            RenderGraphResourceNode* tiled = test.Write(tiles, texture, ngfx::GfxAccess::ComputeUAV, 0, true);
+            test.Write(resolve, tiled, ngfx::GfxAccess::ComputeUAV);
+
+            resolve->ResolveBarriers(frame.graph, true);
+            CHECK_EQUAL(1, CountUAVBarriers(resolve));
+        }
+    }
+}
+UNITTEST_SUITE_END
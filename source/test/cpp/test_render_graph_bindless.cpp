@@ -0,0 +1,74 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_resource_allocator.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_bindless)
+{
+    // descriptor sets without views, the allocator never touches the device for them
+    UNITTEST_FIXTURE(descriptor_sets)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(new_sets_are_added_in_order)
+        {
+            RenderGraphResourceAllocator allocator(nullptr);
+            CHECK_EQUAL(0, allocator.AllocateDescriptorSet());
+            CHECK_EQUAL(1, allocator.AllocateDescriptorSet());
+            CHECK_EQUAL(2, allocator.AllocateDescriptorSet());
+        }
+
+        UNITTEST_TEST(released_sets_are_reused_first)
+        {
+            RenderGraphResourceAllocator allocator(nullptr);
+
+            const u32 a = allocator.AllocateDescriptorSet();
+            allocator.AllocateDescriptorSet(); // stays in use
+            const u32 c = allocator.AllocateDescriptorSet();
+
+            // the last released set is the first handed out again
+            allocator.ReleaseDescriptorSet(a);
+            allocator.ReleaseDescriptorSet(c);
+            CHECK_EQUAL(c, allocator.AllocateDescriptorSet());
+            CHECK_EQUAL(a, allocator.AllocateDescriptorSet());
+            CHECK_EQUAL(3, allocator.AllocateDescriptorSet());
+        }
+
+        UNITTEST_TEST(release_of_the_invalid_set_is_ignored)
+        {
+            RenderGraphResourceAllocator allocator(nullptr);
+            allocator.ReleaseDescriptorSet(RenderGraphResourceAllocator::InvalidDescriptorSet);
+            CHECK_EQUAL(0, allocator.AllocateDescriptorSet());
+            CHECK_EQUAL(1, allocator.AllocateDescriptorSet());
+        }
+
+        UNITTEST_TEST(a_settled_pool_keeps_its_indices)
+        {
+            // a frame that releases and allocates the same number of sets keeps using the same ones
+            RenderGraphResourceAllocator allocator(nullptr);
+
+            u32 sets[4];
+            for (u32 i = 0; i < 4; ++i)
+            {
+                sets[i] = allocator.AllocateDescriptorSet();
+            }
+
+            for (u32 frame = 0; frame < 3; ++frame)
+            {
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    allocator.ReleaseDescriptorSet(sets[i]);
+                }
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    sets[i] = allocator.AllocateDescriptorSet();
+                    CHECK_TRUE(sets[i] < 4);
+                }
+            }
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,129 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_compile.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_clears)
+{
+    // what of a clear RGFoldClear moves into the load ops of the write after it
+    UNITTEST_FIXTURE(fold)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(color_load_takes_the_clear)
+        {
+            const RGClearFold fold = RGFoldClear(ngfx::GfxAccess::RTV, ngfx::GfxAccess::RTV, false, ngfx::GfxRenderPass::LoadLoad, ngfx::GfxRenderPass::LoadDontCare);
+            CHECK_TRUE(fold.folded);
+            CHECK_TRUE(fold.loadOp);
+            CHECK_FALSE(fold.stencilLoadOp);
+        }
+
+        UNITTEST_TEST(own_clear_of_the_write_is_kept)
+        {
+            const RGClearFold fold = RGFoldClear(ngfx::GfxAccess::RTV, ngfx::GfxAccess::RTV, false, ngfx::GfxRenderPass::LoadClear, ngfx::GfxRenderPass::LoadDontCare);
+            CHECK_TRUE(fold.folded);
+            CHECK_FALSE(fold.loadOp);
+        }
+
+        UNITTEST_TEST(depth_and_stencil_take_the_clear)
+        {
+            const RGClearFold fold = RGFoldClear(ngfx::GfxAccess::DSV, ngfx::GfxAccess::DSV, false, ngfx::GfxRenderPass::LoadLoad, ngfx::GfxRenderPass::LoadLoad);
+            CHECK_TRUE(fold.folded);
+            CHECK_TRUE(fold.loadOp);
+            CHECK_TRUE(fold.stencilLoadOp);
+        }
+
+        UNITTEST_TEST(full_coverage_depth_keeps_the_stencil_clear)
+        {
+            // full coverage only covers the depth, the loaded stencil has to be the cleared one
+            const RGClearFold fold = RGFoldClear(ngfx::GfxAccess::DSV, ngfx::GfxAccess::DSV, true, ngfx::GfxRenderPass::LoadLoad, ngfx::GfxRenderPass::LoadLoad);
+            CHECK_TRUE(fold.folded);
+            CHECK_FALSE(fold.loadOp);
+            CHECK_TRUE(fold.stencilLoadOp);
+        }
+
+        UNITTEST_TEST(full_coverage_color_needs_no_clear)
+        {
+            const RGClearFold fold = RGFoldClear(ngfx::GfxAccess::RTV, ngfx::GfxAccess::RTV, true, ngfx::GfxRenderPass::LoadLoad, ngfx::GfxRenderPass::LoadDontCare);
+            CHECK_TRUE(fold.folded);
+            CHECK_FALSE(fold.loadOp);
+            CHECK_FALSE(fold.stencilLoadOp);
+        }
+
+        UNITTEST_TEST(partial_uav_write_keeps_the_clear_pass)
+        {
+            const RGClearFold fold = RGFoldClear(ngfx::GfxAccess::RTV, ngfx::GfxAccess::ComputeUAV, false, ngfx::GfxRenderPass::LoadDontCare, ngfx::GfxRenderPass::LoadDontCare);
+            CHECK_FALSE(fold.folded);
+        }
+    }
+
+    // a depth buffer written by 'shadow', cleared, and drawn to by 'draw'
+    UNITTEST_FIXTURE(eliminate_redundant_clears)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(clear_moves_into_the_load_op_of_the_next_pass)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphPassBase* shadow = test.AddPass();
+            RenderGraphPassBase* clear  = test.AddPass();
+            RenderGraphPassBase* draw   = test.AddPass();
+            clear->SetClearPass();
+
+            RenderGraphResourceNode* depth   = test.AddTexture();
+            RenderGraphResourceNode* shadows = test.WriteDepth(shadow, depth, ngfx::GfxRenderPass::LoadDontCare);
+            RenderGraphResourceNode* cleared = test.WriteDepth(clear, shadows, ngfx::GfxRenderPass::LoadClear, nullptr, 1.0f);
+
+            RenderGraphEdgeDepthAttchment* load = nullptr;
+            test.WriteDepth(draw, cleared, ngfx::GfxRenderPass::LoadLoad, &load);
+
+            frame.BuildLivePasses();
+            frame.EliminateRedundantClears();
+
+            CHECK_TRUE(clear->IsFolded());
+            CHECK_EQUAL(1, frame.clears.numFoldedPasses);
+            CHECK_EQUAL(ngfx::GfxRenderPass::LoadClear, load->GetDepthLoadOp());
+            CHECK_EQUAL(ngfx::GfxRenderPass::LoadClear, load->GetStencilLoadOp());
+            CHECK_EQUAL(1.0f, load->GetClearDepth());
+
+            // the folded pass takes no level, 'draw' depends on 'shadow' through it
+            frame.BuildDependencyLevels();
+            CHECK_EQUAL(1, draw->GetDependencyLevel());
+            CHECK_EQUAL(2, (u32)frame.levelPasses.size());
+            CHECK_TRUE(frame.levelPasses[1] == draw);
+        }
+
+        UNITTEST_TEST(read_of_the_cleared_contents_keeps_the_clear)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphPassBase* clear = test.AddPass();
+            RenderGraphPassBase* fog   = test.AddPass();
+            RenderGraphPassBase* draw  = test.AddPass();
+            clear->SetClearPass();
+
+            RenderGraphResourceNode* cleared = test.WriteDepth(clear, test.AddTexture(), ngfx::GfxRenderPass::LoadClear);
+            test.Read(fog, cleared, ngfx::GfxAccess::PixelShaderSRV);
+
+            RenderGraphEdgeDepthAttchment* load = nullptr;
+            test.WriteDepth(draw, cleared, ngfx::GfxRenderPass::LoadLoad, &load);
+
+            frame.BuildLivePasses();
+            frame.EliminateRedundantClears();
+
+            CHECK_FALSE(clear->IsFolded());
+            CHECK_EQUAL(0, frame.clears.numFoldedPasses);
+            CHECK_EQUAL(ngfx::GfxRenderPass::LoadLoad, load->GetDepthLoadOp());
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,48 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_resource_allocator.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_compaction)
+{
+    // the placements of the last frame as pass ranges and sizes, the peak is what a single heap would have to hold
+    UNITTEST_FIXTURE(peak_live_size)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(nothing_placed)
+        {
+            CHECK_EQUAL(0, RenderGraphResourceAllocator::GetPeakLiveSize(nullptr, nullptr, nullptr, 0));
+        }
+
+        UNITTEST_TEST(disjoint_lifetimes_share_the_memory)
+        {
+            const u32 first_pass[] = {0, 3, 6};
+            const u32 last_pass[]  = {2, 5, 9};
+            const u64 size[]       = {4096, 1024, 2048};
+            CHECK_EQUAL(4096, RenderGraphResourceAllocator::GetPeakLiveSize(first_pass, last_pass, size, 3));
+        }
+
+        UNITTEST_TEST(overlapping_lifetimes_add_up)
+        {
+            // at pass 4 the second and third placement are live, at pass 1 the first and second
+            const u32 first_pass[] = {0, 1, 4};
+            const u32 last_pass[]  = {2, 6, 8};
+            const u64 size[]       = {1000, 300, 900};
+            CHECK_EQUAL(1300, RenderGraphResourceAllocator::GetPeakLiveSize(first_pass, last_pass, size, 3));
+        }
+
+        UNITTEST_TEST(a_lifetime_ending_where_another_starts_overlaps)
+        {
+            // the last pass of one and the first pass of the other run at the same time
+            const u32 first_pass[] = {0, 2};
+            const u32 last_pass[]  = {2, 4};
+            const u64 size[]       = {64, 64};
+            CHECK_EQUAL(128, RenderGraphResourceAllocator::GetPeakLiveSize(first_pass, last_pass, size, 2));
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,205 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_compile.h"
+#include "crendergraph/render_graph_event.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+#include <cstring>
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_events)
+{
+    UNITTEST_FIXTURE(hash)
+    {
+        // the ids have to be known to the compiler, RENDER_GRAPH_EVENT binds them to a constexpr variable
+        static_assert(RGEventHash("") == 2166136261u, "fnv-1a offset basis");
+        static_assert(RGEventHash("a") == 0xe40c292cu, "fnv-1a of a single character");
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(matches_fnv1a)
+        {
+            constexpr u32 id = RGEventHash("foobar");
+            CHECK_EQUAL(0xbf9cf968u, id);
+        }
+
+        UNITTEST_TEST(names_are_hashed_by_their_characters)
+        {
+            const char gbuffer[] = "GBuffer";
+            CHECK_EQUAL(RGEventHash("GBuffer"), RGEventHash(gbuffer));
+            CHECK_TRUE(RGEventHash("GBuffer") != RGEventHash("GBuffer2"));
+        }
+    }
+
+#if RENDER_GRAPH_EVENTS
+    // the table is shared by the process, the tests use ids no event name of the library hashes to
+    UNITTEST_FIXTURE(table)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(registered_name_is_resolved)
+        {
+            CHECK_EQUAL(0x7e000001u, RenderGraphEventTable::Register(0x7e000001u, "Shadows"));
+            CHECK_EQUAL(0, strcmp("Shadows", RenderGraphEventTable::GetName(0x7e000001u)));
+        }
+
+        UNITTEST_TEST(unknown_id_is_resolved_to_a_placeholder)
+        {
+            CHECK_EQUAL(0, strcmp("unknown event", RenderGraphEventTable::GetName(0x7e000002u)));
+        }
+
+        UNITTEST_TEST(ids_on_the_same_slot_are_kept_apart)
+        {
+            // both ids map to the same slot, the second one is probed into the next free slot
+            const u32 first  = 0x7e000400u;
+            const u32 second = first + 1024;
+            RenderGraphEventTable::Register(first, "Bloom");
+            RenderGraphEventTable::Register(second, "Tonemap");
+            CHECK_EQUAL(0, strcmp("Bloom", RenderGraphEventTable::GetName(first)));
+            CHECK_EQUAL(0, strcmp("Tonemap", RenderGraphEventTable::GetName(second)));
+        }
+
+        UNITTEST_TEST(same_name_from_another_call_site_is_not_a_collision)
+        {
+            // every translation unit may have its own copy of the literal
+            const char name[] = "Lighting";
+            const u32  id     = RGEventHash("Lighting");
+            RenderGraphEventTable::Register(id, "Lighting");
+            CHECK_EQUAL(id, RenderGraphEventTable::Register(id, name));
+            CHECK_EQUAL(0, strcmp("Lighting", RenderGraphEventTable::GetName(id)));
+        }
+    }
+#endif
+
+    // passes are given as {first event, begin events, end events, culled}
+    UNITTEST_FIXTURE(rebalance)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(live_passes_keep_their_events)
+        {
+            const u32    stream[] = {10, 11};
+            RGPassEvents passes[] = {{0, 1, 0, 0}, {1, 1, 2, 0}};
+            u32          live_stream[2], deferred[2];
+
+            const u32 num_live = RGRebalanceEvents(passes, 2, stream, live_stream, deferred);
+            CHECK_EQUAL(2, num_live);
+            CHECK_EQUAL(10, live_stream[0]);
+            CHECK_EQUAL(11, live_stream[1]);
+            CHECK_EQUAL(0, passes[0].firstEvent);
+            CHECK_EQUAL(1, passes[1].firstEvent);
+            CHECK_EQUAL(2, passes[1].numEndEvents);
+        }
+
+        UNITTEST_TEST(begin_moves_to_the_next_live_pass)
+        {
+            // the culled first pass begins event 10, which the second pass ends
+            const u32    stream[] = {10};
+            RGPassEvents passes[] = {{0, 1, 0, 1}, {1, 0, 1, 0}};
+            u32          live_stream[1], deferred[1];
+
+            const u32 num_live = RGRebalanceEvents(passes, 2, stream, live_stream, deferred);
+            CHECK_EQUAL(1, num_live);
+            CHECK_EQUAL(10, live_stream[0]);
+            CHECK_EQUAL(0, passes[1].firstEvent);
+            CHECK_EQUAL(1, passes[1].numBeginEvents);
+            CHECK_EQUAL(1, passes[1].numEndEvents);
+        }
+
+        UNITTEST_TEST(end_moves_to_the_previous_live_pass)
+        {
+            // event 10 is begun by the live first pass and ended by the culled second pass
+            const u32    stream[] = {10};
+            RGPassEvents passes[] = {{0, 1, 0, 0}, {1, 0, 1, 1}, {1, 0, 0, 0}};
+            u32          live_stream[1], deferred[1];
+
+            const u32 num_live = RGRebalanceEvents(passes, 3, stream, live_stream, deferred);
+            CHECK_EQUAL(1, num_live);
+            CHECK_EQUAL(1, passes[0].numEndEvents);
+            CHECK_EQUAL(0, passes[2].numBeginEvents);
+            CHECK_EQUAL(0, passes[2].numEndEvents);
+        }
+
+        UNITTEST_TEST(event_of_culled_passes_only_is_dropped)
+        {
+            // event 11 encloses the culled second pass only, event 10 encloses all three passes
+            const u32    stream[] = {10, 11};
+            RGPassEvents passes[] = {{0, 1, 0, 0}, {1, 1, 1, 1}, {2, 0, 1, 0}};
+            u32          live_stream[2], deferred[2];
+
+            const u32 num_live = RGRebalanceEvents(passes, 3, stream, live_stream, deferred);
+            CHECK_EQUAL(1, num_live);
+            CHECK_EQUAL(10, live_stream[0]);
+            CHECK_EQUAL(1, passes[0].numBeginEvents);
+            CHECK_EQUAL(0, passes[0].numEndEvents);
+            CHECK_EQUAL(0, passes[2].numBeginEvents);
+            CHECK_EQUAL(1, passes[2].numEndEvents);
+        }
+    }
+
+    // 'blur' writes nothing the frame keeps, culling drops it between 'scene' and 'post'
+    UNITTEST_FIXTURE(build_live_passes)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(culled_pass_is_not_live)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphPassBase* scene = test.AddPass();
+            RenderGraphPassBase* blur  = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase* post  = test.AddPass();
+            scene->MakeTarget();
+            post->MakeTarget();
+            frame.graph.Cull();
+
+            frame.BuildLivePasses();
+            CHECK_TRUE(blur->IsCulled());
+            CHECK_EQUAL(2, (u32)frame.livePasses.size());
+            CHECK_TRUE(frame.livePasses[0] == scene);
+            CHECK_TRUE(frame.livePasses[1] == post);
+        }
+
+#if RENDER_GRAPH_EVENTS
+        UNITTEST_TEST(events_of_the_culled_pass_are_dropped)
+        {
+            // "Frame" (10) encloses all three passes, "Blur" (11) only the culled one
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphPassBase* scene = test.AddPass();
+            RenderGraphPassBase* blur  = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase* post  = test.AddPass();
+            frame.eventStream.push_back(10);
+            frame.eventStream.push_back(11);
+            scene->SetBeginEvents(0, 1);
+            blur->SetBeginEvents(1, 1);
+            blur->SetEndEvents(1);
+            post->SetBeginEvents(2, 0);
+            post->SetEndEvents(1);
+
+            scene->MakeTarget();
+            post->MakeTarget();
+            frame.graph.Cull();
+
+            frame.BuildLivePasses();
+            CHECK_EQUAL(1, (u32)frame.liveEventStream.size());
+            CHECK_EQUAL(10, frame.liveEventStream[0]);
+            CHECK_EQUAL(0, scene->GetFirstEvent());
+            CHECK_EQUAL(1, scene->GetNumBeginEvents());
+            CHECK_EQUAL(0, scene->GetNumEndEvents());
+            CHECK_EQUAL(0, post->GetNumBeginEvents());
+            CHECK_EQUAL(1, post->GetNumEndEvents());
+        }
+#endif
+    }
+}
+UNITTEST_SUITE_END
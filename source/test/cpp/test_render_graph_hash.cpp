@@ -0,0 +1,81 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_resource.h"
+#include "crendergraph/render_graph_resource_allocator.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_hash)
+{
+    // the descriptions that go into the structural hash of the compiled graph cache, nothing is realized so the
+    // allocator never needs a device
+    UNITTEST_FIXTURE(descs)
+    {
+        static RenderGraphResourceAllocator* s_allocator = nullptr;
+
+        UNITTEST_FIXTURE_SETUP() { s_allocator = new RenderGraphResourceAllocator(nullptr); }
+        UNITTEST_FIXTURE_TEARDOWN()
+        {
+            delete s_allocator;
+            s_allocator = nullptr;
+        }
+
+        UNITTEST_TEST(values_hash_the_same_across_calls)
+        {
+            const u64 seed = 14695981039346656037ull;
+            CHECK_EQUAL(RGHashValue((u32)7, seed), RGHashValue((u32)7, seed));
+            CHECK_TRUE(RGHashValue((u32)7, seed) != RGHashValue((u32)8, seed));
+            CHECK_TRUE(RGHashValue((u32)7, RGHashValue((u32)8, seed)) != RGHashValue((u32)8, RGHashValue((u32)7, seed)));
+        }
+
+        UNITTEST_TEST(texture_size_and_layout_are_hashed)
+        {
+            RGTexture::Desc desc;
+            desc.width  = 1920;
+            desc.height = 1080;
+
+            RGTexture a(*s_allocator, nullptr, desc);
+            RGTexture b(*s_allocator, nullptr, desc);
+            CHECK_EQUAL(a.HashDesc(0), b.HashDesc(0));
+
+            desc.height = 1088;
+            RGTexture c(*s_allocator, nullptr, desc);
+            CHECK_TRUE(a.HashDesc(0) != c.HashDesc(0));
+
+            desc.height     = 1080;
+            desc.mip_levels = desc.mip_levels + 1;
+            RGTexture d(*s_allocator, nullptr, desc);
+            CHECK_TRUE(a.HashDesc(0) != d.HashDesc(0));
+        }
+
+        UNITTEST_TEST(usage_compile_adds_is_not_hashed)
+        {
+            // SaveCompiled hashes after Compile added usages, the hash has to match the one taken before
+            RGBuffer::Desc desc;
+            desc.stride = 16;
+            desc.size   = 4096;
+
+            RGBuffer a(*s_allocator, nullptr, desc);
+            desc.usage |= ngfx::GfxBufferUsage::UnorderedAccess;
+            RGBuffer b(*s_allocator, nullptr, desc);
+            CHECK_EQUAL(a.HashDesc(0), b.HashDesc(0));
+
+            desc.size = 8192;
+            RGBuffer c(*s_allocator, nullptr, desc);
+            CHECK_TRUE(a.HashDesc(0) != c.HashDesc(0));
+        }
+
+        UNITTEST_TEST(a_history_is_not_a_transient)
+        {
+            RGTexture::Desc desc;
+            desc.width  = 256;
+            desc.height = 256;
+
+            RGTexture transient(*s_allocator, nullptr, desc);
+            RGTexture history(*s_allocator, nullptr, desc, 2, 1);
+            CHECK_TRUE(transient.HashDesc(0) != history.HashDesc(0));
+        }
+    }
+}
+UNITTEST_SUITE_END
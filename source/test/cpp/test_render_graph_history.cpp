@@ -0,0 +1,63 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_resource_allocator.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_history)
+{
+    UNITTEST_FIXTURE(slots)
+    {
+        typedef RenderGraphResourceAllocator Allocator;
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(slots_ping_pong)
+        {
+            for (u64 frame = 0; frame < 8; ++frame)
+            {
+                CHECK_EQUAL((u32)(frame & 1), Allocator::GetHistorySlot(frame, 2, 0));
+                CHECK_EQUAL((u32)((frame + 1) & 1), Allocator::GetHistorySlot(frame, 2, 1));
+            }
+        }
+
+        UNITTEST_TEST(frames_ago_reads_what_an_earlier_frame_wrote)
+        {
+            // frame 7 writes slot 1 of a 3 long history, frame 5 and 6 wrote the slots 2 and 0
+            CHECK_EQUAL(1, Allocator::GetHistorySlot(7, 3, 0));
+            CHECK_EQUAL(Allocator::GetHistorySlot(6, 3, 0), Allocator::GetHistorySlot(7, 3, 1));
+            CHECK_EQUAL(Allocator::GetHistorySlot(5, 3, 0), Allocator::GetHistorySlot(7, 3, 2));
+        }
+
+        UNITTEST_TEST(slot_is_valid_when_written_that_many_frames_ago)
+        {
+            CHECK_TRUE(Allocator::IsHistorySlotValid(9, 10, 1));
+            CHECK_TRUE(Allocator::IsHistorySlotValid(8, 10, 2));
+            CHECK_FALSE(Allocator::IsHistorySlotValid(7, 10, 1)); // the history skipped a frame
+            CHECK_FALSE(Allocator::IsHistorySlotValid(UINT64_MAX, 10, 1));
+        }
+
+        UNITTEST_TEST(first_frame_has_no_history)
+        {
+            // a new slot is marked as never written, frame 0 minus one frame would wrap onto that mark
+            CHECK_FALSE(Allocator::IsHistorySlotValid(UINT64_MAX, 0, 1));
+            CHECK_FALSE(Allocator::IsHistorySlotValid(UINT64_MAX, 1, 2));
+            CHECK_TRUE(Allocator::IsHistorySlotValid(0, 1, 1));
+        }
+
+        UNITTEST_TEST(written_slots_become_valid_one_frame_later)
+        {
+            u64 written[2] = {UINT64_MAX, UINT64_MAX};
+            for (u64 frame = 0; frame < 4; ++frame)
+            {
+                const u32 previous = Allocator::GetHistorySlot(frame, 2, 1);
+                CHECK_EQUAL(frame > 0, Allocator::IsHistorySlotValid(written[previous], frame, 1));
+
+                written[Allocator::GetHistorySlot(frame, 2, 0)] = frame;
+            }
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,122 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_import.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+using namespace ncore;
+
+// the registry only keeps the pointers, nothing is dereferenced
+static char s_swapchain;
+static char s_shadowAtlas;
+static char s_particles;
+
+UNITTEST_SUITE_BEGIN(render_graph_import)
+{
+    UNITTEST_FIXTURE(registry)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(ids_of_unregistered_entries_are_reused)
+        {
+            RenderGraphImportRegistry registry;
+
+            const u32 swapchain = registry.Register((IGfxResource*)&s_swapchain, ngfx::GfxAccess::Present, true);
+            const u32 atlas     = registry.Register((IGfxResource*)&s_shadowAtlas, ngfx::GfxAccess::PixelShaderSRV, true);
+            CHECK_EQUAL(0, swapchain);
+            CHECK_EQUAL(1, atlas);
+
+            registry.Unregister(swapchain);
+            CHECK_FALSE(registry.IsRegistered(swapchain));
+            CHECK_TRUE(registry.IsRegistered(atlas));
+
+            const u32 particles = registry.Register((IGfxResource*)&s_particles, ngfx::GfxAccess::ComputeUAV, false);
+            CHECK_EQUAL(swapchain, particles);
+            CHECK_FALSE(registry.Get(particles).texture);
+            CHECK_EQUAL((u32)ngfx::GfxAccess::ComputeUAV, (u32)registry.Get(particles).state);
+        }
+    }
+
+    // a registered import recorded into a frame by hand, the way RenderGraph::Import(id) records it
+    UNITTEST_FIXTURE(update_states)
+    {
+        static u32 Import(RenderGraphImportRegistry& registry, RGTestFrame& test, RenderGraphResourceNode* node, char* resource, ngfx::GfxAccessFlags state)
+        {
+            const u32 id = registry.Register((IGfxResource*)resource, state, true);
+
+            RenderGraphImportRegistry::Entry& entry = registry.Get(id);
+            entry.frame                             = test.Get().id;
+            entry.handle.index                      = (u16)node->GetResource()->GetIndex();
+            entry.handle.node                       = 0;
+            test.Get().imports.push_back(id);
+            return id;
+        }
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(final_state_is_the_next_initial_state)
+        {
+            RGTestFrame               test;
+            RenderGraphImportRegistry registry;
+
+            RenderGraphResourceNode* atlas  = test.AddTexture();
+            RenderGraphPassBase*     shadow = test.AddPass();
+            const u32                id     = Import(registry, test, atlas, &s_shadowAtlas, ngfx::GfxAccess::PixelShaderSRV);
+
+            atlas->GetResource()->SetPreResolved(shadow->GetId(), shadow->GetId(), ngfx::GfxAccess::DSV);
+
+            registry.UpdateStates(test.Get());
+            CHECK_EQUAL((u32)ngfx::GfxAccess::DSV, (u32)registry.Get(id).state);
+        }
+
+        UNITTEST_TEST(unused_import_keeps_its_state)
+        {
+            RGTestFrame               test;
+            RenderGraphImportRegistry registry;
+
+            RenderGraphResourceNode* atlas = test.AddTexture();
+            const u32                id    = Import(registry, test, atlas, &s_shadowAtlas, ngfx::GfxAccess::PixelShaderSRV);
+
+            registry.UpdateStates(test.Get());
+            CHECK_EQUAL((u32)ngfx::GfxAccess::PixelShaderSRV, (u32)registry.Get(id).state);
+        }
+
+        UNITTEST_TEST(present_state_wins)
+        {
+            RGTestFrame               test;
+            RenderGraphImportRegistry registry;
+
+            RenderGraphResourceNode* backbuffer = test.AddTexture();
+            RenderGraphPassBase*     composite  = test.AddPass();
+            const u32                id         = Import(registry, test, backbuffer, &s_swapchain, ngfx::GfxAccess::Present);
+
+            backbuffer->GetResource()->SetPreResolved(composite->GetId(), composite->GetId(), ngfx::GfxAccess::RTV);
+            test.Get().outputResources.push_back({backbuffer->GetResource(), ngfx::GfxAccess::Present});
+
+            registry.UpdateStates(test.Get());
+            CHECK_EQUAL((u32)ngfx::GfxAccess::Present, (u32)registry.Get(id).state);
+        }
+
+        UNITTEST_TEST(unregistered_entry_is_left_alone)
+        {
+            // the id was unregistered and handed out again after the frame imported it
+            RGTestFrame               test;
+            RenderGraphImportRegistry registry;
+
+            RenderGraphResourceNode* atlas  = test.AddTexture();
+            RenderGraphPassBase*     shadow = test.AddPass();
+            const u32                id     = Import(registry, test, atlas, &s_shadowAtlas, ngfx::GfxAccess::PixelShaderSRV);
+
+            atlas->GetResource()->SetPreResolved(shadow->GetId(), shadow->GetId(), ngfx::GfxAccess::DSV);
+            registry.Unregister(id);
+            CHECK_EQUAL(id, registry.Register((IGfxResource*)&s_particles, ngfx::GfxAccess::ComputeSRV, false));
+
+            registry.UpdateStates(test.Get());
+            CHECK_EQUAL((u32)ngfx::GfxAccess::ComputeSRV, (u32)registry.Get(id).state);
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,198 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_compile.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_levels)
+{
+    // the levels in live pass indices, as BuildDependencyLevels hands them over
+    UNITTEST_FIXTURE(compute_levels)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(chain_and_independent_pass)
+        {
+            // 0 -> 1 -> 2, pass 3 depends on nothing
+            const u32 dependencies[] = {0, 1, 1, 2};
+            u32       level[4], latest[4], critical[4];
+
+            const u32 num_levels = RGComputeDependencyLevels(4, dependencies, 2, level, latest, critical);
+            CHECK_EQUAL(3, num_levels);
+
+            CHECK_EQUAL(0, level[0]);
+            CHECK_EQUAL(1, level[1]);
+            CHECK_EQUAL(2, level[2]);
+            CHECK_EQUAL(0, level[3]);
+
+            // the chain has no slack, the independent pass can move to the last level
+            CHECK_EQUAL(0, latest[0]);
+            CHECK_EQUAL(1, latest[1]);
+            CHECK_EQUAL(2, latest[2]);
+            CHECK_EQUAL(2, latest[3]);
+
+            CHECK_EQUAL(RGNoDependency, critical[0]);
+            CHECK_EQUAL(0, critical[1]);
+            CHECK_EQUAL(1, critical[2]);
+            CHECK_EQUAL(RGNoDependency, critical[3]);
+
+            u32       path[3];
+            const u32 length = RGGetCriticalPath(4, level, critical, num_levels, path);
+            CHECK_EQUAL(3, length);
+            CHECK_EQUAL(0, path[0]);
+            CHECK_EQUAL(1, path[1]);
+            CHECK_EQUAL(2, path[2]);
+        }
+
+        UNITTEST_TEST(diamond)
+        {
+            // 0 -> 1 -> 3 and 0 -> 2 -> 3, the first dependency that sets a level is the critical one
+            const u32 dependencies[] = {0, 1, 0, 2, 1, 3, 2, 3};
+            u32       level[4], latest[4], critical[4];
+
+            const u32 num_levels = RGComputeDependencyLevels(4, dependencies, 4, level, latest, critical);
+            CHECK_EQUAL(3, num_levels);
+
+            CHECK_EQUAL(0, level[0]);
+            CHECK_EQUAL(1, level[1]);
+            CHECK_EQUAL(1, level[2]);
+            CHECK_EQUAL(2, level[3]);
+
+            for (u32 i = 0; i < 4; ++i)
+            {
+                CHECK_EQUAL(level[i], latest[i]);
+            }
+            CHECK_EQUAL(1, critical[3]);
+
+            u32       path[3];
+            const u32 length = RGGetCriticalPath(4, level, critical, num_levels, path);
+            CHECK_EQUAL(3, length);
+            CHECK_EQUAL(0, path[0]);
+            CHECK_EQUAL(1, path[1]);
+            CHECK_EQUAL(3, path[2]);
+        }
+
+        UNITTEST_TEST(slack_of_a_side_branch)
+        {
+            // 0 -> 1 -> 2 -> 4 and 0 -> 3 -> 4, pass 3 may run anywhere between level 1 and 2
+            const u32 dependencies[] = {0, 1, 1, 2, 0, 3, 2, 4, 3, 4};
+            u32       level[5], latest[5], critical[5];
+
+            const u32 num_levels = RGComputeDependencyLevels(5, dependencies, 5, level, latest, critical);
+            CHECK_EQUAL(4, num_levels);
+            CHECK_EQUAL(1, level[3]);
+            CHECK_EQUAL(2, latest[3]);
+            CHECK_EQUAL(3, level[4]);
+            CHECK_EQUAL(2, critical[4]);
+        }
+
+        UNITTEST_TEST(skipped_pass_takes_no_level)
+        {
+            // 0 -> 2, pass 1 is a folded clear whose dependencies were forwarded to pass 2
+            const u32 dependencies[] = {0, 2};
+            const u8  skipped[]      = {0, 1, 0};
+            u32       level[3], latest[3], critical[3];
+
+            const u32 num_levels = RGComputeDependencyLevels(3, dependencies, 1, level, latest, critical, skipped);
+            CHECK_EQUAL(2, num_levels);
+            CHECK_EQUAL(0, level[1]);
+            CHECK_EQUAL(0, latest[1]);
+            CHECK_EQUAL(1, level[2]);
+
+            u32       path[2];
+            const u32 length = RGGetCriticalPath(3, level, critical, num_levels, path, skipped);
+            CHECK_EQUAL(2, length);
+            CHECK_EQUAL(0, path[0]);
+            CHECK_EQUAL(2, path[1]);
+        }
+
+        UNITTEST_TEST(skipped_pass_is_never_the_tail)
+        {
+            const u8 skipped[] = {0, 1};
+            u32      level[2], latest[2], critical[2];
+
+            const u32 num_levels = RGComputeDependencyLevels(2, nullptr, 0, level, latest, critical, skipped);
+            CHECK_EQUAL(1, num_levels);
+
+            u32       path[1];
+            const u32 length = RGGetCriticalPath(2, level, critical, num_levels, path, skipped);
+            CHECK_EQUAL(1, length);
+            CHECK_EQUAL(0, path[0]);
+        }
+
+        UNITTEST_TEST(no_dependencies)
+        {
+            u32 level[2], latest[2], critical[2];
+
+            const u32 num_levels = RGComputeDependencyLevels(2, nullptr, 0, level, latest, critical);
+            CHECK_EQUAL(1, num_levels);
+            CHECK_EQUAL(0, level[0]);
+            CHECK_EQUAL(0, level[1]);
+            CHECK_EQUAL(0, latest[0]);
+            CHECK_EQUAL(0, latest[1]);
+
+            // the last pass of the deepest level ends the path
+            u32       path[1];
+            const u32 length = RGGetCriticalPath(2, level, critical, num_levels, path);
+            CHECK_EQUAL(1, length);
+            CHECK_EQUAL(1, path[0]);
+        }
+    }
+
+    // the dependencies are taken from the recorded graph
+    UNITTEST_FIXTURE(build_dependency_levels)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(reader_and_overwrite_of_a_texture)
+        {
+            // a writes t, b reads it, c overwrites it after b, d writes a texture of its own
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* t = test.AddTexture();
+            RenderGraphResourceNode* u = test.AddTexture();
+
+            RenderGraphPassBase* a = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase* b = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase* c = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase* d = test.AddPass(RenderPassType::Compute);
+
+            RenderGraphResourceNode* t1 = test.Write(a, t, ngfx::GfxAccess::ComputeUAV);
+            test.Read(b, t1, ngfx::GfxAccess::ComputeSRV);
+            test.Write(c, t1, ngfx::GfxAccess::ComputeUAV);
+            test.Write(d, u, ngfx::GfxAccess::ComputeUAV);
+
+            frame.BuildLivePasses();
+            frame.BuildDependencyLevels();
+
+            CHECK_EQUAL(4, (u32)frame.livePasses.size());
+            CHECK_EQUAL(0, a->GetDependencyLevel());
+            CHECK_EQUAL(1, b->GetDependencyLevel());
+            CHECK_EQUAL(2, c->GetDependencyLevel()); // waits for the reader of the version it overwrites
+            CHECK_EQUAL(0, d->GetDependencyLevel());
+            CHECK_EQUAL(0, c->GetDependencySlack());
+            CHECK_EQUAL(2, d->GetDependencySlack());
+
+            // levels keep the execution order of their passes
+            CHECK_EQUAL(4, (u32)frame.levelFirst.size());
+            CHECK_EQUAL(0, frame.levelFirst[0]);
+            CHECK_EQUAL(2, frame.levelFirst[1]);
+            CHECK_TRUE(frame.levelPasses[0] == a);
+            CHECK_TRUE(frame.levelPasses[1] == d);
+            CHECK_TRUE(frame.levelPasses[2] == b);
+            CHECK_TRUE(frame.levelPasses[3] == c);
+
+            CHECK_EQUAL(3, (u32)frame.criticalPath.size());
+            CHECK_TRUE(frame.criticalPath[0] == a);
+            CHECK_TRUE(frame.criticalPath[1] == b);
+            CHECK_TRUE(frame.criticalPath[2] == c);
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,83 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_job.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+#include <thread>
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_parallel)
+{
+    // the resolve jobs take one resource each, they must see its nodes in the order they were recorded
+    UNITTEST_FIXTURE(bucket_resource_nodes)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(interleaved_writes_keep_their_order)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* color  = test.AddTexture();
+            RenderGraphResourceNode* bloom  = test.AddTexture();
+            RenderGraphResourceNode* unused = test.AddTexture();
+
+            RenderGraphPassBase*     scene  = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase*     blur   = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase*     tone   = test.AddPass(RenderPassType::Compute);
+            RenderGraphResourceNode* color1 = test.Write(scene, color, ngfx::GfxAccess::ComputeUAV);
+            RenderGraphResourceNode* bloom1 = test.Write(blur, bloom, ngfx::GfxAccess::ComputeUAV);
+            RenderGraphResourceNode* color2 = test.Write(tone, color1, ngfx::GfxAccess::ComputeUAV);
+
+            RenderGraphResourceNode** nodes = nullptr;
+            u32*                      first = nullptr;
+            frame.BucketResourceNodes(nodes, first);
+
+            CHECK_EQUAL(0, first[0]);
+            CHECK_EQUAL(3, first[1]);
+            CHECK_EQUAL(5, first[2]);
+            CHECK_EQUAL(6, first[3]);
+
+            CHECK_TRUE(nodes[0] == color);
+            CHECK_TRUE(nodes[1] == color1);
+            CHECK_TRUE(nodes[2] == color2);
+            CHECK_TRUE(nodes[3] == bloom);
+            CHECK_TRUE(nodes[4] == bloom1);
+            CHECK_TRUE(nodes[5] == unused);
+        }
+    }
+
+    UNITTEST_FIXTURE(spin_lock)
+    {
+        static RenderGraphSpinLock s_lock;
+        static u32                 s_counter = 0;
+
+        static void Increment(u32 count)
+        {
+            for (u32 i = 0; i < count; ++i)
+            {
+                RenderGraphScopedLock lock(s_lock);
+                s_counter++;
+            }
+        }
+
+        UNITTEST_FIXTURE_SETUP() { s_counter = 0; }
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(threads_do_not_lose_updates)
+        {
+            std::thread a(Increment, 100000u);
+            std::thread b(Increment, 100000u);
+            Increment(100000u);
+            a.join();
+            b.join();
+
+            CHECK_EQUAL(300000, s_counter);
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,89 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_resource_allocator.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_profile)
+{
+    // the heaps and placed resources CaptureProfile merges at the end of the frames of a scenario
+    UNITTEST_FIXTURE(capture)
+    {
+        typedef RenderGraphResourceAllocator::AllocationProfile     Profile;
+        typedef RenderGraphResourceAllocator::HeapLayout            HeapLayout;
+        typedef RenderGraphResourceAllocator::PlacedResourceProfile Placed;
+
+        static HeapLayout Heap(u32 id, u64 size)
+        {
+            HeapLayout layout;
+            layout.size       = size;
+            layout.memoryType = (u32)ngfx::GfxMemoryType::GpuOnly;
+            layout.heap       = id;
+            return layout;
+        }
+
+        static Placed Texture(u32 heap, u32 width, u32 height)
+        {
+            Placed placed             = {};
+            placed.heap               = heap;
+            placed.texture            = 1;
+            placed.textureDesc.width  = width;
+            placed.textureDesc.height = height;
+            return placed;
+        }
+
+        static Placed Buffer(u32 heap, u32 size)
+        {
+            Placed placed          = {};
+            placed.heap            = heap;
+            placed.bufferDesc.size = size;
+            return placed;
+        }
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(heaps_keep_their_peak_size)
+        {
+            Profile profile;
+            CHECK_EQUAL(0, RenderGraphResourceAllocator::AddProfileHeap(profile, Heap(7, 32 << 20)));
+            CHECK_EQUAL(0, RenderGraphResourceAllocator::AddProfileHeap(profile, Heap(7, 64 << 20)));
+            CHECK_EQUAL(0, RenderGraphResourceAllocator::AddProfileHeap(profile, Heap(7, 16 << 20)));
+
+            CHECK_EQUAL(1, (u32)profile.heaps.size());
+            CHECK_EQUAL((u64)64 << 20, profile.heaps[0].size);
+        }
+
+        UNITTEST_TEST(heaps_are_matched_by_id_not_position)
+        {
+            // compaction released heap 3 and the pool order changed between the two captures
+            Profile profile;
+            RenderGraphResourceAllocator::AddProfileHeap(profile, Heap(3, 8 << 20));
+            RenderGraphResourceAllocator::AddProfileHeap(profile, Heap(5, 16 << 20));
+
+            CHECK_EQUAL(1, RenderGraphResourceAllocator::AddProfileHeap(profile, Heap(5, 16 << 20)));
+            CHECK_EQUAL(2, RenderGraphResourceAllocator::AddProfileHeap(profile, Heap(9, 4 << 20)));
+
+            CHECK_EQUAL(3, (u32)profile.heaps.size());
+            CHECK_EQUAL((u64)8 << 20, profile.heaps[0].size);
+            CHECK_EQUAL(9, profile.heaps[2].heap);
+        }
+
+        UNITTEST_TEST(resources_are_added_once_per_heap_and_desc)
+        {
+            Profile profile;
+            RenderGraphResourceAllocator::AddProfileResource(profile, Texture(0, 1920, 1080));
+            RenderGraphResourceAllocator::AddProfileResource(profile, Texture(0, 1920, 1080));
+            RenderGraphResourceAllocator::AddProfileResource(profile, Texture(1, 1920, 1080));
+            RenderGraphResourceAllocator::AddProfileResource(profile, Texture(0, 960, 540));
+            RenderGraphResourceAllocator::AddProfileResource(profile, Buffer(0, 4096));
+            RenderGraphResourceAllocator::AddProfileResource(profile, Buffer(0, 4096));
+
+            CHECK_EQUAL(4, (u32)profile.resources.size());
+            CHECK_EQUAL(1, profile.resources[1].heap);
+            CHECK_EQUAL(0, profile.resources[3].texture);
+        }
+    }
+}
+UNITTEST_SUITE_END
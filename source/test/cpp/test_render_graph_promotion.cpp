@@ -0,0 +1,109 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_promotion)
+{
+    // three graphics passes in a chain, 'c' writes a texture that only the last graphics pass reads. 'c' costs 100
+    // through its cost hint, the graphics passes cost what the cost function is given.
+    UNITTEST_FIXTURE(promote_async_compute)
+    {
+        static u64 GetCost(const RenderGraphPassBase* pass, void* user_data) { return *(const u64*)user_data; }
+
+        static RenderGraphPassBase* Record(RGTestFrame& test)
+        {
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* t = test.AddTexture();
+            RenderGraphResourceNode* u = test.AddTexture();
+
+            RenderGraphPassBase* g0 = test.AddPass();
+            RenderGraphPassBase* g1 = test.AddPass();
+            RenderGraphPassBase* g2 = test.AddPass();
+            RenderGraphPassBase* c  = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase* g3 = test.AddPass();
+
+            RenderGraphResourceNode* t1 = test.Write(g0, t, ngfx::GfxAccess::PixelShaderUAV);
+            RenderGraphResourceNode* t2 = test.Write(g1, t1, ngfx::GfxAccess::PixelShaderUAV);
+            RenderGraphResourceNode* t3 = test.Write(g2, t2, ngfx::GfxAccess::PixelShaderUAV);
+            RenderGraphResourceNode* u1 = test.Write(c, u, ngfx::GfxAccess::ComputeUAV);
+            test.Read(g3, t3, ngfx::GfxAccess::PixelShaderSRV);
+            test.Read(g3, u1, ngfx::GfxAccess::PixelShaderSRV);
+            c->SetCostHint(100);
+
+            frame.BuildLivePasses();
+            frame.BuildDependencyLevels();
+            return c;
+        }
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(slack_hides_the_cost)
+        {
+            RGTestFrame          test;
+            RenderGraphFrame&    frame    = test.Get();
+            RenderGraphPassBase* c        = Record(test);
+            u64                  graphics = 50;
+
+            CHECK_EQUAL(0, c->GetDependencyLevel());
+            CHECK_EQUAL(2, c->GetDependencySlack());
+
+            frame.PromoteAsyncCompute(&GetCost, &graphics, 10, false);
+            CHECK_TRUE(c->GetType() == RenderPassType::AsyncCompute);
+            CHECK_TRUE(c->IsAsyncPromoted());
+            CHECK_EQUAL(1, frame.promotion.numCandidates);
+            CHECK_EQUAL(1, frame.promotion.numPromoted);
+            CHECK_EQUAL(100, frame.promotion.promotedCost);
+            CHECK_EQUAL(100, frame.promotion.expectedOverlap);
+
+            // a frame from the compiled graph cache only rebuilds the report
+            frame.PromoteAsyncCompute(&GetCost, &graphics, 10, true);
+            CHECK_EQUAL(1, frame.promotion.numPromoted);
+            CHECK_EQUAL(100, frame.promotion.expectedOverlap);
+        }
+
+        UNITTEST_TEST(too_little_work_to_hide_it)
+        {
+            // 30 of the 100 would overlap, less than half
+            RGTestFrame          test;
+            RenderGraphFrame&    frame    = test.Get();
+            RenderGraphPassBase* c        = Record(test);
+            u64                  graphics = 10;
+
+            frame.PromoteAsyncCompute(&GetCost, &graphics, 10, false);
+            CHECK_TRUE(c->GetType() == RenderPassType::Compute);
+            CHECK_EQUAL(1, frame.promotion.numCandidates);
+            CHECK_EQUAL(0, frame.promotion.numPromoted);
+        }
+
+        UNITTEST_TEST(cheap_pass_stays)
+        {
+            RGTestFrame          test;
+            RenderGraphFrame&    frame    = test.Get();
+            RenderGraphPassBase* c        = Record(test);
+            u64                  graphics = 50;
+
+            frame.PromoteAsyncCompute(&GetCost, &graphics, 200, false);
+            CHECK_TRUE(c->GetType() == RenderPassType::Compute);
+            CHECK_EQUAL(0, frame.promotion.numPromoted);
+        }
+
+        UNITTEST_TEST(disabled_without_a_cost_function)
+        {
+            RGTestFrame          test;
+            RenderGraphFrame&    frame = test.Get();
+            RenderGraphPassBase* c     = Record(test);
+
+            frame.PromoteAsyncCompute(nullptr, nullptr, 0, false);
+            CHECK_TRUE(c->GetType() == RenderPassType::Compute);
+            CHECK_EQUAL(0, frame.promotion.numCandidates);
+        }
+    }
+}
+UNITTEST_SUITE_END
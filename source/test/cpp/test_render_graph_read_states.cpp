@@ -0,0 +1,116 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_compile.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_read_states)
+{
+    // reads are given as {usage, stages, subresource, queue, mergeable, culled}
+    UNITTEST_FIXTURE(merge)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(consecutive_reads_share_the_union)
+        {
+            RGReadAccess reads[] = {{ngfx::GfxAccess::PixelShaderSRV, RGShaderStage::Pixel, 0, 0, 1, 0}, {ngfx::GfxAccess::VertexShaderSRV, RGShaderStage::Vertex, 0, 0, 1, 0}};
+            RGMergeReadStates(reads, 2);
+
+            const ngfx::GfxAccessFlags state = ngfx::GfxAccess::PixelShaderSRV | ngfx::GfxAccess::VertexShaderSRV;
+            for (u32 i = 0; i < 2; ++i)
+            {
+                CHECK_EQUAL(1, reads[i].merged);
+                CHECK_EQUAL(state, reads[i].state);
+                CHECK_TRUE(reads[i].mergedStages == (RGShaderStage::Pixel | RGShaderStage::Vertex));
+            }
+        }
+
+        UNITTEST_TEST(a_non_mergeable_access_ends_the_run)
+        {
+            RGReadAccess reads[] = {{ngfx::GfxAccess::PixelShaderSRV, RGShaderStage::Pixel, 0, 0, 1, 0}, {ngfx::GfxAccess::CopySrc, RGShaderStage::Copy, 0, 0, 0, 0},
+                                    {ngfx::GfxAccess::VertexShaderSRV, RGShaderStage::Vertex, 0, 0, 1, 0}};
+            RGMergeReadStates(reads, 3);
+
+            CHECK_EQUAL(1, reads[0].merged);
+            CHECK_EQUAL((ngfx::GfxAccessFlags)ngfx::GfxAccess::PixelShaderSRV, reads[0].state);
+            CHECK_EQUAL(0, reads[1].merged);
+            CHECK_EQUAL(1, reads[2].merged);
+            CHECK_EQUAL((ngfx::GfxAccessFlags)ngfx::GfxAccess::VertexShaderSRV, reads[2].state);
+        }
+
+        UNITTEST_TEST(runs_do_not_cross_queues)
+        {
+            RGReadAccess reads[] = {{ngfx::GfxAccess::PixelShaderSRV, RGShaderStage::Pixel, 0, 0, 1, 0}, {ngfx::GfxAccess::ComputeSRV, RGShaderStage::Compute, 0, 1, 1, 0}};
+            RGMergeReadStates(reads, 2);
+
+            CHECK_EQUAL((ngfx::GfxAccessFlags)ngfx::GfxAccess::PixelShaderSRV, reads[0].state);
+            CHECK_EQUAL((ngfx::GfxAccessFlags)ngfx::GfxAccess::ComputeSRV, reads[1].state);
+            CHECK_TRUE(reads[1].mergedStages == RGShaderStage::Compute);
+        }
+
+        UNITTEST_TEST(culled_reads_are_skipped)
+        {
+            RGReadAccess reads[] = {{ngfx::GfxAccess::PixelShaderSRV, RGShaderStage::Pixel, 0, 0, 1, 0}, {ngfx::GfxAccess::CopySrc, RGShaderStage::Copy, 0, 0, 0, 1},
+                                    {ngfx::GfxAccess::VertexShaderSRV, RGShaderStage::Vertex, 0, 0, 1, 0}};
+            RGMergeReadStates(reads, 3);
+
+            const ngfx::GfxAccessFlags state = ngfx::GfxAccess::PixelShaderSRV | ngfx::GfxAccess::VertexShaderSRV;
+            CHECK_EQUAL(state, reads[0].state);
+            CHECK_EQUAL(0, reads[1].merged);
+            CHECK_EQUAL(state, reads[2].state);
+        }
+
+        UNITTEST_TEST(subresources_merge_separately)
+        {
+            RGReadAccess reads[] = {{ngfx::GfxAccess::PixelShaderSRV, RGShaderStage::Pixel, 0, 0, 1, 0}, {ngfx::GfxAccess::ComputeSRV, RGShaderStage::Compute, 1, 0, 1, 0},
+                                    {ngfx::GfxAccess::VertexShaderSRV, RGShaderStage::Vertex, 0, 0, 1, 0}};
+            RGMergeReadStates(reads, 3);
+
+            const ngfx::GfxAccessFlags state = ngfx::GfxAccess::PixelShaderSRV | ngfx::GfxAccess::VertexShaderSRV;
+            CHECK_EQUAL(state, reads[0].state);
+            CHECK_EQUAL((ngfx::GfxAccessFlags)ngfx::GfxAccess::ComputeSRV, reads[1].state);
+            CHECK_EQUAL(state, reads[2].state);
+        }
+    }
+
+    // the reads of a node are taken from its outgoing edges, merged states are written back to the edges
+    UNITTEST_FIXTURE(merge_read_states)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(graphics_readers_share_the_state_compute_keeps_its_own)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphPassBase* lighting = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase* shading  = test.AddPass();
+            RenderGraphPassBase* skinning = test.AddPass();
+            RenderGraphPassBase* exposure = test.AddPass(RenderPassType::AsyncCompute);
+
+            RenderGraphResourceNode* lit     = test.Write(lighting, test.AddTexture(), ngfx::GfxAccess::ComputeUAV);
+            RenderGraphEdge*         pixel   = test.Read(shading, lit, ngfx::GfxAccess::PixelShaderSRV);
+            RenderGraphEdge*         vertex  = test.Read(skinning, lit, ngfx::GfxAccess::VertexShaderSRV);
+            RenderGraphEdge*         compute = test.Read(exposure, lit, ngfx::GfxAccess::ComputeSRV);
+
+            vector_t<DAGEdge*>     edges;
+            vector_t<RGReadAccess> reads;
+            frame.MergeReadStates(lit, edges, reads);
+
+            const ngfx::GfxAccessFlags state = ngfx::GfxAccess::PixelShaderSRV | ngfx::GfxAccess::VertexShaderSRV;
+            CHECK_EQUAL(state, pixel->GetState());
+            CHECK_EQUAL(state, vertex->GetState());
+            CHECK_TRUE(pixel->GetStages() == vertex->GetStages());
+
+            // the usage that recorded the read is left alone
+            CHECK_EQUAL((ngfx::GfxAccessFlags)ngfx::GfxAccess::PixelShaderSRV, pixel->GetUsage());
+            CHECK_EQUAL((ngfx::GfxAccessFlags)ngfx::GfxAccess::ComputeSRV, compute->GetState());
+        }
+    }
+}
+UNITTEST_SUITE_END
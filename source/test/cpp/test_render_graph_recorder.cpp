@@ -0,0 +1,48 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_compile.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_recorder)
+{
+    // the sort keys are given in the order the recorders were created, MergeRecorders merges them in 'order'
+    UNITTEST_FIXTURE(merge_order)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(sorted_by_key)
+        {
+            const u32 sort_keys[] = {30, 10, 20};
+            u32       order[3];
+            RGSortMergeOrder(sort_keys, 3, order);
+            CHECK_EQUAL(1, order[0]);
+            CHECK_EQUAL(2, order[1]);
+            CHECK_EQUAL(0, order[2]);
+        }
+
+        UNITTEST_TEST(equal_keys_keep_the_creation_order)
+        {
+            // e.g. shadow cascades recorded by different workers with the same key
+            const u32 sort_keys[] = {5, 1, 5, 1, 5};
+            u32       order[5];
+            RGSortMergeOrder(sort_keys, 5, order);
+            CHECK_EQUAL(1, order[0]);
+            CHECK_EQUAL(3, order[1]);
+            CHECK_EQUAL(0, order[2]);
+            CHECK_EQUAL(2, order[3]);
+            CHECK_EQUAL(4, order[4]);
+        }
+
+        UNITTEST_TEST(single_recorder)
+        {
+            const u32 sort_keys[] = {7};
+            u32       order[1]    = {0xFFFFFFFF};
+            RGSortMergeOrder(sort_keys, 1, order);
+            CHECK_EQUAL(0, order[0]);
+        }
+    }
+}
+UNITTEST_SUITE_END
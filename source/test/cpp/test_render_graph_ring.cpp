@@ -0,0 +1,77 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_resource_allocator.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_ring)
+{
+    // sub-allocation inside the ring regions of the sub-allocated buffers
+    UNITTEST_FIXTURE(regions)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(constant_buffers_are_256_byte_aligned)
+        {
+            u32 used   = 0;
+            u32 offset = 0;
+            CHECK_TRUE(RenderGraphResourceAllocator::SubAllocateRegion(0, 4096, used, 100, 256, offset));
+            CHECK_EQUAL(0, offset);
+            CHECK_EQUAL(100, used);
+
+            CHECK_TRUE(RenderGraphResourceAllocator::SubAllocateRegion(0, 4096, used, 100, 256, offset));
+            CHECK_EQUAL(256, offset);
+            CHECK_EQUAL(356, used);
+        }
+
+        UNITTEST_TEST(structured_offsets_are_whole_elements_of_the_buffer)
+        {
+            // the second region starts at 1000, which is no multiple of the 12 byte stride
+            u32 used   = 0;
+            u32 offset = 0;
+            CHECK_TRUE(RenderGraphResourceAllocator::SubAllocateRegion(1000, 1000, used, 24, 12, offset));
+            CHECK_EQUAL(1008, offset);
+            CHECK_EQUAL(0, offset % 12);
+            CHECK_EQUAL(32, used);
+        }
+
+        UNITTEST_TEST(a_full_region_refuses_without_touching_it)
+        {
+            u32 used   = 900;
+            u32 offset = 0xFFFFFFFF;
+            CHECK_FALSE(RenderGraphResourceAllocator::SubAllocateRegion(0, 1024, used, 200, 256, offset));
+            CHECK_EQUAL(900, used);
+            CHECK_EQUAL(0xFFFFFFFF, offset);
+
+            // exactly up to the end still fits
+            used = 0;
+            CHECK_TRUE(RenderGraphResourceAllocator::SubAllocateRegion(0, 1024, used, 1024, 256, offset));
+            CHECK_EQUAL(1024, used);
+        }
+
+        UNITTEST_TEST(the_same_sequence_lands_on_the_same_offsets)
+        {
+            // a frame that allocates the same buffers again gets the same offsets, so its views can be kept
+            const u32 sizes[]      = {64, 4000, 12, 300};
+            const u32 alignments[] = {256, 16, 12, 256};
+
+            u32 first[4];
+            u32 used = 0;
+            for (u32 i = 0; i < 4; ++i)
+            {
+                CHECK_TRUE(RenderGraphResourceAllocator::SubAllocateRegion(8192, 8192, used, sizes[i], alignments[i], first[i]));
+            }
+
+            used = 0;
+            for (u32 i = 0; i < 4; ++i)
+            {
+                u32 offset = 0;
+                RenderGraphResourceAllocator::SubAllocateRegion(8192, 8192, used, sizes[i], alignments[i], offset);
+                CHECK_EQUAL(first[i], offset);
+            }
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,51 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_resource_allocator.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+// the table is keyed by the name pointer, every test uses names of its own as the allocator lives for the fixture
+static const char s_sceneColor[] = "SceneColor";
+static const char s_debugView[]  = "DebugView";
+static const char s_lightGrid[]  = "LightGrid";
+
+UNITTEST_SUITE_BEGIN(render_graph_stable_usage)
+{
+    UNITTEST_FIXTURE(table)
+    {
+        static RenderGraphResourceAllocator* s_allocator = nullptr;
+
+        UNITTEST_FIXTURE_SETUP() { s_allocator = new RenderGraphResourceAllocator(nullptr); }
+        UNITTEST_FIXTURE_TEARDOWN()
+        {
+            delete s_allocator;
+            s_allocator = nullptr;
+        }
+
+        UNITTEST_TEST(unknown_name_adds_nothing)
+        {
+            CHECK_EQUAL(0, s_allocator->GetStableUsage((cpstr_t)s_debugView, true));
+        }
+
+        UNITTEST_TEST(usages_of_recent_frames_are_merged)
+        {
+            // the debug view that writes the scene color as a UAV is turned off in the second frame
+            s_allocator->SetLifetimeFrame(1);
+            s_allocator->UpdateStableUsage((cpstr_t)s_sceneColor, true, ngfx::GfxTextureUsage::RenderTarget | ngfx::GfxTextureUsage::UnorderedAccess);
+            s_allocator->SetLifetimeFrame(2);
+            s_allocator->UpdateStableUsage((cpstr_t)s_sceneColor, true, ngfx::GfxTextureUsage::RenderTarget);
+
+            const u32 usage = ngfx::GfxTextureUsage::RenderTarget | ngfx::GfxTextureUsage::UnorderedAccess;
+            CHECK_EQUAL(usage, s_allocator->GetStableUsage((cpstr_t)s_sceneColor, true));
+        }
+
+        UNITTEST_TEST(textures_and_buffers_are_kept_apart)
+        {
+            s_allocator->UpdateStableUsage((cpstr_t)s_lightGrid, false, ngfx::GfxBufferUsage::UnorderedAccess);
+            CHECK_EQUAL((u32)ngfx::GfxBufferUsage::UnorderedAccess, s_allocator->GetStableUsage((cpstr_t)s_lightGrid, false));
+            CHECK_EQUAL(0, s_allocator->GetStableUsage((cpstr_t)s_lightGrid, true));
+        }
+    }
+}
+UNITTEST_SUITE_END
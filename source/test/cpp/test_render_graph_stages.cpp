@@ -0,0 +1,88 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_stage.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_stages)
+{
+    UNITTEST_FIXTURE(states)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(default_stages_are_the_widest_the_state_allows)
+        {
+            // the access flags don't tell vertex, mesh and task shaders apart
+            CHECK_TRUE(RGGetStages(ngfx::GfxAccess::VertexShaderSRV) == RGShaderStage::NonPixel);
+            CHECK_TRUE(RGGetStages(ngfx::GfxAccess::PixelShaderSRV | ngfx::GfxAccess::VertexShaderSRV) == RGShaderStage::Graphics);
+            CHECK_TRUE(RGGetStages(ngfx::GfxAccess::ComputeUAV) == RGShaderStage::Compute);
+            CHECK_TRUE(RGGetStages(ngfx::GfxAccess::IndirectArgs) == RGShaderStage::Indirect);
+            CHECK_TRUE(RGGetStages(ngfx::GfxAccess::RTV) == RGShaderStage::None);
+        }
+
+        UNITTEST_TEST(read_and_write_states_of_stages)
+        {
+            CHECK_EQUAL((u32)(ngfx::GfxAccess::VertexShaderSRV | ngfx::GfxAccess::PixelShaderSRV), (u32)RGGetReadState(RGShaderStage::Mesh | RGShaderStage::Pixel));
+            CHECK_EQUAL((u32)(ngfx::GfxAccess::ComputeSRV | ngfx::GfxAccess::IndirectArgs), (u32)RGGetReadState(RGShaderStage::Compute | RGShaderStage::Indirect));
+            CHECK_EQUAL((u32)ngfx::GfxAccess::CopyDst, (u32)RGGetWriteState(RGShaderStage::Copy));
+            CHECK_EQUAL((u32)(ngfx::GfxAccess::ComputeUAV | ngfx::GfxAccess::ClearUAV), (u32)RGGetWriteState(RGShaderStage::Compute));
+        }
+
+        UNITTEST_TEST(stage_mask_is_passed_as_is)
+        {
+            CHECK_EQUAL(0, RGGetStageMask(RGShaderStage::None));
+            CHECK_EQUAL((u32)RGShaderStage::Task | (u32)RGShaderStage::Pixel, RGGetStageMask(RGShaderStage::Task | RGShaderStage::Pixel));
+        }
+    }
+
+    // a compute pass writes a buffer that a mesh shader pass reads, the stages of the edges end up in the barrier
+    UNITTEST_FIXTURE(resolve_barriers)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(barrier_waits_for_the_declared_stages_only)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* meshlets = test.AddTexture();
+            RenderGraphPassBase*     cull     = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase*     draw     = test.AddPass();
+
+            RenderGraphResourceNode* culled = test.Write(cull, meshlets, ngfx::GfxAccess::ComputeUAV);
+            RenderGraphEdge*         read   = test.Read(draw, culled, RGGetReadState(RGShaderStage::Mesh));
+            read->SetStages(RGShaderStage::Mesh);
+
+            draw->ResolveBarriers(frame.graph, true);
+
+            CHECK_EQUAL(1, (u32)draw->GetBarrierRecords().size());
+            const RGBarrierRecord& record = draw->GetBarrierRecords()[0];
+            CHECK_TRUE(record.old_stages == RGShaderStage::Compute);
+            CHECK_TRUE(record.new_stages == RGShaderStage::Mesh);
+        }
+
+        UNITTEST_TEST(without_stages_the_state_decides)
+        {
+            RGTestFrame       test;
+            RenderGraphFrame& frame = test.Get();
+
+            RenderGraphResourceNode* meshlets = test.AddTexture();
+            RenderGraphPassBase*     cull     = test.AddPass(RenderPassType::Compute);
+            RenderGraphPassBase*     draw     = test.AddPass();
+
+            RenderGraphResourceNode* culled = test.Write(cull, meshlets, ngfx::GfxAccess::ComputeUAV);
+            test.Read(draw, culled, ngfx::GfxAccess::VertexShaderSRV);
+
+            draw->ResolveBarriers(frame.graph, true);
+
+            CHECK_EQUAL(1, (u32)draw->GetBarrierRecords().size());
+            CHECK_TRUE(draw->GetBarrierRecords()[0].new_stages == RGShaderStage::NonPixel);
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,100 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_staging.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_staging)
+{
+    UNITTEST_FIXTURE(ring)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(ranges_are_aligned)
+        {
+            RenderGraphStagingAllocator ring(1024);
+
+            u32 offset = ~0u;
+            CHECK_TRUE(ring.Allocate(100, 256, offset));
+            CHECK_EQUAL(0, offset);
+            CHECK_TRUE(ring.Allocate(100, 256, offset));
+            CHECK_EQUAL(256, offset);
+
+            // the padding in front of the second range belongs to the frame as well
+            CHECK_EQUAL(356, ring.GetUsed());
+            CHECK_EQUAL(356, ring.TakePending());
+            CHECK_EQUAL(0, ring.TakePending());
+        }
+
+        UNITTEST_TEST(full_ring_fails_instead_of_waiting)
+        {
+            RenderGraphStagingAllocator ring(1024);
+
+            u32 offset;
+            CHECK_TRUE(ring.Allocate(1024, 16, offset));
+            CHECK_FALSE(ring.Allocate(16, 16, offset));
+            CHECK_FALSE(ring.Allocate(2048, 16, offset));
+        }
+
+        UNITTEST_TEST(frames_are_released_by_their_fence)
+        {
+            RenderGraphStagingAllocator ring(1024);
+
+            u32 offset;
+            ring.Allocate(512, 16, offset);
+            ring.Submit(1, ring.TakePending());
+            ring.Allocate(256, 16, offset);
+            ring.Submit(2, ring.TakePending());
+            CHECK_EQUAL(768, ring.GetUsed());
+
+            ring.Retire(0);
+            CHECK_EQUAL(768, ring.GetUsed());
+            ring.Retire(1);
+            CHECK_EQUAL(256, ring.GetUsed());
+            ring.Retire(5);
+            CHECK_EQUAL(0, ring.GetUsed());
+        }
+
+        UNITTEST_TEST(wrap_skips_the_end_of_the_buffer)
+        {
+            RenderGraphStagingAllocator ring(1024);
+
+            u32 offset;
+            ring.Allocate(768, 16, offset);
+            ring.Submit(1, ring.TakePending());
+
+            // 256 bytes are left at the end, but frame 1 still covers the start
+            CHECK_FALSE(ring.Allocate(384, 16, offset));
+
+            ring.Retire(1);
+            CHECK_TRUE(ring.Allocate(384, 16, offset));
+            CHECK_EQUAL(0, offset);
+
+            // the skipped end is released with the frame that wrapped
+            CHECK_EQUAL(640, ring.GetUsed());
+            ring.Submit(2, ring.TakePending());
+            ring.Retire(2);
+            CHECK_EQUAL(0, ring.GetUsed());
+        }
+
+        UNITTEST_TEST(wrapped_range_does_not_overwrite_a_frame_in_flight)
+        {
+            RenderGraphStagingAllocator ring(1024);
+
+            u32 offset;
+            ring.Allocate(512, 16, offset);
+            ring.Submit(1, ring.TakePending());
+            ring.Allocate(256, 16, offset);
+            ring.Submit(2, ring.TakePending());
+            ring.Retire(1);
+
+            // the head is at 768, the range wraps to 0 and frame 2 holds 512..768
+            CHECK_TRUE(ring.Allocate(512, 16, offset));
+            CHECK_EQUAL(0, offset);
+            CHECK_FALSE(ring.Allocate(16, 16, offset));
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,131 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_subgraph)
+{
+    // a two pass blur recorded against local handles, the intermediate texture belongs to the subgraph
+    UNITTEST_FIXTURE(compile)
+    {
+        struct BlurData
+        {
+            RGHandle input;
+            RGHandle output;
+        };
+
+        static RGTexture::Desc TargetDesc()
+        {
+            RGTexture::Desc desc;
+            desc.width  = 512;
+            desc.height = 512;
+            return desc;
+        }
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(internal_resource_is_resolved_once)
+        {
+            RenderGraphSubgraph subgraph;
+            const RGHandle      source = subgraph.Input(0);
+            const RGHandle      target = subgraph.Input(1);
+
+            RGHandle blurred;
+            subgraph.AddPass<BlurData>(
+                nullptr, RenderPassType::Compute,
+                [&](BlurData& data, RGBuilder& builder) {
+                    data.input  = builder.Read(source);
+                    data.output = builder.Write(builder.Create<RGTexture>(TargetDesc(), nullptr));
+                    blurred     = data.output;
+                },
+                [](const BlurData& data, IGfxCommandList* pCommandList, const RGSubgraphInstance& instance) {});
+            subgraph.AddPass<BlurData>(
+                nullptr, RenderPassType::Compute,
+                [&](BlurData& data, RGBuilder& builder) {
+                    data.input  = builder.Read(blurred);
+                    data.output = builder.Write(target);
+                },
+                [](const BlurData& data, IGfxCommandList* pCommandList, const RGSubgraphInstance& instance) {});
+
+            subgraph.Compile();
+            CHECK_TRUE(subgraph.IsCompiled());
+            CHECK_EQUAL(2, subgraph.GetNumInputs());
+
+            u32                  first_pass, last_pass;
+            ngfx::GfxAccessFlags last_state;
+            CHECK_TRUE(subgraph.GetResolvedLifetime(blurred, first_pass, last_pass, last_state));
+            CHECK_EQUAL(0, first_pass);
+            CHECK_EQUAL(1, last_pass);
+            CHECK_EQUAL((ngfx::GfxAccessFlags)ngfx::GfxAccess::ComputeSRV, last_state);
+
+            // the state of an input is only known per instance
+            CHECK_FALSE(subgraph.GetResolvedLifetime(source, first_pass, last_pass, last_state));
+            CHECK_FALSE(subgraph.GetResolvedLifetime(target, first_pass, last_pass, last_state));
+        }
+
+        UNITTEST_TEST(consecutive_reads_leave_the_merged_state)
+        {
+            RenderGraphSubgraph subgraph;
+            const RGHandle      target = subgraph.Input(0);
+
+            RGHandle mask;
+            subgraph.AddPass<BlurData>(
+                nullptr, RenderPassType::Compute,
+                [&](BlurData& data, RGBuilder& builder) {
+                    data.output = builder.Write(builder.Create<RGTexture>(TargetDesc(), nullptr));
+                    mask        = data.output;
+                },
+                [](const BlurData& data, IGfxCommandList* pCommandList, const RGSubgraphInstance& instance) {});
+            subgraph.AddPass<BlurData>(
+                nullptr, RenderPassType::Graphics,
+                [&](BlurData& data, RGBuilder& builder) {
+                    data.input  = builder.Read(mask, 0, RGBuilderFlag::ShaderStagePS);
+                    data.output = builder.Write(target);
+                },
+                [](const BlurData& data, IGfxCommandList* pCommandList, const RGSubgraphInstance& instance) {});
+            subgraph.AddPass<BlurData>(
+                nullptr, RenderPassType::Graphics, [&](BlurData& data, RGBuilder& builder) { data.input = builder.Read(mask, 0, RGBuilderFlag::ShaderStageNonPS); },
+                [](const BlurData& data, IGfxCommandList* pCommandList, const RGSubgraphInstance& instance) {});
+
+            subgraph.Compile();
+
+            u32                  first_pass, last_pass;
+            ngfx::GfxAccessFlags last_state;
+            CHECK_TRUE(subgraph.GetResolvedLifetime(mask, first_pass, last_pass, last_state));
+            CHECK_EQUAL(2, last_pass);
+            CHECK_EQUAL((ngfx::GfxAccessFlags)(ngfx::GfxAccess::PixelShaderSRV | ngfx::GfxAccess::VertexShaderSRV), last_state);
+        }
+
+        UNITTEST_TEST(async_compute_leaves_the_lifetime_to_the_frame)
+        {
+            RenderGraphSubgraph subgraph;
+            const RGHandle      target = subgraph.Input(0);
+
+            RGHandle histogram;
+            subgraph.AddPass<BlurData>(
+                nullptr, RenderPassType::AsyncCompute,
+                [&](BlurData& data, RGBuilder& builder) {
+                    data.output = builder.Write(builder.Create<RGTexture>(TargetDesc(), nullptr));
+                    histogram   = data.output;
+                },
+                [](const BlurData& data, IGfxCommandList* pCommandList, const RGSubgraphInstance& instance) {});
+            subgraph.AddPass<BlurData>(
+                nullptr, RenderPassType::Compute,
+                [&](BlurData& data, RGBuilder& builder) {
+                    data.input  = builder.Read(histogram);
+                    data.output = builder.Write(target);
+                },
+                [](const BlurData& data, IGfxCommandList* pCommandList, const RGSubgraphInstance& instance) {});
+
+            subgraph.Compile();
+
+            u32                  first_pass, last_pass;
+            ngfx::GfxAccessFlags last_state;
+            CHECK_FALSE(subgraph.GetResolvedLifetime(histogram, first_pass, last_pass, last_state));
+        }
+    }
+}
+UNITTEST_SUITE_END
@@ -0,0 +1,101 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph.h"
+
+#include "cunittest/cunittest.h"
+
+#include "test_render_graph_frame.h"
+
+using namespace ncore;
+
+UNITTEST_SUITE_BEGIN(render_graph_submit)
+{
+    // the sync points are loaded the way a cached frame takes them, the plan is read back through SaveCompiled
+    UNITTEST_FIXTURE(plan_submit)
+    {
+        static const u64 NoSync = (u64)-1;
+
+        static void SetSync(RenderGraphPassBase* pass, u64 wait_value, u64 signal_value)
+        {
+            RGCompiledPass record     = {};
+            record.waitValue          = wait_value;
+            record.signalValue        = signal_value;
+            record.waitGraphicsPass   = RGCompiledPass::InvalidIndex;
+            record.signalGraphicsPass = RGCompiledPass::InvalidIndex;
+            pass->LoadCompiled(record, nullptr);
+        }
+
+        static RGCompiledPass Plan(RenderGraphFrame& frame, RenderGraphSubmitPlanContext& context, RenderGraphPassBase* pass)
+        {
+            pass->PlanSubmit(context);
+
+            RGCompiledPass record = {};
+            pass->SaveCompiled(frame.graph, record);
+            return record;
+        }
+
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(wait_after_recorded_work_submits_it_first)
+        {
+            RGTestFrame                  test;
+            RenderGraphSubmitPlanContext context;
+
+            RenderGraphPassBase* gbuffer  = test.AddPass();
+            RenderGraphPassBase* lighting = test.AddPass();
+            SetSync(gbuffer, NoSync, NoSync);
+            SetSync(lighting, 1, NoSync);
+
+            // the first pass records into the list the caller set up, nothing to submit or set up yet
+            const RGCompiledPass first = Plan(test.Get(), context, gbuffer);
+            CHECK_EQUAL(0, first.submitBeforeWait);
+            CHECK_EQUAL(0, first.setupGlobalConstants);
+
+            const RGCompiledPass second = Plan(test.Get(), context, lighting);
+            CHECK_EQUAL(1, second.submitBeforeWait);
+            CHECK_EQUAL(1, second.setupGlobalConstants);
+        }
+
+        UNITTEST_TEST(signal_and_wait_share_a_submit)
+        {
+            RGTestFrame                  test;
+            RenderGraphSubmitPlanContext context;
+
+            RenderGraphPassBase* shadows  = test.AddPass();
+            RenderGraphPassBase* lighting = test.AddPass();
+            SetSync(shadows, NoSync, 1);
+            SetSync(lighting, 2, NoSync);
+
+            Plan(test.Get(), context, shadows);
+
+            // the signal ended the batch, the wait is applied with that submit and the new list needs the constants
+            const RGCompiledPass wait = Plan(test.Get(), context, lighting);
+            CHECK_EQUAL(0, wait.submitBeforeWait);
+            CHECK_EQUAL(1, wait.setupGlobalConstants);
+        }
+
+        UNITTEST_TEST(queues_are_planned_separately)
+        {
+            RGTestFrame                  test;
+            RenderGraphSubmitPlanContext context;
+
+            RenderGraphPassBase* scene    = test.AddPass();
+            RenderGraphPassBase* exposure = test.AddPass(RenderPassType::AsyncCompute);
+            RenderGraphPassBase* tonemap  = test.AddPass();
+            SetSync(scene, NoSync, 1);
+            SetSync(exposure, 1, 2);
+            SetSync(tonemap, 2, NoSync);
+
+            Plan(test.Get(), context, scene);
+
+            // nothing was recorded on the compute list by the graph, but the caller may have
+            const RGCompiledPass compute = Plan(test.Get(), context, exposure);
+            CHECK_EQUAL(1, compute.submitBeforeWait);
+
+            const RGCompiledPass graphics = Plan(test.Get(), context, tonemap);
+            CHECK_EQUAL(0, graphics.submitBeforeWait);
+            CHECK_EQUAL(1, graphics.setupGlobalConstants);
+        }
+    }
+}
+UNITTEST_SUITE_END
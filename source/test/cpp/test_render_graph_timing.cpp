@@ -0,0 +1,88 @@
+#include "ccore/c_target.h"
+#include "crendergraph/render_graph_timing.h"
+
+#include "cunittest/cunittest.h"
+
+using namespace ncore;
+
+#if RENDER_GRAPH_PASS_TIMINGS
+
+// the table is keyed by the name pointer, every test times a name of its own
+static const char s_bucketsPass[] = "buckets";
+static const char s_windowPass[]  = "window";
+static const char s_costPass[]    = "cost";
+
+UNITTEST_SUITE_BEGIN(render_graph_timing)
+{
+    UNITTEST_FIXTURE(histogram)
+    {
+        UNITTEST_FIXTURE_SETUP() {}
+        UNITTEST_FIXTURE_TEARDOWN() {}
+
+        UNITTEST_TEST(a_name_keeps_its_slot)
+        {
+            const u32 slot = RenderGraphPassTimings::Register((cpstr_t)s_bucketsPass);
+            CHECK_TRUE(slot != RenderGraphPassTimings::InvalidSlot);
+            CHECK_EQUAL(slot, RenderGraphPassTimings::Register((cpstr_t)s_bucketsPass));
+            CHECK_TRUE(RenderGraphPassTimings::GetName(slot) == (cpstr_t)s_bucketsPass);
+        }
+
+        UNITTEST_TEST(samples_go_to_power_of_two_microsecond_buckets)
+        {
+            const u32 slot = RenderGraphPassTimings::Register((cpstr_t)s_bucketsPass);
+
+            RenderGraphPassTimings::AddSample(slot, RGPassTimer::Record, 500);     // below 2 us
+            RenderGraphPassTimings::AddSample(slot, RGPassTimer::Record, 1999);    // still below 2 us
+            RenderGraphPassTimings::AddSample(slot, RGPassTimer::Record, 2000);    // [2, 4) us
+            RenderGraphPassTimings::AddSample(slot, RGPassTimer::Record, 7999);    // [4, 8) us
+            RenderGraphPassTimings::AddSample(slot, RGPassTimer::Record, 1u << 31); // saturates in the last bucket
+
+            RGPassTimingHistogram histogram;
+            CHECK_TRUE(RenderGraphPassTimings::GetHistogram(slot, RGPassTimer::Record, histogram));
+            CHECK_EQUAL(5, histogram.numSamples);
+            CHECK_EQUAL(2, histogram.counts[0]);
+            CHECK_EQUAL(1, histogram.counts[1]);
+            CHECK_EQUAL(1, histogram.counts[2]);
+            CHECK_EQUAL(1, histogram.counts[RGPassTimingHistogram::NumBuckets - 1]);
+            CHECK_EQUAL((u64)(1u << 31), histogram.maxNs);
+
+            // the other timer of the pass has no samples
+            CHECK_FALSE(RenderGraphPassTimings::GetHistogram(slot, RGPassTimer::Setup, histogram));
+            CHECK_EQUAL(0, histogram.numSamples);
+        }
+
+        UNITTEST_TEST(only_the_last_window_is_kept)
+        {
+            const u32 slot = RenderGraphPassTimings::Register((cpstr_t)s_windowPass);
+
+            for (u32 i = 0; i < RenderGraphPassTimings::WindowSize; ++i)
+            {
+                RenderGraphPassTimings::AddSample(slot, RGPassTimer::Setup, 100000);
+            }
+            for (u32 i = 0; i < RenderGraphPassTimings::WindowSize; ++i)
+            {
+                RenderGraphPassTimings::AddSample(slot, RGPassTimer::Setup, 1000);
+            }
+
+            RGPassTimingHistogram histogram;
+            CHECK_TRUE(RenderGraphPassTimings::GetHistogram(slot, RGPassTimer::Setup, histogram));
+            CHECK_EQUAL(RenderGraphPassTimings::WindowSize, histogram.numSamples);
+            CHECK_EQUAL(RenderGraphPassTimings::WindowSize, histogram.counts[0]);
+            CHECK_EQUAL(1000, histogram.averageNs);
+        }
+
+        UNITTEST_TEST(cost_sums_the_averages_of_both_timers)
+        {
+            CHECK_EQUAL(0, RenderGraphPassTimings::GetCost((cpstr_t)s_costPass));
+
+            const u32 slot = RenderGraphPassTimings::Register((cpstr_t)s_costPass);
+            RenderGraphPassTimings::AddSample(slot, RGPassTimer::Record, 3000);
+            RenderGraphPassTimings::AddSample(slot, RGPassTimer::Record, 5000);
+            RenderGraphPassTimings::AddSample(slot, RGPassTimer::Setup, 1000);
+            CHECK_EQUAL(5000, RenderGraphPassTimings::GetCost((cpstr_t)s_costPass));
+        }
+    }
+}
+UNITTEST_SUITE_END
+
+#endif
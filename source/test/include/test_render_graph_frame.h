@@ -0,0 +1,134 @@
+#ifndef __CRENDERGRAPH_TEST_RENDER_GRAPH_FRAME_H__
+#define __CRENDERGRAPH_TEST_RENDER_GRAPH_FRAME_H__
+#include "ccore/c_target.h"
+#ifdef USE_PRAGMA_ONCE
+#    pragma once
+#endif
+
+#include "crendergraph/render_graph.h"
+
+namespace ncore
+{
+    class RGTestPass : public RenderGraphPassBase
+    {
+    public:
+        RGTestPass(RenderPassType type, DirectedAcyclicGraph& graph)
+            : RenderGraphPassBase(nullptr, type, graph)
+        {
+        }
+
+    private:
+        virtual void ExecuteImpl(IGfxCommandList* pCommandList) {}
+    };
+
+    // records a frame by hand the way RGBuilder does, so the compile steps of RenderGraphFrame run on it without a
+    // renderer. Nothing is realized, the resource allocator never needs a device.
+    class RGTestFrame
+    {
+    public:
+        RGTestFrame()
+            : m_resourceAllocator(nullptr)
+        {
+            m_frame.allocator = new RenderGraphArena(64 * 1024);
+        }
+
+        ~RGTestFrame()
+        {
+            for (size_t i = 0; i < m_frame.objFinalizer.size(); ++i)
+            {
+                m_frame.objFinalizer[i].finalizer(m_frame.objFinalizer[i].obj);
+            }
+            delete m_frame.allocator;
+        }
+
+        RenderGraphFrame& Get() { return m_frame; }
+
+        RenderGraphPassBase* AddPass(RenderPassType type = RenderPassType::Graphics)
+        {
+            RGTestPass* pass = Allocate<RGTestPass>(type, m_frame.graph);
+            pass->SetIndex((u32)m_frame.passes.size());
+            m_frame.passes.push_back(pass);
+            return pass;
+        }
+
+        RenderGraphResourceNode* AddTexture(u32 width = 256, u32 height = 256)
+        {
+            RGTexture::Desc desc;
+            desc.width  = width;
+            desc.height = height;
+
+            RGTexture* texture = Allocate<RGTexture>(m_resourceAllocator, (cpstr_t)nullptr, desc);
+            texture->SetIndex((u32)m_frame.resources.size());
+            m_frame.resources.push_back(texture);
+
+            return AddNode(texture, 0);
+        }
+
+        RenderGraphEdge* Read(RenderGraphPassBase* pass, RenderGraphResourceNode* node, ngfx::GfxAccessFlags usage, u32 subresource = 0)
+        {
+            return AllocatePOD<RenderGraphEdge>(m_frame.graph, node, pass, usage, subresource);
+        }
+
+        // returns the new version of the resource, like RenderGraph::Write
+        RenderGraphResourceNode* Write(RenderGraphPassBase* pass, RenderGraphResourceNode* node, ngfx::GfxAccessFlags usage, u32 subresource = 0, bool non_overlapping = false)
+        {
+            RenderGraphResourceNode* output      = AddNode(node->GetResource(), node->GetVersion() + 1);
+            RenderGraphEdge*         input_edge  = AllocatePOD<RenderGraphEdge>(m_frame.graph, node, pass, usage, subresource);
+            RenderGraphEdge*         output_edge = AllocatePOD<RenderGraphEdge>(m_frame.graph, pass, output, usage, subresource);
+            if (non_overlapping)
+            {
+                input_edge->SetNonOverlappingWrite();
+                output_edge->SetNonOverlappingWrite();
+            }
+            return output;
+        }
+
+        // 'output_edge' receives the edge the render pass takes its load op from
+        RenderGraphResourceNode* WriteDepth(RenderGraphPassBase* pass, RenderGraphResourceNode* node, ngfx::GfxRenderPass::LoadOp load_op, RenderGraphEdgeDepthAttchment** output_edge = nullptr, float clear_depth = 0.0f)
+        {
+            const ngfx::GfxAccessFlags usage  = ngfx::GfxAccess::DSV;
+            RenderGraphResourceNode*   output = AddNode(node->GetResource(), node->GetVersion() + 1);
+
+            AllocatePOD<RenderGraphEdgeDepthAttchment>(m_frame.graph, node, pass, usage, 0, load_op, load_op, clear_depth, 0);
+            RenderGraphEdgeDepthAttchment* edge = AllocatePOD<RenderGraphEdgeDepthAttchment>(m_frame.graph, pass, output, usage, 0, load_op, load_op, clear_depth, 0);
+            if (output_edge != nullptr)
+            {
+                *output_edge = edge;
+            }
+            return output;
+        }
+
+    private:
+        RenderGraphResourceNode* AddNode(RenderGraphResource* resource, u32 version)
+        {
+            RenderGraphResourceNode* node = AllocatePOD<RenderGraphResourceNode>(m_frame.graph, resource, version);
+            m_frame.resourceNodes.push_back(node);
+            return node;
+        }
+
+        template <typename T, typename... ArgsT> T* Allocate(ArgsT&&... arguments)
+        {
+            T* p = AllocatePOD<T>(arguments...);
+
+            RenderGraphFrame::ObjFinalizer finalizer;
+            finalizer.obj       = p;
+            finalizer.finalizer = &ClassFinalizer<T>;
+            m_frame.objFinalizer.push_back(finalizer);
+
+            return p;
+        }
+
+        template <typename T, typename... ArgsT> T* AllocatePOD(ArgsT&&... arguments)
+        {
+            T* p = (T*)m_frame.allocator->Alloc(sizeof(T));
+            new (p) T(arguments...);
+            return p;
+        }
+
+        RenderGraphResourceAllocator m_resourceAllocator;
+        RenderGraphFrame             m_frame;
+    };
+
+} // namespace ncore
+
+#endif